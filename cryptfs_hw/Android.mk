@@ -21,6 +21,7 @@ LOCAL_SRC_FILES := $(sourceFiles)
 LOCAL_MODULE_TAGS       := optional
 LOCAL_MODULE:= libcryptfs_hw
 LOCAL_SHARED_LIBRARIES := $(commonSharedLibraries)
+LOCAL_STATIC_LIBRARIES := libqcomsocinfo
 
 LOCAL_MODULE_OWNER := qcom
 
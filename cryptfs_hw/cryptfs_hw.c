@@ -40,6 +40,7 @@
 #include "cutils/android_reboot.h"
 #include "keymaster_common.h"
 #include "hardware.h"
+#include "socinfo.h"
 
 
 // When device comes up or when user tries to change the password, user can
@@ -58,7 +59,6 @@
 /* Operations that be performed on HW based device encryption key */
 #define SET_HW_DISK_ENC_KEY 1
 #define UPDATE_HW_DISK_ENC_KEY 2
-#define MAX_DEVICE_ID_LENGTH 4 /* 4 = 3 (MAX_SOC_ID_LENGTH) + 1 */
 
 static unsigned int cpu_id[] = {
 	239, /* MSM8939 SOC ID */
@@ -224,29 +224,13 @@ int clear_hw_device_encryption_key(void)
 #ifdef CONFIG_SWV8_DISK_ENCRYPTION
 unsigned int is_hw_fde_enabled(void)
 {
-    unsigned int device_id = -1;
+    unsigned int device_id;
     unsigned int array_size;
     unsigned int status = 1;
-    FILE *fd = NULL;
     unsigned int i;
-    int ret = -1;
-    char buf[MAX_DEVICE_ID_LENGTH];
 
-    fd = fopen("/sys/devices/soc0/soc_id", "r");
-    if (fd) {
-        ret = fread(buf, 1, MAX_DEVICE_ID_LENGTH, fd);
-        fclose(fd);
-    } else {
-        fd = fopen("/sys/devices/system/soc/soc0/id", "r");
-        if (fd) {
-            ret = fread(buf, 1, MAX_DEVICE_ID_LENGTH, fd);
-            fclose(fd);
-        }
-    }
-
-    if (ret > 0) {
-        device_id = atoi(buf);
-    } else {
+    device_id = socinfo_get()->soc_id;
+    if (!device_id) {
         SLOGE("Failed to read device id");
         return status;
     }
@@ -23,6 +23,8 @@ else
     LOCAL_SRC_FILES += init_$(TARGET_BOARD_PLATFORM).cpp
   endif
 endif
+# Pulled in whole: init links this library but not its dependencies.
+LOCAL_WHOLE_STATIC_LIBRARIES := libqcomsocinfo
 LOCAL_MODULE := libinit_msm
 include $(BUILD_STATIC_LIBRARY)
 
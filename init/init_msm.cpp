@@ -42,23 +42,13 @@
 #include "util.h"
 
 #include "init_msm.h"
+#include "socinfo.h"
 
 #include <sys/resource.h>
 
-#define SOC_ID_PATH1     "/sys/devices/soc0/soc_id"
-#define SOC_ID_PATH2     "/sys/devices/system/soc/soc0/id"
-#define SOC_VER_PATH1    "/sys/devices/soc0/platform_version"
-#define SOC_VER_PATH2    "/sys/devices/system/soc/soc0/platform_version"
-#define BOARD_TYPE_PATH1 "/sys/devices/soc0/hw_platform"
-#define BOARD_TYPE_PATH2 "/sys/devices/system/soc/soc0/hw_platform"
-
 #define BUF_SIZE         64
-#define STRCONV_(x)      #x
-#define STRCONV(x)       "%" STRCONV_(x) "s"
 
-static unsigned long msm_id;
-static unsigned long msm_ver;
-static char board_type[BUF_SIZE];
+static char board_type[SOCINFO_HW_PLATFORM_MAX];
 static char tmp[BUF_SIZE];
 
 // sys and dev fb paths
@@ -264,41 +254,31 @@ static int check_rlim_action()
 
 void vendor_load_properties()
 {
-    int rc;
+    const struct socinfo *info;
 
     /* Collect MSM info */
-    rc = read_file2(SOC_ID_PATH1, tmp, sizeof(tmp));
-    if (!rc) {
-        rc = read_file2(SOC_ID_PATH2, tmp, sizeof(tmp));
-    }
-    if (rc) {
-        msm_id = strtoul(tmp, NULL, 0);
-    }
-    rc = read_file2(SOC_VER_PATH1, tmp, sizeof(tmp));
-    if (!rc) {
-        rc = read_file2(SOC_VER_PATH2, tmp, sizeof(tmp));
-    }
-    if (rc) {
-        msm_ver = strtoul(tmp, NULL, 0);
-    }
-    rc = read_file2(BOARD_TYPE_PATH1, tmp, sizeof(tmp));
-    if (!rc) {
-        rc = read_file2(BOARD_TYPE_PATH2, tmp, sizeof(tmp));
-    }
-    if (rc) {
-        sscanf(tmp, STRCONV(BUF_SIZE), board_type);
-    }
-    if (!msm_id) {
+    info = socinfo_get();
+    if (!info->soc_id) {
         /* abort */
         ERROR("MSM SOC detection failed, skipping MSM initialization\n");
         return;
     }
+    snprintf(board_type, sizeof(board_type), "%s", info->hw_platform);
+
+    ERROR("Detected MSM SOC ID=%lu SOC VER=%lu BOARD TYPE=%s FAMILY=%s\n",
+          info->soc_id, info->platform_version, board_type,
+          socinfo_family_name(info->family));
 
-    ERROR("Detected MSM SOC ID=%lu SOC VER=%lu BOARD TYPE=%s\n",
-          msm_id, msm_ver, board_type);
+    /* Publish it so nothing started later has to read sysfs again */
+    snprintf(tmp, sizeof(tmp), "%lu", info->soc_id);
+    property_set(SOCINFO_PROP_ID, tmp);
+    snprintf(tmp, sizeof(tmp), "%lu", info->platform_version);
+    property_set(SOCINFO_PROP_VERSION, tmp);
+    property_set(SOCINFO_PROP_HW_PLATFORM, board_type);
+    property_set(SOCINFO_PROP_FAMILY, socinfo_family_name(info->family));
 
     /* Define MSM family properties */
-    init_msm_properties(msm_id, msm_ver, board_type);
+    init_msm_properties(info->soc_id, info->platform_version, board_type);
 
     init_alarm_boot_properties();
     /*check for coredump*/
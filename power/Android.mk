@@ -14,7 +14,13 @@ include $(CLEAR_VARS)
 LOCAL_MODULE_RELATIVE_PATH := hw
 LOCAL_PROPRIETARY_MODULE := true
 LOCAL_SHARED_LIBRARIES := liblog libcutils libdl
-LOCAL_SRC_FILES := power.c metadata-parser.c utils.c list.c hint-data.c
+LOCAL_STATIC_LIBRARIES := libqcomsocinfo
+LOCAL_SRC_FILES := power.c metadata-parser.c utils.c list.c hint-data.c \
+    power-timer.c vsync-boost.c sustained-perf.c boost-profile.c \
+    power-state.c perflock-monitor.c tunable-vote.c governor-tunables.c \
+    schedutil.c cpufreq-policy.c boost-placement.c \
+    devfreq-boost.c io-boost.c boot-boost.c sysfs-snapshot.c \
+    pm-qos.c core-ctl.c boost-budget.c launch-policy.c boost-policy.c
 
 # Include target-specific files.
 ifeq ($(call is-board-platform-in-list, msm8974), true)
@@ -57,6 +63,9 @@ ifeq ($(call is-board-platform-in-list, msm8994), true)
 LOCAL_SRC_FILES += power-8994.c
 endif
 
+# The SoC backend, also linked into powersim
+POWERHAL_TARGET_SRC := $(filter power-8%.c,$(LOCAL_SRC_FILES))
+
 ifneq ($(TARGET_POWERHAL_SET_INTERACTIVE_EXT),)
 LOCAL_CFLAGS += -DSET_INTERACTIVE_EXT
 LOCAL_SRC_FILES += ../../../../$(TARGET_POWERHAL_SET_INTERACTIVE_EXT)
@@ -80,4 +89,97 @@ endif
 LOCAL_MODULE_TAGS := optional
 include $(BUILD_SHARED_LIBRARY)
 
+# Reader side of the published HAL state page
+include $(CLEAR_VARS)
+
+LOCAL_PROPRIETARY_MODULE := true
+LOCAL_SRC_FILES := power-state-reader.c
+LOCAL_EXPORT_C_INCLUDE_DIRS := $(LOCAL_PATH)
+LOCAL_MODULE := libqcompowerstate
+LOCAL_MODULE_TAGS := optional
+include $(BUILD_SHARED_LIBRARY)
+
+include $(CLEAR_VARS)
+
+LOCAL_PROPRIETARY_MODULE := true
+LOCAL_SHARED_LIBRARIES := libqcompowerstate
+LOCAL_SRC_FILES := powerstate.c
+LOCAL_MODULE := powerstate
+LOCAL_MODULE_TAGS := optional
+include $(BUILD_EXECUTABLE)
+
+# Cold-read benchmark for the launch I/O boost
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := ioboostbench.c
+LOCAL_MODULE := ioboostbench
+LOCAL_MODULE_TAGS := optional
+include $(BUILD_EXECUTABLE)
+
+# Dispatch-cost benchmark for power hints
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := hintbench.c
+LOCAL_SHARED_LIBRARIES := libhardware
+LOCAL_MODULE := hintbench
+LOCAL_MODULE_TAGS := optional
+include $(BUILD_EXECUTABLE)
+
+# HAL load-to-first-hint latency, with and without the loader thread
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := halloadbench.c
+LOCAL_SHARED_LIBRARIES := libhardware libcutils libdl
+LOCAL_MODULE := halloadbench
+LOCAL_MODULE_TAGS := optional
+include $(BUILD_EXECUTABLE)
+
+# Throughput variance under high and sustained performance
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := sustainbench.c
+LOCAL_SHARED_LIBRARIES := libhardware
+LOCAL_MODULE := sustainbench
+LOCAL_MODULE_TAGS := optional
+include $(BUILD_EXECUTABLE)
+
+# Offline policy simulator; runs on the host with this target's backend
+include $(CLEAR_VARS)
+
+LOCAL_SHARED_LIBRARIES := liblog
+LOCAL_C_INCLUDES := $(LOCAL_PATH)/sim $(LOCAL_PATH)/../socinfo \
+    hardware/libhardware/include
+LOCAL_SRC_FILES := sim/powersim.c sim/sim-model.c sim/sim-hal.c \
+    boost-policy.c boost-budget.c launch-policy.c metadata-parser.c \
+    vsync-boost.c \
+    $(POWERHAL_TARGET_SRC)
+LOCAL_MODULE := powersim
+LOCAL_MODULE_TAGS := optional
+include $(BUILD_HOST_EXECUTABLE)
+
+# Boost vector autotuner, fed logcat captures from tune/powertune-collect.sh
+include $(CLEAR_VARS)
+
+LOCAL_C_INCLUDES := $(LOCAL_PATH)/sim
+LOCAL_SRC_FILES := tune/powertune.c sim/sim-model.c
+LOCAL_MODULE := powertune
+LOCAL_MODULE_TAGS := optional
+include $(BUILD_HOST_EXECUTABLE)
+
+# schedutil backend against a fake sysfs tree; paths are relative to
+# the scratch directory the test creates
+include $(CLEAR_VARS)
+
+LOCAL_SHARED_LIBRARIES := liblog
+LOCAL_C_INCLUDES := hardware/libhardware/include
+LOCAL_CFLAGS := \
+    -DSCALING_GOVERNOR_PATH='"sys/devices/system/cpu/cpu0/cpufreq/scaling_governor"' \
+    -DAVAILABLE_GOVERNORS_PATH='"sys/devices/system/cpu/cpu0/cpufreq/scaling_available_governors"' \
+    -DCPUFREQ_POLICY_PATH='"sys/devices/system/cpu/cpufreq/policy%d/"' \
+    -DSCHEDUTIL_UCLAMP_PATH='"dev/cpuctl/top-app/cpu.uclamp.min"'
+LOCAL_SRC_FILES := tests/schedutil-test.c schedutil.c metadata-parser.c
+LOCAL_MODULE := schedutil-test
+LOCAL_MODULE_TAGS := optional
+include $(BUILD_HOST_EXECUTABLE)
+
 endif # TARGET_POWERHAL_VARIANT == qcom || WITH_QC_PERF
@@ -0,0 +1,228 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * Boost budgets for custom power profiles and battery saver.
+ *
+ * Dropping every boost in power save makes the UI feel broken, while
+ * passing them all through defeats the profile. Instead, boosts are
+ * layered over the profile (which keeps its frequency and core
+ * ceilings, see boost() in utils.c) and paid for from a token bucket
+ * of boost time that refills while the device is left alone.
+ */
+
+#define LOG_NIDEBUG 0
+
+#include <pthread.h>
+#include <hardware/power.h>
+
+#define LOG_TAG "QCOM PowerHAL"
+#include <utils/Log.h>
+
+#include "power-common.h"
+#include "power-timer.h"
+#include "power-state.h"
+#include "boost-budget.h"
+
+#define UNBUDGETED              { -1, 0, 0 }
+
+static const struct boost_budget default_budgets[BOOST_BUDGET_COUNT] = {
+    /* A launch or a second of scrolling, then a quarter of the time */
+    [PROFILE_POWER_SAVE]            = { 1000, 250, 1000 },
+    [PROFILE_BALANCED]              = UNBUDGETED,
+    [PROFILE_HIGH_PERFORMANCE]      = UNBUDGETED,
+    [PROFILE_BIAS_POWER]            = { 2000, 500, 1500 },
+    [PROFILE_BIAS_PERFORMANCE]      = UNBUDGETED,
+    /* Boosts would break the steady clocks the profile promises. */
+    [PROFILE_SUSTAINED_PERFORMANCE] = { 0, 0, 0 },
+    /* One short wake boost every two seconds */
+    [BOOST_BUDGET_LOW_POWER]        = { 500, 250, 500 },
+};
+
+static pthread_mutex_t budget_mutex = PTHREAD_MUTEX_INITIALIZER;
+static int profile = PROFILE_BALANCED;
+static int low_power;
+static int current = -1;
+static struct boost_budget budget;
+static long long tokens_ms;
+static long long refilled_ms;
+/* Refill earned since refilled_ms, in thousandths of a ms */
+static long long refill_rem;
+static struct boost_budget_stats budget_stats[BOOST_BUDGET_COUNT];
+
+void __attribute__ ((weak)) get_boost_budget(int budget, struct boost_budget *out)
+{
+    *out = default_budgets[budget];
+}
+
+/*
+ * Hints come in faster than a slow budget earns a whole ms, so carry
+ * the fraction over instead of losing it on every call.
+ */
+static void refill_locked(long long now)
+{
+    long long earned;
+
+    if (budget.capacity_ms <= 0)
+        return;
+
+    earned = (now - refilled_ms) * budget.refill_ms_per_s + refill_rem;
+    tokens_ms += earned / 1000;
+    refill_rem = earned % 1000;
+    if (tokens_ms >= budget.capacity_ms) {
+        tokens_ms = budget.capacity_ms;
+        refill_rem = 0;
+    }
+    refilled_ms = now;
+}
+
+/* Publish the budget in force. Called with budget_mutex held. */
+static void publish_locked(void)
+{
+    struct power_state_budget state;
+
+    state.tokens_ms = budget.capacity_ms >= 0 ? tokens_ms : -1;
+    state.granted = budget_stats[current].granted;
+    state.clamped = budget_stats[current].clamped;
+    state.denied = budget_stats[current].denied;
+    state.consumed_ms = budget_stats[current].consumed_ms;
+    power_state_set_budget(current, &state);
+}
+
+/* Switch to the budget now in force, starting it with a full bucket. */
+static void select_locked(void)
+{
+    int next = low_power ? BOOST_BUDGET_LOW_POWER : profile;
+
+    if (next < 0 || next >= BOOST_BUDGET_COUNT)
+        next = PROFILE_BALANCED;
+    if (next == current)
+        return;
+
+    current = next;
+    get_boost_budget(current, &budget);
+    tokens_ms = budget.capacity_ms;
+    refilled_ms = power_timer_now_ms();
+    refill_rem = 0;
+    publish_locked();
+}
+
+/*
+ * Returns the duration the boost may run for, 0 to drop it. Nothing is
+ * taken from the bucket until boost_budget_charge().
+ */
+int boost_budget_grant(int duration_ms)
+{
+    int granted = duration_ms;
+
+    if (duration_ms <= 0)
+        return 0;
+
+    pthread_mutex_lock(&budget_mutex);
+
+    select_locked();
+    if (budget.capacity_ms < 0)
+        goto out;
+
+    refill_locked(power_timer_now_ms());
+
+    if (budget.max_boost_ms > 0 && granted > budget.max_boost_ms)
+        granted = budget.max_boost_ms;
+    if (granted > tokens_ms)
+        granted = tokens_ms;
+    if (granted < BOOST_BUDGET_MIN_GRANT_MS && granted < duration_ms) {
+        granted = 0;
+        budget_stats[current].denied++;
+        publish_locked();
+    }
+
+out:
+    pthread_mutex_unlock(&budget_mutex);
+
+    return granted;
+}
+
+/* Pay for a boost that took effect, granted_ms of requested_ms. */
+void boost_budget_charge(int requested_ms, int granted_ms)
+{
+    struct boost_budget_stats *stats;
+
+    if (granted_ms <= 0)
+        return;
+
+    pthread_mutex_lock(&budget_mutex);
+
+    select_locked();
+    stats = &budget_stats[current];
+
+    if (budget.capacity_ms >= 0) {
+        refill_locked(power_timer_now_ms());
+        tokens_ms -= granted_ms;
+        if (tokens_ms < 0)
+            tokens_ms = 0;
+    }
+
+    stats->granted++;
+    if (granted_ms < requested_ms)
+        stats->clamped++;
+    stats->consumed_ms += granted_ms;
+    publish_locked();
+
+    pthread_mutex_unlock(&budget_mutex);
+}
+
+void boost_budget_set_profile(int new_profile)
+{
+    pthread_mutex_lock(&budget_mutex);
+    profile = new_profile;
+    select_locked();
+    pthread_mutex_unlock(&budget_mutex);
+}
+
+void boost_budget_set_low_power(int on)
+{
+    pthread_mutex_lock(&budget_mutex);
+    low_power = !!on;
+    select_locked();
+    pthread_mutex_unlock(&budget_mutex);
+}
+
+/* Hints a backend should pass on, budgeted, in a custom power profile. */
+int boost_budget_layered_hint(int hint)
+{
+    return hint == POWER_HINT_INTERACTION || hint == POWER_HINT_CPU_BOOST ||
+            hint == POWER_HINT_LAUNCH_BOOST;
+}
+
+void boost_budget_get_stats(struct boost_budget_stats stats[BOOST_BUDGET_COUNT])
+{
+    int i;
+
+    pthread_mutex_lock(&budget_mutex);
+
+    select_locked();
+    refill_locked(power_timer_now_ms());
+
+    for (i = 0; i < BOOST_BUDGET_COUNT; i++) {
+        stats[i] = budget_stats[i];
+        stats[i].tokens_ms = -1;
+    }
+    if (budget.capacity_ms >= 0)
+        stats[current].tokens_ms = tokens_ms;
+
+    pthread_mutex_unlock(&budget_mutex);
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef _QCOM_BOOST_BUDGET_H
+#define _QCOM_BOOST_BUDGET_H
+
+/* One budget per power profile, and one for battery saver. */
+#define BOOST_BUDGET_PROFILES       (PROFILE_SUSTAINED_PERFORMANCE + 1)
+#define BOOST_BUDGET_LOW_POWER      (BOOST_BUDGET_PROFILES)
+#define BOOST_BUDGET_COUNT          (BOOST_BUDGET_PROFILES + 1)
+
+/* Grants shorter than this aren't worth taking a lock for. */
+#define BOOST_BUDGET_MIN_GRANT_MS   (50)
+
+/*
+ * A token bucket of boost time. It holds up to capacity_ms and refills
+ * at refill_ms_per_s; each boost is cut to max_boost_ms and to what is
+ * left in the bucket. A capacity of -1 means boosts are not budgeted,
+ * 0 that they are dropped.
+ */
+struct boost_budget {
+    int capacity_ms;
+    int refill_ms_per_s;
+    int max_boost_ms;
+};
+
+struct boost_budget_stats {
+    /* Time left in the bucket, -1 if unbudgeted */
+    int tokens_ms;
+    unsigned long granted;
+    /* Granted, but shorter than asked for */
+    unsigned long clamped;
+    unsigned long denied;
+    long long consumed_ms;
+};
+
+int boost_budget_grant(int duration_ms);
+void boost_budget_charge(int requested_ms, int granted_ms);
+void boost_budget_set_profile(int profile);
+void boost_budget_set_low_power(int on);
+int boost_budget_layered_hint(int hint);
+void boost_budget_get_stats(struct boost_budget_stats stats[BOOST_BUDGET_COUNT]);
+
+void get_boost_budget(int budget, struct boost_budget *out);
+
+#endif
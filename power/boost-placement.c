@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Task placement for boosts.
+ *
+ * Raising frequencies does not help a launching app whose threads the
+ * scheduler keeps on the little cluster. Targets that want it list
+ * cpuset and HMP migration nodes that pull foreground work onto the
+ * big cores; interaction() applies them for the length of each boost.
+ * Boosts that overlap only move the expiry, as they do for the
+ * interaction perflock, and the original values are put back when the
+ * last one ends.
+ */
+
+#define LOG_NIDEBUG 0
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#define LOG_TAG "QCOM PowerHAL"
+#include <utils/Log.h>
+
+#include "utils.h"
+#include "power-common.h"
+#include "power-timer.h"
+#include "boost-placement.h"
+
+static pthread_mutex_t placement_mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct power_timer expiry_timer;
+
+static const struct boost_placement_node *nodes;
+static int num_nodes = -1;
+static char saved[BOOST_PLACEMENT_MAX_NODES][NODE_MAX];
+static int active;
+
+int __attribute__ ((weak)) get_boost_placement(
+        __attribute__((unused)) const struct boost_placement_node **nodes)
+{
+    return 0;
+}
+
+static void apply_locked(void)
+{
+    int i, len;
+
+    for (i = 0; i < num_nodes; i++) {
+        saved[i][0] = '\0';
+
+        /* top-app only exists on newer releases; skip what's missing. */
+        if (access(nodes[i].path, F_OK))
+            continue;
+
+        if (sysfs_read((char *)nodes[i].path, saved[i], NODE_MAX) == -1) {
+            saved[i][0] = '\0';
+            continue;
+        }
+
+        len = strlen(saved[i]);
+        while (len > 0 && saved[i][len - 1] == '\n')
+            saved[i][--len] = '\0';
+
+        if (sysfs_write((char *)nodes[i].path, (char *)nodes[i].value) == -1)
+            saved[i][0] = '\0';
+    }
+}
+
+static void restore_locked(void)
+{
+    int i;
+
+    for (i = num_nodes - 1; i >= 0; i--) {
+        if (saved[i][0])
+            sysfs_write((char *)nodes[i].path, saved[i]);
+    }
+}
+
+static void expiry_timer_expired(__attribute__((unused)) void *data)
+{
+    pthread_mutex_lock(&placement_mutex);
+
+    /* A boost that came in after the timer fired has re-armed it. */
+    if (active && !power_timer_pending(&expiry_timer)) {
+        restore_locked();
+        active = 0;
+    }
+
+    pthread_mutex_unlock(&placement_mutex);
+}
+
+int boost_placement_begin(int duration_ms)
+{
+    int ret;
+
+    if (duration_ms <= 0)
+        return 0;
+
+    pthread_mutex_lock(&placement_mutex);
+
+    if (num_nodes < 0) {
+        num_nodes = get_boost_placement(&nodes);
+        if (num_nodes > BOOST_PLACEMENT_MAX_NODES)
+            num_nodes = BOOST_PLACEMENT_MAX_NODES;
+        if (num_nodes > 0)
+            power_timer_init(&expiry_timer, expiry_timer_expired, NULL);
+    }
+
+    if (num_nodes <= 0)
+        goto out;
+
+    if (!active) {
+        apply_locked();
+        active = 1;
+    }
+
+    if (power_timer_arm(&expiry_timer, duration_ms)) {
+        /* No timer thread: don't leave tasks pinned. */
+        restore_locked();
+        active = 0;
+    }
+
+out:
+    ret = active;
+    pthread_mutex_unlock(&placement_mutex);
+
+    return ret;
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _QCOM_BOOST_PLACEMENT_H
+#define _QCOM_BOOST_PLACEMENT_H
+
+/* Overridable so placement can be pointed at a fake cgroupfs. */
+#ifndef CPUSET_PATH
+#define CPUSET_PATH             "/dev/cpuset/"
+#endif
+#ifndef SCHED_KNOB_PATH
+#define SCHED_KNOB_PATH         "/proc/sys/kernel/"
+#endif
+
+#define BOOST_PLACEMENT_MAX_NODES   (8)
+
+/*
+ * A node written for the length of a boost. Nodes are written in table
+ * order and restored in reverse, so e.g. sched_downmigrate can be
+ * lowered before sched_upmigrate and raised back after it.
+ */
+struct boost_placement_node {
+    const char *path;
+    const char *value;
+};
+
+int boost_placement_begin(int duration_ms);
+
+int get_boost_placement(const struct boost_placement_node **nodes);
+
+#endif
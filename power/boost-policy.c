@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * What a boost asks for. The HAL (utils.c) and powersim apply boosts
+ * differently, but both decide them here:
+ *
+ *  - a launch takes its package's vector class and duration from
+ *    launch-policy.c;
+ *  - the boost budget grants the duration, possibly shorter;
+ *  - the resources are clamped under the ceilings of the power profile
+ *    and battery saver hints, so boosts layered over them can raise
+ *    floors but not above what the profile allows.
+ *
+ * Once the caller has applied the boost, boost_policy_applied() pays
+ * for it from the budget. boost_policy_profile() says which profile's
+ * ceilings those are while battery saver is on.
+ */
+
+#define LOG_NIDEBUG 0
+
+#include <hardware/power.h>
+
+#define LOG_TAG "QCOM PowerHAL"
+#include <utils/Log.h>
+
+#include "utils.h"
+#include "hint-data.h"
+#include "power-common.h"
+#include "performance.h"
+#include "boost-budget.h"
+#include "launch-policy.h"
+#include "boost-policy.h"
+
+/* Profile and battery saver vectors are short; this is plenty. */
+#define MAX_CEILING_RESOURCES   (64)
+
+/*
+ * Per-CPU bases of the CPUx_MIN_FREQ / CPUx_MAX_FREQ opcodes in
+ * performance.h; the low byte is the frequency in units of 100 MHz.
+ */
+static const int cpu_min_freq_opcode[] = {
+    0x200, 0x300, 0x400, 0x500, 0x1F00, 0x2000, 0x2100, 0x2200
+};
+
+static const int cpu_max_freq_opcode[] = {
+    0x1500, 0x1600, 0x1700, 0x1800, 0x2300, 0x2400, 0x2500, 0x2600
+};
+
+#define NUM_CPU_OPCODES \
+        (int)(sizeof(cpu_min_freq_opcode)/sizeof(cpu_min_freq_opcode[0]))
+
+/*
+ * Build the min (is_max == 0) or max frequency opcode for 'cpu' that
+ * does not exceed freq_khz. Returns 0 if it can't be expressed.
+ */
+int get_cpu_freq_opcode(int cpu, int is_max, int freq_khz)
+{
+    int level = freq_khz / 100000;
+
+    if (cpu < 0 || cpu >= NUM_CPU_OPCODES)
+        return 0;
+
+    if (level < 1)
+        level = 1;
+    if (level > 0xFD)
+        level = 0xFD;
+
+    return (is_max ? cpu_max_freq_opcode[cpu] : cpu_min_freq_opcode[cpu]) | level;
+}
+
+/* Lower the level of 'opcode' to what a 'ceiling' opcode allows. */
+static int clamp_opcode(int opcode, int ceiling)
+{
+    int cpu, level = opcode & 0xFF, limit = ceiling & 0xFF;
+
+    /* CPUS_ONLINE_MIN_x under CPUS_ONLINE_MAX_LIMIT_y, per cluster */
+    if (((opcode & ~0xFF) == 0x700 && (ceiling & ~0xFF) == 0x800) ||
+            ((opcode & ~0xFF) == 0x4D00 && (ceiling & ~0xFF) == 0x3D00)) {
+        if (opcode != CPUS_ONLINE_MPD_OVERRIDE && level > 0xFF - limit)
+            return (opcode & ~0xFF) | (0xFF - limit);
+        return opcode;
+    }
+
+    /* CPUx_MIN_FREQ under CPUx_MAX_FREQ */
+    for (cpu = 0; cpu < NUM_CPU_OPCODES; cpu++) {
+        if ((opcode & ~0xFF) == cpu_min_freq_opcode[cpu] &&
+                (ceiling & ~0xFF) == cpu_max_freq_opcode[cpu] && level > limit)
+            return cpu_min_freq_opcode[cpu] | limit;
+    }
+
+    return opcode;
+}
+
+static void clamp_to_hint(int hint_id, int num_args, int opt_list[])
+{
+    int ceilings[MAX_CEILING_RESOURCES];
+    int i, j, num_ceilings;
+
+    num_ceilings = get_active_hint_resources(hint_id, ceilings,
+            MAX_CEILING_RESOURCES);
+    for (i = 0; i < num_args; i++) {
+        for (j = 0; j < num_ceilings; j++)
+            opt_list[i] = clamp_opcode(opt_list[i], ceilings[j]);
+    }
+}
+
+/*
+ * Shape a boost of 'type' for duration_ms over opt_list into 'req'.
+ * Returns 0 if there is nothing to apply: no resources, a skipped
+ * launch or no budget left.
+ */
+int boost_policy_prepare(int type, int duration_ms, int num_args,
+        int opt_list[], struct boost_request *req)
+{
+    int *resources;
+    int num_resources;
+    int i;
+
+    if (type == BOOST_LAUNCH) {
+        /* The backend's vector for this package's class, if it has one */
+        num_resources = get_launch_boost_resources(launch_policy_class(),
+                &resources);
+        if (num_resources > 0) {
+            num_args = num_resources;
+            opt_list = resources;
+        }
+        duration_ms = launch_policy_duration(duration_ms);
+    }
+
+    if (duration_ms <= 0 || num_args < 1 || opt_list[0] == 0)
+        return 0;
+
+    req->type = type;
+    req->requested_ms = duration_ms;
+    req->duration_ms = boost_budget_grant(duration_ms);
+    if (!req->duration_ms)
+        return 0;
+
+    /* Longer lists can't be copied; they go out unclamped. */
+    req->num_resources = num_args;
+    req->resources = opt_list;
+    if (num_args <= MAX_BOOST_RESOURCES) {
+        for (i = 0; i < num_args; i++)
+            req->clamped[i] = opt_list[i];
+        clamp_to_hint(DEFAULT_PROFILE_HINT_ID, num_args, req->clamped);
+        clamp_to_hint(DEFAULT_LOW_POWER_HINT_ID, num_args, req->clamped);
+        req->resources = req->clamped;
+    }
+
+    return 1;
+}
+
+/* The boost took effect somewhere; pay for it. */
+void boost_policy_applied(const struct boost_request *req)
+{
+    boost_budget_charge(req->requested_ms, req->duration_ms);
+}
+
+/*
+ * The profile to run for the user's 'profile'. Battery saver stacks on
+ * the power saving ones, but the performance ones give way to balanced.
+ */
+int boost_policy_profile(int profile, int low_power)
+{
+    if (low_power && (profile == PROFILE_HIGH_PERFORMANCE ||
+            profile == PROFILE_BIAS_PERFORMANCE ||
+            profile == PROFILE_SUSTAINED_PERFORMANCE))
+        return PROFILE_BALANCED;
+
+    return profile;
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef _QCOM_BOOST_POLICY_H
+#define _QCOM_BOOST_POLICY_H
+
+/* Largest boost opcode list that is clamped to the profile's ceilings */
+#define MAX_BOOST_RESOURCES     (32)
+
+enum boost_type {
+    BOOST_INTERACTION = 0,
+    BOOST_LAUNCH,
+};
+
+/* A boost as the policy shaped it, ready to be applied. */
+struct boost_request {
+    int type;
+    /* What the hint asked for, and what the budget granted */
+    int requested_ms;
+    int duration_ms;
+    int num_resources;
+    int *resources;
+    int clamped[MAX_BOOST_RESOURCES];
+};
+
+int boost_policy_prepare(int type, int duration_ms, int num_args,
+        int opt_list[], struct boost_request *req);
+void boost_policy_applied(const struct boost_request *req);
+int boost_policy_profile(int profile, int low_power);
+
+/* Resources 'hint_id' holds, or 0 if it isn't held; see utils.c. */
+int get_active_hint_resources(int hint_id, int resources[], int max);
+
+#endif
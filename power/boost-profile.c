@@ -0,0 +1,410 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Boost efficacy profiling.
+ *
+ * When BOOST_PROFILE_PROP is set, system-wide cycle and instruction
+ * counters are opened on every CPU and left running. Each boost window
+ * (an interaction() boost until its duration elapses, or a
+ * perform_hint_action() lock until undo_hint_action()) snapshots the
+ * counters, /proc/stat busy time and cpufreq time_in_state at both
+ * ends. The deltas are accumulated per boost type, i.e. per hint id and
+ * resource vector, and written to BOOST_PROFILE_DUMP as each window
+ * closes. Counters are system-wide, so overlapping windows each see the
+ * whole system; compare types by IPC and frequency residency rather
+ * than by absolute counts.
+ */
+
+#define LOG_NIDEBUG 0
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#define LOG_TAG "QCOM PowerHAL"
+#include <utils/Log.h>
+
+#include "utils.h"
+#include "power-timer.h"
+#include "boost-profile.h"
+
+struct counter_snapshot {
+    unsigned long long cycles;
+    unsigned long long instructions;
+    unsigned long long busy_ticks;
+    unsigned long long resid[BOOST_PROFILE_MAX_FREQS];
+};
+
+struct boost_type {
+    int hint_id;
+    int opcodes[BOOST_PROFILE_MAX_OPCODES];
+    int num_opcodes;
+    unsigned long windows;
+    long long wall_ms;
+    unsigned long long busy_ticks;
+    unsigned long long cycles;
+    unsigned long long instructions;
+    unsigned long long resid[BOOST_PROFILE_MAX_FREQS];
+};
+
+struct boost_window {
+    struct power_timer timer;
+    int active;
+    int hint_id;
+    int timed;
+    struct boost_type *type;
+    long long start_ms;
+    struct counter_snapshot start;
+};
+
+static pthread_mutex_t profile_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t profile_once = PTHREAD_ONCE_INIT;
+static int profile_enabled;
+
+static int num_cpus;
+static int cycles_fd[BOOST_PROFILE_MAX_CPUS];
+static int instructions_fd[BOOST_PROFILE_MAX_CPUS];
+
+/* Frequencies seen in time_in_state; resid[] is indexed in this order. */
+static int freqs[BOOST_PROFILE_MAX_FREQS];
+static int num_freqs;
+
+static struct boost_type types[BOOST_PROFILE_MAX_TYPES];
+static int num_types;
+static struct boost_window windows[BOOST_PROFILE_MAX_WINDOWS];
+
+static int open_counter(int cpu, unsigned long long config)
+{
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+            PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    return syscall(__NR_perf_event_open, &attr, -1, cpu, -1, 0);
+}
+
+/* Scale for multiplexing; a CPU that is offline simply reads as 0. */
+static unsigned long long read_counter(int fd)
+{
+    unsigned long long value[3];
+
+    if (fd < 0 || read(fd, value, sizeof(value)) != sizeof(value))
+        return 0;
+    if (value[2] == 0)
+        return 0;
+    if (value[2] < value[1])
+        return (unsigned long long)((double)value[0] * value[1] / value[2]);
+
+    return value[0];
+}
+
+static unsigned long long read_busy_ticks(void)
+{
+    char line[256];
+    unsigned long long busy = 0;
+    FILE *fp = fopen("/proc/stat", "r");
+
+    if (!fp)
+        return 0;
+
+    /* The first line is the sum over all CPUs. */
+    if (fgets(line, sizeof(line), fp)) {
+        unsigned long long user, nice, system, idle, iowait, irq, softirq;
+
+        if (sscanf(line, "cpu %llu %llu %llu %llu %llu %llu %llu", &user,
+                    &nice, &system, &idle, &iowait, &irq, &softirq) == 7)
+            busy = user + nice + system + irq + softirq;
+    }
+    fclose(fp);
+
+    return busy;
+}
+
+static int freq_index(int freq)
+{
+    int i;
+
+    for (i = 0; i < num_freqs; i++) {
+        if (freqs[i] == freq)
+            return i;
+    }
+
+    if (num_freqs == BOOST_PROFILE_MAX_FREQS)
+        return -1;
+
+    freqs[num_freqs] = freq;
+    return num_freqs++;
+}
+
+/*
+ * Sum time_in_state over all CPUs, in units of 10ms. Clusters report
+ * different frequency tables, so each distinct frequency gets a bucket.
+ */
+static void read_residency(unsigned long long resid[])
+{
+    char path[80];
+    char line[64];
+    int cpu;
+
+    memset(resid, 0, sizeof(resid[0]) * BOOST_PROFILE_MAX_FREQS);
+
+    for (cpu = 0; cpu < num_cpus; cpu++) {
+        FILE *fp;
+
+        snprintf(path, sizeof(path),
+                "/sys/devices/system/cpu/cpu%d/cpufreq/stats/time_in_state", cpu);
+        fp = fopen(path, "r");
+        if (!fp)
+            continue;
+
+        while (fgets(line, sizeof(line), fp)) {
+            int freq, idx;
+            unsigned long long time;
+
+            if (sscanf(line, "%d %llu", &freq, &time) != 2)
+                continue;
+            idx = freq_index(freq);
+            if (idx >= 0)
+                resid[idx] += time;
+        }
+        fclose(fp);
+    }
+}
+
+static void take_snapshot(struct counter_snapshot *snap)
+{
+    int cpu;
+
+    snap->cycles = 0;
+    snap->instructions = 0;
+    for (cpu = 0; cpu < num_cpus; cpu++) {
+        snap->cycles += read_counter(cycles_fd[cpu]);
+        snap->instructions += read_counter(instructions_fd[cpu]);
+    }
+    snap->busy_ticks = read_busy_ticks();
+    read_residency(snap->resid);
+}
+
+static void profile_init(void)
+{
+    char value[PROPERTY_VALUE_MAX];
+    int cpu, opened = 0;
+
+    property_get(BOOST_PROFILE_PROP, value, "0");
+    if (strcmp(value, "1") && strcmp(value, "true"))
+        return;
+
+    num_cpus = sysconf(_SC_NPROCESSORS_CONF);
+    if (num_cpus > BOOST_PROFILE_MAX_CPUS)
+        num_cpus = BOOST_PROFILE_MAX_CPUS;
+
+    for (cpu = 0; cpu < num_cpus; cpu++) {
+        cycles_fd[cpu] = open_counter(cpu, PERF_COUNT_HW_CPU_CYCLES);
+        instructions_fd[cpu] = open_counter(cpu, PERF_COUNT_HW_INSTRUCTIONS);
+        if (cycles_fd[cpu] >= 0 && instructions_fd[cpu] >= 0)
+            opened++;
+    }
+
+    if (!opened) {
+        ALOGE("Boost profiling: no perf counters available: %s",
+                strerror(errno));
+        /* Busy time and residency are still worth having. */
+    }
+
+    /* Learn the frequency tables so every bucket has a baseline. */
+    read_residency(windows[0].start.resid);
+    mkdir("/data/misc/power", 0771);
+
+    profile_enabled = 1;
+    ALOGI("Boost profiling enabled on %d CPUs, %d with counters",
+            num_cpus, opened);
+}
+
+int boost_profile_enabled(void)
+{
+    pthread_once(&profile_once, profile_init);
+
+    return profile_enabled;
+}
+
+static struct boost_type *find_type(int hint_id, int resources[],
+        int num_resources)
+{
+    int i, n = num_resources;
+
+    if (n > BOOST_PROFILE_MAX_OPCODES)
+        n = BOOST_PROFILE_MAX_OPCODES;
+
+    for (i = 0; i < num_types; i++) {
+        if (types[i].hint_id == hint_id && types[i].num_opcodes == n &&
+                !memcmp(types[i].opcodes, resources, n * sizeof(int)))
+            return &types[i];
+    }
+
+    if (num_types == BOOST_PROFILE_MAX_TYPES)
+        return NULL;
+
+    types[num_types].hint_id = hint_id;
+    types[num_types].num_opcodes = n;
+    memcpy(types[num_types].opcodes, resources, n * sizeof(int));
+
+    return &types[num_types++];
+}
+
+static void write_dump(void)
+{
+    char path[] = BOOST_PROFILE_DUMP ".tmp";
+    long tick_ms = 1000 / sysconf(_SC_CLK_TCK);
+    FILE *fp;
+    int i, j;
+
+    fp = fopen(path, "w");
+    if (!fp) {
+        ALOGE("Unable to write %s: %s", path, strerror(errno));
+        return;
+    }
+
+    for (i = 0; i < num_types; i++) {
+        struct boost_type *t = &types[i];
+        unsigned long long busy_ms = t->busy_ticks * tick_ms;
+
+        fprintf(fp, "hint=0x%x res=", t->hint_id);
+        for (j = 0; j < t->num_opcodes; j++)
+            fprintf(fp, "%s0x%x", j ? "," : "", t->opcodes[j]);
+        fprintf(fp, " windows=%lu wall_ms=%lld busy_ms=%llu cycles=%llu"
+                " instructions=%llu ipc=%.3f mhz=%llu resid=",
+                t->windows, t->wall_ms, busy_ms, t->cycles, t->instructions,
+                t->cycles ? (double)t->instructions / t->cycles : 0.0,
+                busy_ms ? t->cycles / busy_ms / 1000 : 0);
+        for (j = 0; j < num_freqs; j++) {
+            if (t->resid[j])
+                fprintf(fp, "%d:%llu,", freqs[j], t->resid[j] * 10);
+        }
+        fprintf(fp, "\n");
+    }
+
+    fclose(fp);
+    if (rename(path, BOOST_PROFILE_DUMP))
+        ALOGE("Unable to write %s: %s", BOOST_PROFILE_DUMP, strerror(errno));
+}
+
+/* Called with profile_mutex held. */
+static void close_window(struct boost_window *w)
+{
+    struct counter_snapshot end;
+    struct boost_type *t = w->type;
+    int i;
+
+    w->active = 0;
+    if (!t)
+        return;
+
+    take_snapshot(&end);
+
+    t->windows++;
+    t->wall_ms += power_timer_now_ms() - w->start_ms;
+    t->busy_ticks += end.busy_ticks - w->start.busy_ticks;
+    t->cycles += end.cycles - w->start.cycles;
+    t->instructions += end.instructions - w->start.instructions;
+    for (i = 0; i < num_freqs; i++)
+        t->resid[i] += end.resid[i] - w->start.resid[i];
+
+    write_dump();
+}
+
+static void window_expired(void *data)
+{
+    struct boost_window *w = data;
+
+    pthread_mutex_lock(&profile_mutex);
+    /* The slot may have been closed or restarted in the meantime. */
+    if (w->active && !power_timer_pending(&w->timer))
+        close_window(w);
+    pthread_mutex_unlock(&profile_mutex);
+}
+
+/*
+ * Open a window for a boost. A positive duration closes it on its own;
+ * otherwise it stays open until boost_profile_end(hint_id). A new boost
+ * with the same hint id replaces the lock, so it closes the old window.
+ */
+void boost_profile_begin(int hint_id, int resources[], int num_resources,
+        int duration_ms)
+{
+    struct boost_window *w = NULL;
+    int i;
+
+    if (!boost_profile_enabled() || num_resources < 1)
+        return;
+
+    pthread_mutex_lock(&profile_mutex);
+
+    for (i = 0; i < BOOST_PROFILE_MAX_WINDOWS; i++) {
+        if (windows[i].active && windows[i].hint_id == hint_id) {
+            power_timer_cancel(&windows[i].timer);
+            close_window(&windows[i]);
+        }
+        if (!windows[i].active && !w)
+            w = &windows[i];
+    }
+
+    if (!w) {
+        ALOGW("Boost profiling: too many open windows");
+        goto out;
+    }
+
+    power_timer_init(&w->timer, window_expired, w);
+    w->active = 1;
+    w->hint_id = hint_id;
+    w->timed = duration_ms > 0;
+    w->type = find_type(hint_id, resources, num_resources);
+    w->start_ms = power_timer_now_ms();
+    take_snapshot(&w->start);
+
+    if (w->timed && power_timer_arm(&w->timer, duration_ms) != 0)
+        w->active = 0;
+
+out:
+    pthread_mutex_unlock(&profile_mutex);
+}
+
+void boost_profile_end(int hint_id)
+{
+    int i;
+
+    if (!profile_enabled)
+        return;
+
+    pthread_mutex_lock(&profile_mutex);
+    for (i = 0; i < BOOST_PROFILE_MAX_WINDOWS; i++) {
+        if (windows[i].active && !windows[i].timed &&
+                windows[i].hint_id == hint_id)
+            close_window(&windows[i]);
+    }
+    pthread_mutex_unlock(&profile_mutex);
+}
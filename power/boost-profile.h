@@ -0,0 +1,35 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _QCOM_BOOST_PROFILE_H
+#define _QCOM_BOOST_PROFILE_H
+
+/* Set to 1 to measure every boost window; read once at first use. */
+#define BOOST_PROFILE_PROP      "persist.power.boost_profile"
+#define BOOST_PROFILE_DUMP      "/data/misc/power/boost_profile"
+
+#define BOOST_PROFILE_MAX_CPUS      (8)
+#define BOOST_PROFILE_MAX_TYPES     (32)
+#define BOOST_PROFILE_MAX_WINDOWS   (8)
+#define BOOST_PROFILE_MAX_OPCODES   (8)
+#define BOOST_PROFILE_MAX_FREQS     (32)
+
+int boost_profile_enabled(void);
+void boost_profile_begin(int hint_id, int resources[], int num_resources,
+        int duration_ms);
+void boost_profile_end(int hint_id);
+
+#endif
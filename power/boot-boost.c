@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Boot boost.
+ *
+ * From power_init() until sys.boot_completed is set, the target's boot
+ * vector is held as a HAL-owned hint, so it is queued while the vendor
+ * library loads and re-acquired if perfd restarts like any other. The
+ * property is polled on the timer thread. The boost is dropped after
+ * BOOT_BOOST_MAX_MS whatever the property says, and the hint reaper
+ * holds the hint to the same limit as a backstop.
+ */
+
+#define LOG_NIDEBUG 0
+
+#include <pthread.h>
+#include <stdlib.h>
+
+#define LOG_TAG "QCOM PowerHAL"
+#include <utils/Log.h>
+#include <cutils/properties.h>
+
+#include "utils.h"
+#include "hint-data.h"
+#include "power-timer.h"
+#include "power-state.h"
+#include "boot-boost.h"
+
+static pthread_mutex_t boot_boost_mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct power_timer poll_timer;
+static struct boot_boost_stats stats;
+static long long start_ms;
+
+int __attribute__ ((weak)) get_boot_boost_resources(
+        __attribute__((unused)) const int **resources)
+{
+    return 0;
+}
+
+static int boot_completed(void)
+{
+    char value[PROPERTY_VALUE_MAX];
+
+    property_get(BOOT_COMPLETED_PROP, value, "0");
+
+    return atoi(value) == 1;
+}
+
+static void release_locked(int state)
+{
+    undo_hint_action(BOOT_BOOST_HINT_ID);
+
+    stats.state = state;
+    stats.held_ms = power_timer_now_ms() - start_ms;
+    power_state_set_boot_boost(stats.state, start_ms, stats.held_ms);
+
+    ALOGI("Boot boost released after %lld ms (%s)", stats.held_ms,
+            state == BOOT_BOOST_COMPLETED ? "boot completed" : "timed out");
+}
+
+static void poll_timer_expired(__attribute__((unused)) void *data)
+{
+    long long held_ms;
+
+    pthread_mutex_lock(&boot_boost_mutex);
+
+    if (stats.state != BOOT_BOOST_HELD)
+        goto out;
+
+    held_ms = power_timer_now_ms() - start_ms;
+
+    if (boot_completed())
+        release_locked(BOOT_BOOST_COMPLETED);
+    else if (held_ms >= BOOT_BOOST_MAX_MS)
+        release_locked(BOOT_BOOST_TIMED_OUT);
+    else if (power_timer_arm(&poll_timer, BOOT_BOOST_POLL_MS))
+        /* Nothing would ever release it. */
+        release_locked(BOOT_BOOST_TIMED_OUT);
+
+out:
+    pthread_mutex_unlock(&boot_boost_mutex);
+}
+
+/* Called once from power_init(). */
+void boot_boost_start(void)
+{
+    const int *resources;
+    int num_resources;
+
+    pthread_mutex_lock(&boot_boost_mutex);
+
+    if (stats.state != BOOT_BOOST_IDLE)
+        goto out;
+
+    /* The HAL restarted after boot. */
+    if (boot_completed())
+        goto out;
+
+    num_resources = get_boot_boost_resources(&resources);
+    if (num_resources <= 0)
+        goto out;
+
+    power_timer_init(&poll_timer, poll_timer_expired, NULL);
+    if (power_timer_arm(&poll_timer, BOOT_BOOST_POLL_MS))
+        goto out;
+
+    start_ms = power_timer_now_ms();
+    /* perf_lock_acq() takes a non-const list but never writes to it. */
+    perform_hint_action(BOOT_BOOST_HINT_ID, (int *)resources, num_resources);
+    stats.state = BOOT_BOOST_HELD;
+    power_state_set_boot_boost(stats.state, start_ms, 0);
+
+    ALOGI("Boot boost held until boot completes, at most %d ms",
+            BOOT_BOOST_MAX_MS);
+
+out:
+    pthread_mutex_unlock(&boot_boost_mutex);
+}
@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _QCOM_BOOT_BOOST_H
+#define _QCOM_BOOT_BOOST_H
+
+#define BOOT_COMPLETED_PROP     "sys.boot_completed"
+
+#define BOOT_BOOST_POLL_MS      (1000)
+/* Released at this point even if boot never completes */
+#ifndef BOOT_BOOST_MAX_MS
+#define BOOT_BOOST_MAX_MS       (90 * 1000)
+#endif
+
+enum boot_boost_state {
+    /* Not started, or the HAL came up after boot */
+    BOOT_BOOST_IDLE = 0,
+    BOOT_BOOST_HELD,
+    BOOT_BOOST_COMPLETED,
+    BOOT_BOOST_TIMED_OUT,
+};
+
+struct boot_boost_stats {
+    int state;
+    /* How long the boost was (or has been) held */
+    long long held_ms;
+};
+
+void boot_boost_start(void);
+
+int get_boot_boost_resources(const int **resources);
+
+#endif
@@ -0,0 +1,559 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * Native cluster core-count manager.
+ *
+ * The CPUS_ONLINE_* opcodes are carried out by the vendor daemon and
+ * mpdecision. When there is no vendor library, requests that carry
+ * them come here instead, and are mapped onto each cluster's core_ctl
+ * min_cpus/max_cpus. Clusters without core_ctl fall back to hotplug.
+ *
+ * Requests are keyed by hint id and either held until released or
+ * timed. Per cluster, the highest min and the lowest max win, and a
+ * min wins over a max. Raising min_cpus takes effect at once. Lowering
+ * it waits CORE_CTL_HYSTERESIS_MS, so a stream of short boosts doesn't
+ * park and unpark cores between touches.
+ *
+ * Opcodes, by cluster in get_core_ctl_clusters() order:
+ *   0x7NN   cluster 0 min NN (0xFF: every CPU of every cluster)
+ *   0x777   "4+0": every cluster after the first parked
+ *   0x4DNN  cluster 1 min NN
+ *   0x8NN   cluster 0 max 0xFF - NN
+ *   0x3DNN  cluster 1 max 0xFF - NN
+ */
+
+#define LOG_NIDEBUG 0
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define LOG_TAG "QCOM PowerHAL"
+#include <utils/Log.h>
+
+#include "utils.h"
+#include "performance.h"
+#include "power-common.h"
+#include "power-state.h"
+#include "power-timer.h"
+#include "core-ctl.h"
+
+#define PATH_LEN                (128)
+#define LEVEL_ALL               (0xFF)
+#define RATE_WINDOW_MS          (60 * 1000)
+#define RATE_SLOTS              (64)
+
+struct request {
+    int used;
+    int id;
+    int timed;
+    /* -1 where the request has no opinion */
+    int min_cpus[CORE_CTL_MAX_CLUSTERS];
+    int max_cpus[CORE_CTL_MAX_CLUSTERS];
+    struct power_timer timer;
+};
+
+struct cluster_state {
+    int has_core_ctl;
+    /* core_ctl's own limits, put back when nothing asks for others */
+    int base_min;
+    int base_max;
+    /* Applied limits */
+    int min_cpus;
+    int max_cpus;
+    /* When a pending min_cpus drop may be applied, 0 if none is */
+    long long drop_due_ms;
+    /* CPUs hotplugged out to honour max_cpus */
+    unsigned int parked;
+};
+
+static pthread_mutex_t core_ctl_mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct request requests[CORE_CTL_MAX_REQUESTS];
+static struct cluster_state state[CORE_CTL_MAX_CLUSTERS];
+static const struct core_ctl_cluster *clusters;
+static int num_clusters = -1;
+static struct power_timer hysteresis_timer;
+/* Published on the state page, see publish_stats_locked() */
+static unsigned long num_requests;
+static unsigned long num_transitions;
+static long long transition_ms[RATE_SLOTS];
+static int next_transition;
+static long long last_transition_ms;
+static unsigned int online_mask;
+
+/* Without a table, treat every CPU as one cluster. */
+int __attribute__ ((weak)) get_core_ctl_clusters(
+        const struct core_ctl_cluster **clusters)
+{
+    static struct core_ctl_cluster all_cpus;
+    long n = sysconf(_SC_NPROCESSORS_CONF);
+
+    if (n < 1)
+        return 0;
+
+    all_cpus.first_cpu = 0;
+    all_cpus.num_cpus = n > CORE_CTL_MAX_CPUS ? CORE_CTL_MAX_CPUS : n;
+    *clusters = &all_cpus;
+    return 1;
+}
+
+static int read_int(const char *path, int *value)
+{
+    char buf[NODE_MAX];
+    int fd, len;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return -1;
+    len = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (len <= 0)
+        return -1;
+
+    buf[len] = '\0';
+    *value = atoi(buf);
+    return 0;
+}
+
+static int write_int(const char *path, int value)
+{
+    char buf[NODE_MAX];
+
+    snprintf(buf, sizeof(buf), "%d", value);
+    return sysfs_write((char *)path, buf);
+}
+
+static void core_ctl_path(int c, const char *node, char *path)
+{
+    snprintf(path, PATH_LEN, CORE_CTL_CPU_PATH "cpu%d/core_ctl/%s",
+            clusters[c].first_cpu, node);
+}
+
+/* CPUs without an online node (usually cpu0) can't be unplugged. */
+static int cpu_online(int cpu)
+{
+    char path[PATH_LEN];
+    int online;
+
+    snprintf(path, sizeof(path), CORE_CTL_CPU_PATH "cpu%d/online", cpu);
+    if (read_int(path, &online))
+        return 1;
+
+    return online;
+}
+
+static int set_cpu_online(int cpu, int online)
+{
+    char path[PATH_LEN];
+
+    snprintf(path, sizeof(path), CORE_CTL_CPU_PATH "cpu%d/online", cpu);
+    if (access(path, F_OK))
+        return -1;
+
+    return write_int(path, online);
+}
+
+static void request_expired(void *data);
+static void hysteresis_expired(void *data);
+
+static void init_locked(void)
+{
+    char path[PATH_LEN];
+    int c, i;
+
+    num_clusters = get_core_ctl_clusters(&clusters);
+    if (num_clusters > CORE_CTL_MAX_CLUSTERS)
+        num_clusters = CORE_CTL_MAX_CLUSTERS;
+
+    power_timer_init(&hysteresis_timer, hysteresis_expired, NULL);
+    for (i = 0; i < CORE_CTL_MAX_REQUESTS; i++)
+        power_timer_init(&requests[i].timer, request_expired, &requests[i]);
+
+    for (c = 0; c < num_clusters; c++) {
+        struct cluster_state *cl = &state[c];
+
+        core_ctl_path(c, "min_cpus", path);
+        if (!read_int(path, &cl->base_min)) {
+            core_ctl_path(c, "max_cpus", path);
+            cl->has_core_ctl = !read_int(path, &cl->base_max);
+        }
+        if (!cl->has_core_ctl) {
+            cl->base_min = 0;
+            cl->base_max = clusters[c].num_cpus;
+        }
+
+        cl->min_cpus = cl->base_min;
+        cl->max_cpus = cl->base_max;
+        ALOGI("core_ctl: cluster%d (cpu%d-%d) %s", c, clusters[c].first_cpu,
+                clusters[c].first_cpu + clusters[c].num_cpus - 1,
+                cl->has_core_ctl ? "has core_ctl" : "falls back to hotplug");
+    }
+}
+
+static void decode(int opcode, struct request *req)
+{
+    int level = opcode & 0xFF;
+    int c;
+
+    switch (opcode >> 8) {
+    case 0x07:
+        if (opcode == CPUS_ONLINE_MPD_OVERRIDE) {
+            for (c = 1; c < num_clusters; c++)
+                req->max_cpus[c] = 0;
+        } else if (level == LEVEL_ALL) {
+            for (c = 0; c < num_clusters; c++)
+                req->min_cpus[c] = clusters[c].num_cpus;
+        } else {
+            req->min_cpus[0] = level;
+        }
+        break;
+    case 0x4D:
+        if (num_clusters > 1)
+            req->min_cpus[1] = level == LEVEL_ALL ? clusters[1].num_cpus : level;
+        break;
+    case 0x08:
+        req->max_cpus[0] = LEVEL_ALL - level;
+        break;
+    case 0x3D:
+        if (num_clusters > 1)
+            req->max_cpus[1] = LEVEL_ALL - level;
+        break;
+    }
+}
+
+static int recent_transitions(long long now)
+{
+    int i, n = 0;
+
+    for (i = 0; i < RATE_SLOTS; i++) {
+        if (transition_ms[i] && now - transition_ms[i] < RATE_WINDOW_MS)
+            n++;
+    }
+
+    return n;
+}
+
+static void count_transition(long long now)
+{
+    num_transitions++;
+    last_transition_ms = now;
+    transition_ms[next_transition] = now;
+    next_transition = (next_transition + 1) % RATE_SLOTS;
+}
+
+/* Hotplug cluster c into [min_cpus, max_cpus] online CPUs. */
+static void hotplug_cluster(int c, int min_cpus, int max_cpus)
+{
+    struct cluster_state *cl = &state[c];
+    int first = clusters[c].first_cpu;
+    int last = first + clusters[c].num_cpus - 1;
+    int cpu, online = 0;
+
+    for (cpu = first; cpu <= last; cpu++)
+        online += cpu_online(cpu);
+
+    /* Bring back what was parked first, then anything else. */
+    for (cpu = first; cpu <= last && online < max_cpus; cpu++) {
+        if ((cl->parked & (1U << cpu)) && !set_cpu_online(cpu, 1)) {
+            cl->parked &= ~(1U << cpu);
+            online++;
+        }
+    }
+    for (cpu = first; cpu <= last && online < min_cpus; cpu++) {
+        if (!cpu_online(cpu) && !set_cpu_online(cpu, 1)) {
+            cl->parked &= ~(1U << cpu);
+            online++;
+        }
+    }
+    for (cpu = last; cpu >= first && online > max_cpus; cpu--) {
+        if (cpu_online(cpu) && !set_cpu_online(cpu, 0)) {
+            cl->parked |= 1U << cpu;
+            online--;
+        }
+    }
+}
+
+static void apply_cluster(int c, int min_cpus, int max_cpus)
+{
+    char path[PATH_LEN];
+
+    if (!state[c].has_core_ctl) {
+        hotplug_cluster(c, min_cpus, max_cpus);
+        return;
+    }
+
+    /* core_ctl clamps min_cpus to max_cpus, so max goes first. */
+    core_ctl_path(c, "max_cpus", path);
+    write_int(path, max_cpus);
+    core_ctl_path(c, "min_cpus", path);
+    write_int(path, min_cpus);
+}
+
+/* "0-3,6" -> 0x4f */
+static unsigned int read_online_mask(void)
+{
+    char buf[NODE_MAX];
+    char *p, *end;
+    unsigned int mask = 0;
+    long first, last;
+    int fd, len;
+
+    fd = open(CORE_CTL_CPU_PATH "online", O_RDONLY);
+    if (fd < 0)
+        return 0;
+    len = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (len <= 0)
+        return 0;
+    buf[len] = '\0';
+
+    for (p = buf; *p; p = end) {
+        first = strtol(p, &end, 10);
+        if (end == p)
+            break;
+        last = first;
+        if (*end == '-')
+            last = strtol(end + 1, &end, 10);
+        for (; first <= last && first < 32; first++)
+            mask |= 1U << first;
+        if (*end == ',')
+            end++;
+    }
+
+    return mask;
+}
+
+/* Call with core_ctl_mutex held. */
+static void publish_stats_locked(void)
+{
+    struct power_state_core_ctl stats;
+    int c;
+
+    memset(&stats, 0, sizeof(stats));
+    stats.requests = num_requests;
+    stats.transitions = num_transitions;
+    stats.transitions_per_min = last_transition_ms ?
+            recent_transitions(last_transition_ms) : 0;
+    stats.online_mask = online_mask;
+    stats.last_transition_ms = last_transition_ms;
+    for (c = 0; c < num_clusters && c < POWER_STATE_MAX_CLUSTERS; c++) {
+        stats.min_cpus[c] = state[c].min_cpus;
+        stats.max_cpus[c] = state[c].max_cpus;
+    }
+    stats.num_clusters = c;
+
+    power_state_set_core_ctl(&stats);
+}
+
+static void update_locked(void)
+{
+    struct cluster_state *cl;
+    long long now = power_timer_now_ms(), due = 0;
+    int c, i, min_cpus, max_cpus, held_min, requested_min, changed = 0;
+
+    for (c = 0; c < num_clusters; c++) {
+        cl = &state[c];
+        min_cpus = -1;
+        max_cpus = -1;
+
+        for (i = 0; i < CORE_CTL_MAX_REQUESTS; i++) {
+            if (!requests[i].used)
+                continue;
+            if (requests[i].min_cpus[c] > min_cpus)
+                min_cpus = requests[i].min_cpus[c];
+            if (requests[i].max_cpus[c] >= 0 &&
+                    (max_cpus < 0 || requests[i].max_cpus[c] < max_cpus))
+                max_cpus = requests[i].max_cpus[c];
+        }
+
+        requested_min = min_cpus >= 0;
+        if (min_cpus < 0)
+            min_cpus = cl->base_min;
+        if (max_cpus < 0)
+            max_cpus = cl->base_max;
+        if (min_cpus > clusters[c].num_cpus)
+            min_cpus = clusters[c].num_cpus;
+        if (max_cpus > clusters[c].num_cpus)
+            max_cpus = clusters[c].num_cpus;
+
+        /* A requested min wins over a max; core_ctl's own min doesn't. */
+        if (max_cpus < min_cpus) {
+            if (requested_min)
+                max_cpus = min_cpus;
+            else
+                min_cpus = max_cpus;
+        }
+
+        /* Hold a lowered min for a while, unless a max forces it down. */
+        held_min = cl->min_cpus < max_cpus ? cl->min_cpus : max_cpus;
+        if (min_cpus < held_min) {
+            if (!cl->drop_due_ms)
+                cl->drop_due_ms = now + CORE_CTL_HYSTERESIS_MS;
+            if (now < cl->drop_due_ms) {
+                min_cpus = held_min;
+                if (!due || cl->drop_due_ms < due)
+                    due = cl->drop_due_ms;
+            } else {
+                cl->drop_due_ms = 0;
+            }
+        } else {
+            cl->drop_due_ms = 0;
+        }
+
+        if (min_cpus == cl->min_cpus && max_cpus == cl->max_cpus)
+            continue;
+
+        apply_cluster(c, min_cpus, max_cpus);
+        ALOGI("core_ctl: cluster%d min %d -> %d, max %d -> %d", c,
+                cl->min_cpus, min_cpus, cl->max_cpus, max_cpus);
+        cl->min_cpus = min_cpus;
+        cl->max_cpus = max_cpus;
+        changed = 1;
+    }
+
+    if (changed) {
+        count_transition(now);
+        online_mask = read_online_mask();
+        ALOGI("core_ctl: online %#x, %d transitions in the last minute",
+                online_mask, recent_transitions(now));
+    }
+
+    publish_stats_locked();
+
+    if (due)
+        power_timer_arm(&hysteresis_timer, due - now);
+}
+
+static void request_expired(void *data)
+{
+    struct request *req = data;
+
+    pthread_mutex_lock(&core_ctl_mutex);
+    /* It may have been re-armed or released since it fired. */
+    if (req->used && req->timed && !power_timer_pending(&req->timer)) {
+        req->used = 0;
+        update_locked();
+    }
+    pthread_mutex_unlock(&core_ctl_mutex);
+}
+
+static void hysteresis_expired(__attribute__((unused)) void *data)
+{
+    pthread_mutex_lock(&core_ctl_mutex);
+    update_locked();
+    pthread_mutex_unlock(&core_ctl_mutex);
+}
+
+static struct request *find_request_locked(int id)
+{
+    int i;
+
+    for (i = 0; i < CORE_CTL_MAX_REQUESTS; i++) {
+        if (requests[i].used && requests[i].id == id)
+            return &requests[i];
+    }
+
+    return NULL;
+}
+
+/*
+ * Apply the core-count opcodes in 'resources' under 'id', replacing
+ * any earlier request with that id. A duration of 0 holds it until
+ * core_ctl_release(). Returns 1 if the request was taken, 0 if it had
+ * nothing for this manager.
+ */
+int core_ctl_request(int id, const int resources[], int num_resources,
+        int duration_ms)
+{
+    struct request req, *slot;
+    int c, i, any = 0, taken = 0;
+
+    pthread_mutex_lock(&core_ctl_mutex);
+
+    if (num_clusters < 0)
+        init_locked();
+    if (num_clusters <= 0)
+        goto out;
+
+    memset(&req, 0, sizeof(req));
+    for (c = 0; c < CORE_CTL_MAX_CLUSTERS; c++) {
+        req.min_cpus[c] = -1;
+        req.max_cpus[c] = -1;
+    }
+    for (i = 0; i < num_resources; i++)
+        decode(resources[i], &req);
+    for (c = 0; c < num_clusters; c++)
+        any |= req.min_cpus[c] >= 0 || req.max_cpus[c] >= 0;
+
+    slot = find_request_locked(id);
+    if (!any) {
+        /* A new vector under the same id drops the old limits. */
+        if (slot) {
+            slot->used = 0;
+            update_locked();
+        }
+        goto out;
+    }
+
+    for (i = 0; !slot && i < CORE_CTL_MAX_REQUESTS; i++) {
+        if (!requests[i].used)
+            slot = &requests[i];
+    }
+    if (!slot) {
+        ALOGE("core_ctl: all %d request slots in use", CORE_CTL_MAX_REQUESTS);
+        goto out;
+    }
+
+    memcpy(slot->min_cpus, req.min_cpus, sizeof(req.min_cpus));
+    memcpy(slot->max_cpus, req.max_cpus, sizeof(req.max_cpus));
+    slot->id = id;
+    slot->used = 1;
+    slot->timed = duration_ms > 0;
+    if (slot->timed)
+        power_timer_arm(&slot->timer, duration_ms);
+    else
+        power_timer_cancel(&slot->timer);
+
+    num_requests++;
+    update_locked();
+    taken = 1;
+
+out:
+    pthread_mutex_unlock(&core_ctl_mutex);
+    return taken;
+}
+
+void core_ctl_release(int id)
+{
+    struct request *req;
+
+    pthread_mutex_lock(&core_ctl_mutex);
+
+    req = num_clusters > 0 ? find_request_locked(id) : NULL;
+    if (req) {
+        power_timer_cancel(&req->timer);
+        req->used = 0;
+        update_locked();
+    }
+
+    pthread_mutex_unlock(&core_ctl_mutex);
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef _QCOM_CORE_CTL_H
+#define _QCOM_CORE_CTL_H
+
+/* Overridable so the manager can be pointed at a fake tree. */
+#ifndef CORE_CTL_CPU_PATH
+#define CORE_CTL_CPU_PATH           "/sys/devices/system/cpu/"
+#endif
+
+#define CORE_CTL_MAX_CLUSTERS       (2)
+#define CORE_CTL_MAX_REQUESTS       (16)
+#define CORE_CTL_MAX_CPUS           (8)
+
+/* Lowering a cluster's min_cpus waits this long, so boosts don't thrash. */
+#define CORE_CTL_HYSTERESIS_MS      (200)
+
+struct core_ctl_cluster {
+    int first_cpu;
+    int num_cpus;
+};
+
+int core_ctl_request(int id, const int resources[], int num_resources,
+        int duration_ms);
+void core_ctl_release(int id);
+
+int get_core_ctl_clusters(const struct core_ctl_cluster **clusters);
+
+#endif
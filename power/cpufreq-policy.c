@@ -0,0 +1,368 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Hotplug-aware cpufreq writer.
+ *
+ * Writes address the policy a CPU belongs to rather than the CPU: the
+ * write goes through whichever member of the policy is online, and the
+ * value is remembered for every member. An offline CPU has no cpufreq
+ * directory, and the kernel resets the policy when the CPU comes back,
+ * so a listener on the kernel uevent socket replays the remembered
+ * values each time a CPU is brought online.
+ */
+
+#define LOG_NIDEBUG 0
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+
+#define LOG_TAG "QCOM PowerHAL"
+#include <utils/Log.h>
+
+#include "utils.h"
+#include "power-common.h"
+#include "power-state.h"
+#include "cpufreq-policy.h"
+
+#define CPUFREQ_CPU_PATH        "/sys/devices/system/cpu/cpu%d/cpufreq/"
+#define CPU_ONLINE_UEVENT       "online@/devices/system/cpu/cpu"
+
+#define PATH_LEN                (128)
+#define NODE_NAME_MAX           (32)
+#define UEVENT_MSG_LEN          (1024)
+#define UEVENT_RCVBUF           (64 * 1024)
+
+/* Internal to write_node(): the CPU has no cpufreq directory. */
+#define NODE_OFFLINE            (-2)
+
+struct policy_node {
+    char name[NODE_NAME_MAX];
+    char value[NODE_MAX];
+};
+
+struct cpu_state {
+    /* CPUs sharing this CPU's policy, itself included */
+    unsigned int related;
+    int num_nodes;
+    struct policy_node nodes[CPUFREQ_POLICY_MAX_NODES];
+};
+
+static pthread_once_t policy_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t policy_mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct cpu_state cpus[CPUFREQ_MAX_CPUS];
+static struct power_state_cpufreq policy_stats;
+static int uevent_fd = -1;
+/* Bumped whenever the governor may have changed under a reader's cache */
+static unsigned int generation;
+
+static int read_value(const char *path, char *value, int size)
+{
+    int fd, len;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return -1;
+    len = read(fd, value, size - 1);
+    close(fd);
+    if (len < 0)
+        return -1;
+
+    while (len > 0 && (value[len - 1] == '\n' || value[len - 1] == ' '))
+        len--;
+    value[len] = '\0';
+
+    return 0;
+}
+
+/* related_cpus lists offline members too, e.g. "0 1 2 3". */
+static void read_related_locked(int cpu)
+{
+    char path[PATH_LEN];
+    char value[NODE_MAX];
+    char *p, *end;
+    unsigned int related = 0;
+    long member;
+
+    snprintf(path, sizeof(path), CPUFREQ_CPU_PATH "related_cpus", cpu);
+    if (read_value(path, value, sizeof(value)))
+        return;
+
+    for (p = value; *p; p = end) {
+        member = strtol(p, &end, 10);
+        if (end == p)
+            break;
+        if (member >= 0 && member < CPUFREQ_MAX_CPUS)
+            related |= 1U << member;
+    }
+
+    if (related & (1U << cpu))
+        cpus[cpu].related = related;
+}
+
+static int node_matches(const char *path, const char *value)
+{
+    char current[NODE_MAX];
+    char *end;
+    long v;
+
+    if (read_value(path, current, sizeof(current)))
+        return 0;
+
+    v = strtol(value, &end, 10);
+    if (end != value && *end == '\0')
+        return strtol(current, NULL, 10) == v;
+
+    return strcmp(current, value) == 0;
+}
+
+static int write_node(int cpu, const char *name, const char *value)
+{
+    char path[PATH_LEN];
+
+    snprintf(path, sizeof(path), CPUFREQ_CPU_PATH "%s", cpu, name);
+
+    if (access(path, F_OK))
+        return NODE_OFFLINE;
+
+    if (node_matches(path, value))
+        return CPUFREQ_POLICY_UNCHANGED;
+
+    if (sysfs_write(path, (char *)value))
+        return CPUFREQ_POLICY_ERROR;
+
+    return CPUFREQ_POLICY_WRITTEN;
+}
+
+static void remember_locked(int cpu, const char *name, const char *value)
+{
+    struct cpu_state *state = &cpus[cpu];
+    struct policy_node *node;
+    int i;
+
+    for (i = 0; i < state->num_nodes; i++) {
+        if (!strcmp(state->nodes[i].name, name))
+            break;
+    }
+
+    if (i == CPUFREQ_POLICY_MAX_NODES) {
+        ALOGW("cpu%d: not remembering %s, all %d slots in use",
+                cpu, name, CPUFREQ_POLICY_MAX_NODES);
+        return;
+    }
+
+    node = &state->nodes[i];
+    if (i == state->num_nodes) {
+        snprintf(node->name, sizeof(node->name), "%s", name);
+        state->num_nodes++;
+    }
+    snprintf(node->value, sizeof(node->value), "%s", value);
+}
+
+static void *uevent_thread(__attribute__((unused)) void *arg)
+{
+    char msg[UEVENT_MSG_LEN + 1];
+    struct sockaddr_nl addr;
+    socklen_t addr_len;
+    ssize_t len;
+    char *end;
+    long cpu;
+
+    for (;;) {
+        addr_len = sizeof(addr);
+        len = recvfrom(uevent_fd, msg, UEVENT_MSG_LEN, 0,
+                (struct sockaddr *)&addr, &addr_len);
+        if (len < 0) {
+            /* Overruns lose events, not the socket. */
+            if (errno == EINTR || errno == ENOBUFS)
+                continue;
+            ALOGE("uevent socket failed: %s", strerror(errno));
+            break;
+        }
+
+        /* Only the kernel sends on this socket with a pid of 0. */
+        if (addr.nl_pid != 0)
+            continue;
+
+        /* The first string is the "action@devpath" header. */
+        msg[len] = '\0';
+        if (strncmp(msg, CPU_ONLINE_UEVENT, strlen(CPU_ONLINE_UEVENT)))
+            continue;
+
+        cpu = strtol(msg + strlen(CPU_ONLINE_UEVENT), &end, 10);
+        if (end == msg + strlen(CPU_ONLINE_UEVENT) || *end != '\0')
+            continue;
+
+        cpufreq_policy_replay(cpu);
+    }
+
+    close(uevent_fd);
+    uevent_fd = -1;
+    return NULL;
+}
+
+static void uevent_thread_start(void)
+{
+    struct sockaddr_nl addr;
+    pthread_attr_t attr;
+    pthread_t thread;
+    int rcvbuf = UEVENT_RCVBUF;
+
+    uevent_fd = socket(PF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC,
+            NETLINK_KOBJECT_UEVENT);
+    if (uevent_fd < 0) {
+        ALOGE("Failed to open uevent socket: %s", strerror(errno));
+        return;
+    }
+
+    setsockopt(uevent_fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+    memset(&addr, 0, sizeof(addr));
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = 1;
+    if (bind(uevent_fd, (struct sockaddr *)&addr, sizeof(addr))) {
+        ALOGE("Failed to bind uevent socket: %s", strerror(errno));
+        goto fail;
+    }
+
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    if (pthread_create(&thread, &attr, uevent_thread, NULL)) {
+        ALOGE("Failed to start uevent thread.");
+        pthread_attr_destroy(&attr);
+        goto fail;
+    }
+    pthread_attr_destroy(&attr);
+    return;
+
+fail:
+    close(uevent_fd);
+    uevent_fd = -1;
+}
+
+static void policy_init(void)
+{
+    int cpu;
+
+    for (cpu = 0; cpu < CPUFREQ_MAX_CPUS; cpu++) {
+        cpus[cpu].related = 1U << cpu;
+        read_related_locked(cpu);
+    }
+
+    uevent_thread_start();
+}
+
+/*
+ * Set 'name' under the cpufreq directory of cpu's policy. Returns
+ * CPUFREQ_POLICY_DEFERRED if every member of the policy is offline;
+ * the value is written when one of them comes back.
+ */
+int cpufreq_policy_write(int cpu, const char *name, const char *value)
+{
+    unsigned int related;
+    int member, rc;
+
+    if (cpu < 0 || cpu >= CPUFREQ_MAX_CPUS)
+        return CPUFREQ_POLICY_ERROR;
+
+    pthread_once(&policy_once, policy_init);
+
+    pthread_mutex_lock(&policy_mutex);
+
+    related = cpus[cpu].related;
+    for (member = 0; member < CPUFREQ_MAX_CPUS; member++) {
+        if (related & (1U << member))
+            remember_locked(member, name, value);
+    }
+
+    /* Try the CPU asked for first, then the rest of its policy. */
+    rc = write_node(cpu, name, value);
+    for (member = 0; rc == NODE_OFFLINE && member < CPUFREQ_MAX_CPUS;
+            member++) {
+        if (member != cpu && (related & (1U << member)))
+            rc = write_node(member, name, value);
+    }
+
+    if (rc == NODE_OFFLINE) {
+        rc = CPUFREQ_POLICY_DEFERRED;
+        policy_stats.deferred++;
+        power_state_set_cpufreq(&policy_stats);
+    } else if (rc == CPUFREQ_POLICY_WRITTEN) {
+        policy_stats.writes++;
+        power_state_set_cpufreq(&policy_stats);
+        if (strcmp(name, "scaling_governor") == 0)
+            __atomic_add_fetch(&generation, 1, __ATOMIC_RELEASE);
+    }
+
+    pthread_mutex_unlock(&policy_mutex);
+
+    return rc;
+}
+
+/* Rewrite everything remembered for 'cpu'; called when it comes online. */
+void cpufreq_policy_replay(int cpu)
+{
+    struct cpu_state *state;
+    int i, rc, replayed = 0, failed = 0;
+
+    if (cpu < 0 || cpu >= CPUFREQ_MAX_CPUS)
+        return;
+
+    pthread_mutex_lock(&policy_mutex);
+
+    state = &cpus[cpu];
+    read_related_locked(cpu);
+
+    /* In the order they were first set, so the governor goes first. */
+    for (i = 0; i < state->num_nodes; i++) {
+        rc = write_node(cpu, state->nodes[i].name, state->nodes[i].value);
+        if (rc == CPUFREQ_POLICY_WRITTEN)
+            replayed++;
+        else if (rc != CPUFREQ_POLICY_UNCHANGED)
+            failed++;
+    }
+
+    policy_stats.replays += replayed;
+    policy_stats.replay_failures += failed;
+    if (replayed || failed)
+        power_state_set_cpufreq(&policy_stats);
+
+    /* The kernel reset the policy, whether or not we had it replayed. */
+    __atomic_add_fetch(&generation, 1, __ATOMIC_RELEASE);
+
+    pthread_mutex_unlock(&policy_mutex);
+
+    if (replayed || failed)
+        ALOGI("cpu%d online: replayed %d cpufreq nodes, %d failed",
+                cpu, replayed, failed);
+}
+
+/*
+ * Changes whenever a write through here or a CPU coming online may have
+ * changed a scaling governor. Governor changes made behind our back are
+ * not seen; cache readers need a timeout for those.
+ */
+unsigned int cpufreq_policy_generation(void)
+{
+    return __atomic_load_n(&generation, __ATOMIC_ACQUIRE);
+}
@@ -0,0 +1,37 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _QCOM_CPUFREQ_POLICY_H
+#define _QCOM_CPUFREQ_POLICY_H
+
+#define CPUFREQ_MAX_CPUS                (8)
+/* Distinct nodes remembered per CPU for replay */
+#define CPUFREQ_POLICY_MAX_NODES        (4)
+
+enum cpufreq_policy_result {
+    CPUFREQ_POLICY_ERROR = -1,
+    CPUFREQ_POLICY_WRITTEN = 0,
+    /* Already held the value */
+    CPUFREQ_POLICY_UNCHANGED,
+    /* No CPU of the policy is online; applied when one comes up */
+    CPUFREQ_POLICY_DEFERRED,
+};
+
+int cpufreq_policy_write(int cpu, const char *node, const char *value);
+void cpufreq_policy_replay(int cpu);
+unsigned int cpufreq_policy_generation(void);
+
+#endif
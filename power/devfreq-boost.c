@@ -0,0 +1,258 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * GPU and memory bus floors for boosts.
+ *
+ * App launch on Adreno parts is often bound by the GPU and DDR clocks
+ * rather than the CPUs. Targets list the kgsl and cpubw/mincpubw
+ * devfreq devices to raise and the min_freq each vote type wants.
+ * Votes are timed or held until unvoted. Timed votes of a type share
+ * one power_timer running to the latest deadline asked for; held votes
+ * are refcounted per type. The strongest active type decides what is
+ * written. The min_freq each node had before the first vote is put
+ * back when the last one goes away. Devices that aren't present on
+ * this kernel are skipped.
+ */
+
+#define LOG_NIDEBUG 0
+
+#include <ctype.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+#define LOG_TAG "QCOM PowerHAL"
+#include <utils/Log.h>
+
+#include "utils.h"
+#include "power-common.h"
+#include "power-timer.h"
+#include "devfreq-boost.h"
+
+#define PATH_LEN                (128)
+
+struct vote_state {
+    /* Untimed votes not yet unvoted */
+    int holds;
+    struct power_timer timer;
+};
+
+static pthread_mutex_t devfreq_mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct vote_state votes[DEVFREQ_VOTE_COUNT];
+
+static const struct devfreq_boost_node *nodes;
+static int num_nodes = -1;
+static char paths[DEVFREQ_BOOST_MAX_NODES][PATH_LEN];
+static char saved[DEVFREQ_BOOST_MAX_NODES][NODE_MAX];
+static char current[DEVFREQ_BOOST_MAX_NODES][NODE_MAX];
+static int boosted;
+
+int __attribute__ ((weak)) get_devfreq_boost_nodes(
+        __attribute__((unused)) const struct devfreq_boost_node **nodes)
+{
+    return 0;
+}
+
+/* "fdb00000.qcom,kgsl-3d0" -> "kgsl-3d0", "qcom,cpubw.42" -> "cpubw" */
+static int device_matches(const char *name, const char *device)
+{
+    const char *start, *end, *p;
+
+    end = name + strlen(name);
+    start = strrchr(name, '.');
+    if (start && start[1]) {
+        for (p = start + 1; *p && isdigit((unsigned char)*p); p++)
+            ;
+        if (!*p)
+            end = start;
+    }
+
+    start = name;
+    for (p = name; p < end; p++) {
+        if (*p == ',')
+            start = p + 1;
+    }
+
+    return (size_t)(end - start) == strlen(device) &&
+            !strncmp(start, device, end - start);
+}
+
+static void resolve_nodes_locked(void)
+{
+    struct dirent *entry;
+    DIR *dir;
+    int i, found = 0;
+
+    num_nodes = get_devfreq_boost_nodes(&nodes);
+    if (num_nodes > DEVFREQ_BOOST_MAX_NODES)
+        num_nodes = DEVFREQ_BOOST_MAX_NODES;
+    if (num_nodes <= 0)
+        return;
+
+    dir = opendir(DEVFREQ_CLASS_PATH);
+    if (!dir) {
+        ALOGI("devfreq: no %s, boosts are CPU only", DEVFREQ_CLASS_PATH);
+        return;
+    }
+
+    while ((entry = readdir(dir))) {
+        for (i = 0; i < num_nodes; i++) {
+            if (!paths[i][0] && device_matches(entry->d_name, nodes[i].device)) {
+                snprintf(paths[i], PATH_LEN, DEVFREQ_CLASS_PATH "%s/min_freq",
+                        entry->d_name);
+                found++;
+            }
+        }
+    }
+    closedir(dir);
+
+    ALOGI("devfreq: %d of %d boost devices found", found, num_nodes);
+}
+
+static int vote_active(int type)
+{
+    return votes[type].holds > 0 || power_timer_pending(&votes[type].timer);
+}
+
+static void save_locked(void)
+{
+    int i, len;
+
+    for (i = 0; i < num_nodes; i++) {
+        saved[i][0] = '\0';
+        current[i][0] = '\0';
+        if (!paths[i][0])
+            continue;
+
+        if (sysfs_read(paths[i], saved[i], NODE_MAX) == -1) {
+            saved[i][0] = '\0';
+            continue;
+        }
+
+        len = strlen(saved[i]);
+        while (len > 0 && saved[i][len - 1] == '\n')
+            saved[i][--len] = '\0';
+        snprintf(current[i], NODE_MAX, "%s", saved[i]);
+    }
+}
+
+/* Write what the strongest active vote asks for, or the saved value. */
+static void update_locked(void)
+{
+    const char *value;
+    int i, type, any = 0;
+
+    for (type = 0; type < DEVFREQ_VOTE_COUNT; type++)
+        any |= vote_active(type);
+
+    if (any && !boosted) {
+        save_locked();
+        boosted = 1;
+    }
+
+    if (!boosted)
+        return;
+
+    for (i = 0; i < num_nodes; i++) {
+        if (!saved[i][0])
+            continue;
+
+        value = saved[i];
+        for (type = DEVFREQ_VOTE_COUNT - 1; any && type >= 0; type--) {
+            if (vote_active(type) && nodes[i].min_freq[type]) {
+                value = nodes[i].min_freq[type];
+                break;
+            }
+        }
+
+        if (!strcmp(current[i], value))
+            continue;
+
+        if (sysfs_write(paths[i], (char *)value) == 0)
+            snprintf(current[i], NODE_MAX, "%s", value);
+    }
+
+    if (!any)
+        boosted = 0;
+}
+
+static void vote_expired(__attribute__((unused)) void *data)
+{
+    pthread_mutex_lock(&devfreq_mutex);
+    update_locked();
+    pthread_mutex_unlock(&devfreq_mutex);
+}
+
+/*
+ * Raise the floors for 'type' for duration_ms. A running timed vote of
+ * the same type keeps the later of the two deadlines. A duration of 0
+ * holds the vote until devfreq_boost_unvote(). Returns 1 if a floor is
+ * raised.
+ */
+int devfreq_boost_vote(int type, int duration_ms)
+{
+    int i, ret;
+
+    if (type < 0 || type >= DEVFREQ_VOTE_COUNT || duration_ms < 0)
+        return 0;
+
+    pthread_mutex_lock(&devfreq_mutex);
+
+    if (num_nodes < 0) {
+        for (i = 0; i < DEVFREQ_VOTE_COUNT; i++)
+            power_timer_init(&votes[i].timer, vote_expired, NULL);
+        resolve_nodes_locked();
+    }
+
+    if (num_nodes <= 0)
+        goto out;
+
+    if (duration_ms > 0) {
+        if (power_timer_extend(&votes[type].timer, duration_ms))
+            goto out;
+    } else {
+        votes[type].holds++;
+    }
+
+    update_locked();
+
+out:
+    ret = num_nodes > 0 && boosted;
+    pthread_mutex_unlock(&devfreq_mutex);
+
+    return ret;
+}
+
+void devfreq_boost_unvote(int type)
+{
+    if (type < 0 || type >= DEVFREQ_VOTE_COUNT)
+        return;
+
+    pthread_mutex_lock(&devfreq_mutex);
+
+    if (votes[type].holds == 0) {
+        ALOGW("Unbalanced devfreq unvote of type %d", type);
+        goto out;
+    }
+
+    votes[type].holds--;
+    update_locked();
+
+out:
+    pthread_mutex_unlock(&devfreq_mutex);
+}
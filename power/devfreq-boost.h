@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _QCOM_DEVFREQ_BOOST_H
+#define _QCOM_DEVFREQ_BOOST_H
+
+/* Overridable so the votes can be pointed at a fake tree. */
+#ifndef DEVFREQ_CLASS_PATH
+#define DEVFREQ_CLASS_PATH      "/sys/class/devfreq/"
+#endif
+
+#define DEVFREQ_BOOST_MAX_NODES     (4)
+
+/* Weakest first: the strongest active vote decides each node's value. */
+enum devfreq_vote_type {
+    DEVFREQ_VOTE_INTERACTION = 0,
+    DEVFREQ_VOTE_LAUNCH,
+    DEVFREQ_VOTE_COUNT
+};
+
+/*
+ * A devfreq device whose min_freq is raised while boosted. 'device' is
+ * matched against the names under DEVFREQ_CLASS_PATH with any
+ * "<address>." or "qcom," prefix and ".<n>" suffix ignored, so
+ * "cpubw" finds "qcom,cpubw.42" and "kgsl-3d0" finds
+ * "fdb00000.qcom,kgsl-3d0". Units are the device's own: Hz for kgsl,
+ * MBps for the bus monitors.
+ */
+struct devfreq_boost_node {
+    const char *device;
+    /* min_freq held for each vote type, NULL to leave it alone */
+    const char *min_freq[DEVFREQ_VOTE_COUNT];
+};
+
+int devfreq_boost_vote(int type, int duration_ms);
+void devfreq_boost_unvote(int type);
+
+int get_devfreq_boost_nodes(const struct devfreq_boost_node **nodes);
+
+#endif
@@ -0,0 +1,410 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Governor tunable registry.
+ *
+ * Each governor's tunables are described once below. Which of them the
+ * running kernel exposes, and where, is discovered from sysfs: either
+ * the global directory or, with governor_per_policy, one directory per
+ * cpufreq policy. A governor's directory only appears while it is in
+ * use, so governors that aren't found at init are looked for again on
+ * their first apply.
+ *
+ * Profiles are applied through the supported subset only, and nodes
+ * that already hold the requested value are not rewritten.
+ */
+
+#define LOG_NIDEBUG 0
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define LOG_TAG "QCOM PowerHAL"
+#include <utils/Log.h>
+
+#include "utils.h"
+#include "power-common.h"
+#include "governor-tunables.h"
+#include "cpufreq-policy.h"
+
+#define GOVERNOR_MAX_POLICIES   (8)
+#define TUNABLE_PATH_MAX        (128)
+#define TUNABLE_VALUE_MAX       (128)
+
+#define CPUFREQ_CPU_PATH        "/sys/devices/system/cpu/cpu%d/cpufreq/"
+
+#define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
+
+static const struct governor_tunable interactive_tunables[] = {
+    { "above_hispeed_delay",        TUNABLE_STR,     0, 0 },
+    { "align_windows",              TUNABLE_INT,     0, 1 },
+    { "boost",                      TUNABLE_INT,     0, 1 },
+    { "boostpulse",                 TUNABLE_TRIGGER, 0, 0 },
+    { "boostpulse_duration",        TUNABLE_INT,     0, 5000000 },
+    { "go_hispeed_load",            TUNABLE_INT,     1, 100 },
+    { "hispeed_freq",               TUNABLE_INT,     0, 4000000 },
+    { "io_is_busy",                 TUNABLE_INT,     0, 1 },
+    { "max_freq_hysteresis",        TUNABLE_INT,     0, 5000000 },
+    { "min_sample_time",            TUNABLE_INT,     0, 5000000 },
+    { "target_loads",               TUNABLE_STR,     0, 0 },
+    { "timer_rate",                 TUNABLE_INT,     1000, 5000000 },
+    { "timer_slack",                TUNABLE_INT,     -1, 5000000 },
+};
+
+static const struct governor_tunable ondemand_tunables[] = {
+    { "down_differential",          TUNABLE_INT,     0, 100 },
+    { "down_differential_multi_core", TUNABLE_INT,   0, 100 },
+    { "enable_turbo_mode",          TUNABLE_INT,     0, 1 },
+    { "freq_step",                  TUNABLE_INT,     0, 100 },
+    { "ignore_nice_load",           TUNABLE_INT,     0, 1 },
+    { "input_boost",                TUNABLE_INT,     0, 4000000 },
+    { "io_is_busy",                 TUNABLE_INT,     0, 1 },
+    { "optimal_freq",               TUNABLE_INT,     0, 4000000 },
+    { "powersave_bias",             TUNABLE_INT,     0, 1000 },
+    { "sampling_down_factor",       TUNABLE_INT,     1, 100000 },
+    { "sampling_early_factor",      TUNABLE_INT,     1, 100000 },
+    { "sampling_interim_factor",    TUNABLE_INT,     1, 100000 },
+    { "sampling_rate",              TUNABLE_INT,     1000, 5000000 },
+    { "sampling_rate_min",          TUNABLE_INT,     1000, 5000000 },
+    { "step_up_early_hispeed",      TUNABLE_INT,     0, 4000000 },
+    { "step_up_interim_hispeed",    TUNABLE_INT,     0, 4000000 },
+    { "sync_freq",                  TUNABLE_INT,     0, 4000000 },
+    { "up_threshold",               TUNABLE_INT,     1, 100 },
+    { "up_threshold_any_cpu_load",  TUNABLE_INT,     1, 100 },
+    { "up_threshold_multi_core",    TUNABLE_INT,     1, 100 },
+};
+
+static const struct governor_tunable schedutil_tunables[] = {
+    { "rate_limit_us",              TUNABLE_INT,     0, 1000000 },
+    { "up_rate_limit_us",           TUNABLE_INT,     0, 1000000 },
+    { "down_rate_limit_us",         TUNABLE_INT,     0, 1000000 },
+    { "hispeed_load",               TUNABLE_INT,     1, 100 },
+    { "hispeed_freq",               TUNABLE_INT,     0, 4000000 },
+};
+
+static const struct {
+    const char *governor;
+    const char *path;
+    const struct governor_tunable *tunables;
+    int num_tunables;
+} schemas[] = {
+    { INTERACTIVE_GOVERNOR, INTERACTIVE_PATH,
+        interactive_tunables, ARRAY_SIZE(interactive_tunables) },
+    { ONDEMAND_GOVERNOR, ONDEMAND_PATH,
+        ondemand_tunables, ARRAY_SIZE(ondemand_tunables) },
+    { SCHEDUTIL_GOVERNOR, SCHEDUTIL_PATH,
+        schedutil_tunables, ARRAY_SIZE(schedutil_tunables) },
+};
+
+/* Discovery results, parallel to schemas[]. */
+static struct {
+    int discovered;
+    int num_dirs;
+    char dirs[GOVERNOR_MAX_POLICIES][TUNABLE_PATH_MAX];
+    /* Bit n set if tunables[n] exists in every directory */
+    unsigned long long supported;
+} state[ARRAY_SIZE(schemas)];
+
+static pthread_mutex_t registry_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static int find_schema(const char *governor)
+{
+    unsigned int i;
+
+    for (i = 0; i < ARRAY_SIZE(schemas); i++) {
+        if (strcmp(schemas[i].governor, governor) == 0)
+            return i;
+    }
+
+    return -1;
+}
+
+static int find_tunable(int schema, const char *name)
+{
+    int i;
+
+    for (i = 0; i < schemas[schema].num_tunables; i++) {
+        if (strcmp(schemas[schema].tunables[i].name, name) == 0)
+            return i;
+    }
+
+    return -1;
+}
+
+static int add_dir(int schema, const char *dir, struct stat seen[])
+{
+    struct stat st;
+    int i;
+
+    if (stat(dir, &st) || !S_ISDIR(st.st_mode))
+        return 0;
+
+    /* CPUs of one policy share a directory; only write it once. */
+    for (i = 0; i < state[schema].num_dirs; i++) {
+        if (seen[i].st_dev == st.st_dev && seen[i].st_ino == st.st_ino)
+            return 0;
+    }
+
+    seen[state[schema].num_dirs] = st;
+    snprintf(state[schema].dirs[state[schema].num_dirs++], TUNABLE_PATH_MAX,
+            "%s", dir);
+
+    return 1;
+}
+
+/* Called with registry_mutex held. */
+static void discover_locked(int schema)
+{
+    struct stat seen[GOVERNOR_MAX_POLICIES];
+    char path[TUNABLE_PATH_MAX];
+    int cpu, i, d;
+
+    state[schema].num_dirs = 0;
+    state[schema].supported = 0;
+
+    if (!add_dir(schema, schemas[schema].path, seen)) {
+        for (cpu = 0; cpu < GOVERNOR_MAX_POLICIES; cpu++) {
+            snprintf(path, sizeof(path), CPUFREQ_CPU_PATH "%s/", cpu,
+                    schemas[schema].governor);
+            add_dir(schema, path, seen);
+        }
+    }
+
+    if (!state[schema].num_dirs)
+        return;
+
+    for (i = 0; i < schemas[schema].num_tunables; i++) {
+        for (d = 0; d < state[schema].num_dirs; d++) {
+            snprintf(path, sizeof(path), "%s%s", state[schema].dirs[d],
+                    schemas[schema].tunables[i].name);
+            if (access(path, F_OK))
+                break;
+        }
+        if (d == state[schema].num_dirs)
+            state[schema].supported |= 1ULL << i;
+    }
+
+    state[schema].discovered = 1;
+
+    ALOGI("%s: %d of %d tunables in %d director%s", schemas[schema].governor,
+            __builtin_popcountll(state[schema].supported),
+            schemas[schema].num_tunables, state[schema].num_dirs,
+            state[schema].num_dirs == 1 ? "y" : "ies");
+}
+
+void governor_tunables_init(void)
+{
+    unsigned int i;
+
+    pthread_mutex_lock(&registry_mutex);
+    for (i = 0; i < ARRAY_SIZE(schemas); i++)
+        discover_locked(i);
+    pthread_mutex_unlock(&registry_mutex);
+}
+
+/* Not sysfs_read(): write-only and missing nodes aren't errors here. */
+static int read_value(const char *path, char *value, int size)
+{
+    int fd, len;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return -1;
+    len = read(fd, value, size - 1);
+    close(fd);
+    if (len < 0)
+        return -1;
+
+    while (len > 0 && (value[len - 1] == '\n' || value[len - 1] == ' '))
+        len--;
+    value[len] = '\0';
+
+    return 0;
+}
+
+static int value_matches(const char *path, int type, const char *value)
+{
+    char current[TUNABLE_VALUE_MAX];
+
+    if (type == TUNABLE_TRIGGER)
+        return 0;
+
+    if (read_value(path, current, sizeof(current)))
+        return 0;
+
+    if (type == TUNABLE_INT)
+        return strtol(current, NULL, 0) == strtol(value, NULL, 0);
+
+    return strcmp(current, value) == 0;
+}
+
+static void write_if_changed(const char *path, int type, const char *value,
+        struct tunable_apply_stats *stats)
+{
+    if (value_matches(path, type, value)) {
+        stats->skipped++;
+        return;
+    }
+
+    if (sysfs_write((char *)path, (char *)value) == 0)
+        stats->written++;
+}
+
+static int value_in_range(const struct governor_tunable *tunable,
+        const char *value)
+{
+    char *end;
+    long v;
+
+    if (tunable->type != TUNABLE_INT)
+        return 1;
+
+    errno = 0;
+    v = strtol(value, &end, 0);
+    if (errno || end == value || *end != '\0')
+        return 0;
+
+    return v >= tunable->min && v <= tunable->max;
+}
+
+int governor_tunable_supported(const char *governor, const char *name)
+{
+    int schema = find_schema(governor);
+    int tunable, ret = 0;
+
+    if (schema < 0)
+        return 0;
+
+    pthread_mutex_lock(&registry_mutex);
+    if (!state[schema].discovered)
+        discover_locked(schema);
+    tunable = find_tunable(schema, name);
+    if (tunable >= 0)
+        ret = !!(state[schema].supported & (1ULL << tunable));
+    pthread_mutex_unlock(&registry_mutex);
+
+    return ret;
+}
+
+/*
+ * Read the current value of a supported tunable from the governor's
+ * first directory. Returns -1 if it isn't exposed.
+ */
+int governor_read_tunable(const char *governor, const char *name,
+        char *value, int size)
+{
+    char path[TUNABLE_PATH_MAX];
+    int schema = find_schema(governor);
+    int tunable, ret = -1;
+
+    if (schema < 0)
+        return -1;
+
+    pthread_mutex_lock(&registry_mutex);
+    if (!state[schema].discovered)
+        discover_locked(schema);
+    tunable = find_tunable(schema, name);
+    if (tunable >= 0 && (state[schema].supported & (1ULL << tunable))) {
+        snprintf(path, sizeof(path), "%s%s", state[schema].dirs[0], name);
+        ret = read_value(path, value, size);
+    }
+    pthread_mutex_unlock(&registry_mutex);
+
+    return ret;
+}
+
+/*
+ * Apply 'settings' to every directory of 'governor', which should be
+ * the running governor. Counts are added to 'stats'.
+ */
+void governor_apply_tunables(const char *governor,
+        const struct tunable_setting *settings, int num_settings,
+        struct tunable_apply_stats *stats)
+{
+    const struct governor_tunable *tunable;
+    char path[TUNABLE_PATH_MAX];
+    int schema = find_schema(governor);
+    int i, t, d;
+
+    if (schema < 0) {
+        ALOGE("No tunable schema for governor %s", governor);
+        stats->invalid += num_settings;
+        return;
+    }
+
+    pthread_mutex_lock(&registry_mutex);
+
+    if (!state[schema].discovered)
+        discover_locked(schema);
+
+    for (i = 0; i < num_settings; i++) {
+        t = find_tunable(schema, settings[i].name);
+        if (t < 0) {
+            ALOGE("%s: unknown tunable %s", governor, settings[i].name);
+            stats->invalid++;
+            continue;
+        }
+
+        tunable = &schemas[schema].tunables[t];
+        if (!value_in_range(tunable, settings[i].value)) {
+            ALOGE("%s: %s out of range: %s", governor, tunable->name,
+                    settings[i].value);
+            stats->invalid++;
+            continue;
+        }
+
+        if (!(state[schema].supported & (1ULL << t))) {
+            stats->unsupported++;
+            continue;
+        }
+
+        for (d = 0; d < state[schema].num_dirs; d++) {
+            snprintf(path, sizeof(path), "%s%s", state[schema].dirs[d],
+                    tunable->name);
+            write_if_changed(path, tunable->type, settings[i].value, stats);
+        }
+    }
+
+    pthread_mutex_unlock(&registry_mutex);
+}
+
+/*
+ * Per-policy cpufreq nodes such as scaling_governor and scaling_max_freq,
+ * addressed by any CPU of the policy. Values for offline policies are
+ * applied when a CPU of theirs comes online.
+ */
+void cpufreq_apply_setting(int cpu, const char *node, const char *value,
+        struct tunable_apply_stats *stats)
+{
+    switch (cpufreq_policy_write(cpu, node, value)) {
+    case CPUFREQ_POLICY_WRITTEN:
+        stats->written++;
+        break;
+    case CPUFREQ_POLICY_UNCHANGED:
+        stats->skipped++;
+        break;
+    case CPUFREQ_POLICY_DEFERRED:
+        stats->deferred++;
+        break;
+    }
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _QCOM_GOVERNOR_TUNABLES_H
+#define _QCOM_GOVERNOR_TUNABLES_H
+
+enum governor_tunable_type {
+    TUNABLE_INT = 0,
+    /* Free-form, e.g. "85 1350000:90" for target_loads */
+    TUNABLE_STR,
+    /* Write-only trigger such as boostpulse; always written */
+    TUNABLE_TRIGGER,
+};
+
+struct governor_tunable {
+    const char *name;
+    int type;
+    /* Accepted range, TUNABLE_INT only */
+    long min;
+    long max;
+};
+
+/* One value of a profile, by tunable name. */
+struct tunable_setting {
+    const char *name;
+    const char *value;
+};
+
+struct tunable_apply_stats {
+    int written;
+    /* Already at the requested value */
+    int skipped;
+    /* Not exposed by this kernel */
+    int unsupported;
+    /* Unknown to the schema or out of range */
+    int invalid;
+    /* CPU offline; written when it comes back */
+    int deferred;
+};
+
+void governor_tunables_init(void);
+int governor_tunable_supported(const char *governor, const char *name);
+int governor_read_tunable(const char *governor, const char *name,
+        char *value, int size);
+void governor_apply_tunables(const char *governor,
+        const struct tunable_setting *settings, int num_settings,
+        struct tunable_apply_stats *stats);
+void cpufreq_apply_setting(int cpu, const char *node, const char *value,
+        struct tunable_apply_stats *stats);
+
+#endif
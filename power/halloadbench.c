@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * halloadbench: HAL load-to-first-hint latency.
+ *
+ *   halloadbench [-r runs]
+ *
+ * Each run forks a fresh process that loads the power HAL, opens it and
+ * sends a video encode hint under a hint id of its own, timing from
+ * before the load until the hint returns. Runs alternate between the
+ * HAL as built, which loads the vendor perf library on a thread of its
+ * own, and the same HAL with the library loaded up front the way its
+ * constructor used to, with property_get() and dlopen(RTLD_NOW). The
+ * median of each is printed. The HAL it loads takes perflocks and
+ * writes the state page shared with the system's instance.
+ */
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <cutils/properties.h>
+#include <hardware/hardware.h>
+#include <hardware/power.h>
+
+#define DEFAULT_RUNS        (5)
+#define MAX_RUNS            (32)
+
+/* Well clear of the ids the HAL and the media stack use */
+#define BENCH_HINT_ID       (0x7eb1)
+
+static long long now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/* What the HAL constructor did before the loader thread. */
+static void load_perf_lib(void)
+{
+    char path[PROPERTY_VALUE_MAX];
+    void *handle;
+
+    if (!property_get("ro.vendor.extension_library", path, NULL))
+        return;
+
+    handle = dlopen(path, RTLD_NOW);
+    if (!handle)
+        return;
+
+    dlsym(handle, "perf_lock_acq");
+    dlsym(handle, "perf_lock_rel");
+    dlsym(handle, "perf_lock_use_profile");
+}
+
+/* Runs in the child; returns the latency in us, or -1. */
+static long long run_once(int blocking)
+{
+    char acquire[64], release[64];
+    power_module_t *module;
+    long long start, latency;
+
+    snprintf(acquire, sizeof(acquire), "state=1;hint_id=%d", BENCH_HINT_ID);
+    snprintf(release, sizeof(release), "state=0;hint_id=%d", BENCH_HINT_ID);
+
+    start = now_us();
+
+    if (blocking)
+        load_perf_lib();
+
+    if (hw_get_module(POWER_HARDWARE_MODULE_ID,
+                (const hw_module_t **)&module))
+        return -1;
+    if (module->init)
+        module->init(module);
+    module->powerHint(module, POWER_HINT_VIDEO_ENCODE, acquire);
+
+    latency = now_us() - start;
+
+    module->powerHint(module, POWER_HINT_VIDEO_ENCODE, release);
+
+    return latency;
+}
+
+static long long fork_run(int blocking)
+{
+    long long latency = -1;
+    int fds[2], status;
+    pid_t pid;
+
+    if (pipe(fds))
+        return -1;
+
+    pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return -1;
+    }
+
+    if (pid == 0) {
+        close(fds[0]);
+        latency = run_once(blocking);
+        if (write(fds[1], &latency, sizeof(latency)) != sizeof(latency))
+            _exit(1);
+        _exit(0);
+    }
+
+    close(fds[1]);
+    if (read(fds[0], &latency, sizeof(latency)) != sizeof(latency))
+        latency = -1;
+    close(fds[0]);
+    waitpid(pid, &status, 0);
+
+    return latency;
+}
+
+static int compare_ll(const void *a, const void *b)
+{
+    long long x = *(const long long *)a, y = *(const long long *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+int main(int argc, char *argv[])
+{
+    long long times[2][MAX_RUNS];
+    int runs = DEFAULT_RUNS;
+    int opt, r, blocking;
+
+    while ((opt = getopt(argc, argv, "r:")) != -1) {
+        switch (opt) {
+        case 'r':
+            runs = atoi(optarg);
+            break;
+        default:
+            goto usage;
+        }
+    }
+
+    if (optind != argc || runs < 1 || runs > MAX_RUNS)
+        goto usage;
+
+    for (r = 0; r < runs; r++) {
+        for (blocking = 0; blocking < 2; blocking++) {
+            times[blocking][r] = fork_run(blocking);
+            if (times[blocking][r] < 0) {
+                fprintf(stderr, "run failed; can the power HAL be loaded?\n");
+                return 1;
+            }
+        }
+    }
+
+    for (blocking = 0; blocking < 2; blocking++)
+        qsort(times[blocking], runs, sizeof(times[blocking][0]), compare_ll);
+
+    printf("load to first hint, median of %d runs\n", runs);
+    printf("  loader thread: %lld.%03lld ms\n", times[0][runs / 2] / 1000,
+            times[0][runs / 2] % 1000);
+    printf("  blocking load: %lld.%03lld ms\n", times[1][runs / 2] / 1000,
+            times[1][runs / 2] % 1000);
+
+    return 0;
+
+usage:
+    fprintf(stderr, "usage: %s [-r runs]\n", argv[0]);
+    return 2;
+}
@@ -34,10 +34,32 @@
 #define DISPLAY_STATE_HINT_ID_2         (0x0D00)
 #define DEFAULT_AUDIO_HINT_ID           (0x0E00)
 #define DEFAULT_PROFILE_HINT_ID         (0x0F00)
+#define DEFAULT_LOW_POWER_HINT_ID       (0x1000)
+#define ONDEMAND_IO_BUSY_VOTE_HINT_ID   (0x1100)
+#define ONDEMAND_SDF_VOTE_HINT_ID       (0x1200)
+#define BOOT_BOOST_HINT_ID              (0x1300)
+/* Keys the timed interaction/launch boost where it isn't a perflock */
+#define INTERACTION_BOOST_HINT_ID       (0x1400)
 
 struct hint_data {
     unsigned long hint_id; /* This is our key. */
     unsigned long perflock_handle;
+    int *resources;
+    int num_resources;
+    long long expiry_ms; /* 0 if the hint is never reaped */
+    int owner_pid; /* Client to watch, 0 if none */
+    unsigned long long owner_start;
+};
+
+/* How often to check that the clients holding hints are alive */
+#define HINT_CLIENT_POLL_MS             (5000)
+
+#define HINT_REAPER_MAX_STATS           (16)
+
+struct hint_reaper_stats {
+    int hint_id;
+    unsigned long renewals;
+    unsigned long reaped;
 };
 
 int hint_compare(struct hint_data *first_hint,
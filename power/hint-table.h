@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _QCOM_HINT_TABLE_H
+#define _QCOM_HINT_TABLE_H
+
+/*
+ * Resource vectors for the governor-dependent hints, laid out as one
+ * dense, statically initialized table per backend:
+ *
+ *     static const hint_table_t hint_table = {
+ *         [HINT_TYPE_VIDEO_ENCODE] = {
+ *             [GOVERNOR_INTERACTIVE] = HINT_VECTOR(TR_MS_30, HS_FREQ_1026),
+ *         },
+ *     };
+ *
+ * An empty entry means the backend does nothing for that hint under
+ * that governor. State 1 acquires the vector, state 0 undoes it.
+ * Video hints are the client's, and are reaped if it dies holding one.
+ * Include power-common.h first for GOVERNOR_COUNT.
+ */
+enum hint_table_type {
+    HINT_TYPE_VIDEO_ENCODE = 0,
+    HINT_TYPE_VIDEO_DECODE,
+    HINT_TYPE_DISPLAY_OFF,
+    HINT_TYPE_COUNT
+};
+
+struct hint_vector {
+    const int *resources;
+    int num_resources;
+};
+
+typedef struct hint_vector hint_table_t[HINT_TYPE_COUNT][GOVERNOR_COUNT];
+
+#define HINT_VECTOR(...) { \
+    (const int []){ __VA_ARGS__ }, \
+    sizeof((const int []){ __VA_ARGS__ }) / sizeof(int) }
+
+const struct hint_vector *hint_table_lookup(const hint_table_t table,
+        int type, int governor);
+int hint_table_dispatch(const hint_table_t table, int type, int hint_id,
+        int state, int client_pid);
+void perform_hint_vector(int hint_id, const struct hint_vector *vector);
+
+#endif
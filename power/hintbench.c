@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * hintbench: per-hint dispatch cost of the power HAL.
+ *
+ *   hintbench [-n hints]
+ *
+ * Loads the power HAL into this process and times video encode hints
+ * taken and dropped back to back under a hint id of its own, so each
+ * pass goes through the table dispatch, including the governor lookup.
+ * For comparison it also times the uncached scaling_governor read the
+ * dispatch used to make on every hint. Medians are printed. Takes and
+ * releases perflocks, so run it with the device idle.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <hardware/hardware.h>
+#include <hardware/power.h>
+
+#include "power-common.h"
+
+#define DEFAULT_HINTS       (1000)
+#define MAX_HINTS           (100000)
+
+/* Well clear of the ids the HAL and the media stack use */
+#define BENCH_HINT_ID       (0x7eb0)
+
+static long long now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (long long)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static int read_governor(char *value, int size)
+{
+    int fd, len;
+
+    fd = open(SCALING_GOVERNOR_PATH, O_RDONLY);
+    if (fd < 0)
+        return -1;
+    len = read(fd, value, size - 1);
+    close(fd);
+    if (len < 0)
+        return -1;
+    value[len] = '\0';
+
+    return 0;
+}
+
+static int compare_ll(const void *a, const void *b)
+{
+    long long x = *(const long long *)a, y = *(const long long *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+static void print_median(const char *what, long long times[], int num)
+{
+    qsort(times, num, sizeof(times[0]), compare_ll);
+    printf("  %-14s %lld.%03lld us\n", what, times[num / 2] / 1000,
+            times[num / 2] % 1000);
+}
+
+int main(int argc, char *argv[])
+{
+    char acquire[64], release[64], governor[80];
+    long long *times[3] = { NULL, NULL, NULL };
+    long long start;
+    power_module_t *module;
+    int hints = DEFAULT_HINTS;
+    int opt, i, ret = 1;
+
+    while ((opt = getopt(argc, argv, "n:")) != -1) {
+        switch (opt) {
+        case 'n':
+            hints = atoi(optarg);
+            break;
+        default:
+            goto usage;
+        }
+    }
+
+    if (optind != argc || hints < 1 || hints > MAX_HINTS)
+        goto usage;
+
+    if (hw_get_module(POWER_HARDWARE_MODULE_ID,
+                (const hw_module_t **)&module)) {
+        fprintf(stderr, "can't load the power HAL\n");
+        return 1;
+    }
+    if (module->init)
+        module->init(module);
+
+    if (read_governor(governor, sizeof(governor))) {
+        fprintf(stderr, "%s: %s\n", SCALING_GOVERNOR_PATH, strerror(errno));
+        return 1;
+    }
+
+    for (i = 0; i < 3; i++) {
+        times[i] = calloc(hints, sizeof(long long));
+        if (!times[i]) {
+            fprintf(stderr, "out of memory\n");
+            goto out;
+        }
+    }
+
+    snprintf(acquire, sizeof(acquire), "state=1;hint_id=%d", BENCH_HINT_ID);
+    snprintf(release, sizeof(release), "state=0;hint_id=%d", BENCH_HINT_ID);
+
+    for (i = 0; i < hints; i++) {
+        start = now_ns();
+        module->powerHint(module, POWER_HINT_VIDEO_ENCODE, acquire);
+        times[0][i] = now_ns() - start;
+
+        start = now_ns();
+        module->powerHint(module, POWER_HINT_VIDEO_ENCODE, release);
+        times[1][i] = now_ns() - start;
+
+        start = now_ns();
+        read_governor(governor, sizeof(governor));
+        times[2][i] = now_ns() - start;
+    }
+
+    printf("governor: %s", governor);
+    printf("median of %d hints\n", hints);
+    print_median("acquire:", times[0], hints);
+    print_median("release:", times[1], hints);
+    print_median("governor read:", times[2], hints);
+    ret = 0;
+
+out:
+    for (i = 0; i < 3; i++)
+        free(times[i]);
+    return ret;
+
+usage:
+    fprintf(stderr, "usage: %s [-n hints]\n", argv[0]);
+    return 2;
+}
@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Storage boost for app launch.
+ *
+ * A cold launch faults in dex, oat and library pages from the boot
+ * device, and on eMMC parts it waits on I/O more than on the CPUs.
+ * For the launch window the boot device's request queue gets a larger
+ * read-ahead and more requests in flight, and the I/O scheduler stops
+ * idling for more I/O from the same queue. The original values are
+ * restored when the window ends; launches that overlap only extend it.
+ */
+
+#define LOG_NIDEBUG 0
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#define LOG_TAG "QCOM PowerHAL"
+#include <utils/Log.h>
+#include <cutils/properties.h>
+
+#include "utils.h"
+#include "power-common.h"
+#include "power-timer.h"
+#include "io-boost.h"
+
+#define PATH_LEN                (128)
+#define IO_BOOST_MAX_NODES      (8)
+
+struct io_boost_node {
+    /* Relative to the disk's queue directory */
+    const char *node;
+    const char *value;
+};
+
+static const struct io_boost_node queue_nodes[] = {
+    { "read_ahead_kb",          IO_BOOST_READ_AHEAD_KB },
+    { "nr_requests",            IO_BOOST_NR_REQUESTS },
+};
+
+/* Per scheduler; only the active scheduler's directory exists. */
+static const struct io_boost_node cfq_nodes[] = {
+    { "iosched/slice_idle",     "0" },
+    { "iosched/group_idle",     "0" },
+};
+
+static const struct io_boost_node deadline_nodes[] = {
+    { "iosched/read_expire",    "100" },
+    { "iosched/fifo_batch",     "32" },
+};
+
+static pthread_mutex_t io_boost_mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct power_timer expiry_timer;
+
+static char paths[IO_BOOST_MAX_NODES][PATH_LEN];
+static const char *values[IO_BOOST_MAX_NODES];
+static char saved[IO_BOOST_MAX_NODES][NODE_MAX];
+static int num_nodes = -1;
+static int active;
+
+static void add_nodes(const char *queue, const struct io_boost_node *nodes,
+        int count)
+{
+    int i;
+
+    for (i = 0; i < count && num_nodes < IO_BOOST_MAX_NODES; i++) {
+        if (snprintf(paths[num_nodes], PATH_LEN, "%s%s", queue,
+                    nodes[i].node) >= PATH_LEN ||
+                access(paths[num_nodes], F_OK))
+            continue;
+        values[num_nodes++] = nodes[i].value;
+    }
+}
+
+/* ro.boot.bootdevice is e.g. "624000.ufshc" or "7824900.sdhci". */
+static void resolve_nodes_locked(void)
+{
+    char bootdevice[PROPERTY_VALUE_MAX];
+    char queue[PATH_LEN];
+    char path[PATH_LEN];
+    char scheduler[NODE_MAX];
+    const char *disk = NULL;
+
+    num_nodes = 0;
+
+    if (property_get("ro.boot.bootdevice", bootdevice, "")) {
+        if (strstr(bootdevice, "ufs"))
+            disk = IO_BOOST_UFS_DISK;
+        else if (strstr(bootdevice, "sdhc"))
+            disk = IO_BOOST_SDHC_DISK;
+    }
+
+    if (!disk) {
+        ALOGI("io boost: unknown boot device '%s'", bootdevice);
+        return;
+    }
+
+    snprintf(queue, sizeof(queue), BLOCK_SYSFS_PATH "%s/queue/", disk);
+    add_nodes(queue, queue_nodes,
+            sizeof(queue_nodes)/sizeof(queue_nodes[0]));
+
+    /* e.g. "noop deadline [cfq]"; iosched/ holds the active one's. */
+    if (snprintf(path, sizeof(path), "%sscheduler", queue) <
+            (int)sizeof(path) &&
+            sysfs_read(path, scheduler, sizeof(scheduler)) == 0) {
+        if (strstr(scheduler, "[cfq]"))
+            add_nodes(queue, cfq_nodes,
+                    sizeof(cfq_nodes)/sizeof(cfq_nodes[0]));
+        else if (strstr(scheduler, "[deadline]"))
+            add_nodes(queue, deadline_nodes,
+                    sizeof(deadline_nodes)/sizeof(deadline_nodes[0]));
+    }
+
+    ALOGI("io boost: %d queue settings for %s", num_nodes, disk);
+}
+
+static void apply_locked(void)
+{
+    int i, len;
+
+    for (i = 0; i < num_nodes; i++) {
+        if (sysfs_read(paths[i], saved[i], NODE_MAX) == -1) {
+            saved[i][0] = '\0';
+            continue;
+        }
+
+        len = strlen(saved[i]);
+        while (len > 0 && saved[i][len - 1] == '\n')
+            saved[i][--len] = '\0';
+
+        if (sysfs_write(paths[i], (char *)values[i]) == -1)
+            saved[i][0] = '\0';
+    }
+}
+
+static void restore_locked(void)
+{
+    int i;
+
+    /* nr_requests and read-ahead go back last, after the scheduler. */
+    for (i = num_nodes - 1; i >= 0; i--) {
+        if (saved[i][0])
+            sysfs_write(paths[i], saved[i]);
+    }
+}
+
+static void expiry_timer_expired(__attribute__((unused)) void *data)
+{
+    pthread_mutex_lock(&io_boost_mutex);
+
+    /* A launch that came in after the timer fired has re-armed it. */
+    if (active && !power_timer_pending(&expiry_timer)) {
+        restore_locked();
+        active = 0;
+    }
+
+    pthread_mutex_unlock(&io_boost_mutex);
+}
+
+int io_boost_begin(int duration_ms)
+{
+    int ret;
+
+    if (duration_ms <= 0)
+        return 0;
+
+    pthread_mutex_lock(&io_boost_mutex);
+
+    if (num_nodes < 0) {
+        power_timer_init(&expiry_timer, expiry_timer_expired, NULL);
+        resolve_nodes_locked();
+    }
+
+    if (num_nodes == 0)
+        goto out;
+
+    if (!active) {
+        apply_locked();
+        active = 1;
+    }
+
+    if (power_timer_arm(&expiry_timer, duration_ms)) {
+        restore_locked();
+        active = 0;
+    }
+
+out:
+    ret = active;
+    pthread_mutex_unlock(&io_boost_mutex);
+
+    return ret;
+}
@@ -0,0 +1,35 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _QCOM_IO_BOOST_H
+#define _QCOM_IO_BOOST_H
+
+/* Overridable so the boost can be pointed at a fake tree. */
+#ifndef BLOCK_SYSFS_PATH
+#define BLOCK_SYSFS_PATH        "/sys/block/"
+#endif
+
+/* Boot device disks, as cryptfs_hw tells UFS from SDHC */
+#define IO_BOOST_UFS_DISK       "sda"
+#define IO_BOOST_SDHC_DISK      "mmcblk0"
+
+/* Request queue settings for the launch window */
+#define IO_BOOST_READ_AHEAD_KB  "512"
+#define IO_BOOST_NR_REQUESTS    "256"
+
+int io_boost_begin(int duration_ms);
+
+#endif
@@ -0,0 +1,312 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * ioboostbench: cold-read benchmark for the launch I/O boost.
+ *
+ *   ioboostbench [-s size_mb] [-r runs] <backing_file>
+ *
+ * Attaches <backing_file> (created if it is too small) to a free loop
+ * device and times a launch-like read pattern, scattered extents each
+ * read front to back in pages, with all caches dropped before every
+ * run. Runs alternate between the queue's own settings and the ones
+ * the HAL uses during a launch, and the median of each is printed.
+ * Needs root.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <linux/fs.h>
+#include <linux/loop.h>
+
+#include "io-boost.h"
+
+#define DEFAULT_SIZE_MB     (64)
+#define DEFAULT_RUNS        (5)
+#define MAX_RUNS            (32)
+
+#define PAGE_BYTES          (4096)
+#define NUM_EXTENTS         (256)
+#define MIN_EXTENT_PAGES    (4)
+#define MAX_EXTENT_PAGES    (64)
+
+struct queue_setting {
+    const char *node;
+    const char *boosted;
+    char saved[32];
+    int present;
+};
+
+static struct queue_setting settings[] = {
+    { "read_ahead_kb",  IO_BOOST_READ_AHEAD_KB, "", 0 },
+    { "nr_requests",    IO_BOOST_NR_REQUESTS,   "", 0 },
+};
+
+#define NUM_SETTINGS (int)(sizeof(settings)/sizeof(settings[0]))
+
+static long long now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int read_node(const char *path, char *value, int size)
+{
+    int fd, len;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return -1;
+    len = read(fd, value, size - 1);
+    close(fd);
+    if (len < 0)
+        return -1;
+
+    while (len > 0 && value[len - 1] == '\n')
+        len--;
+    value[len] = '\0';
+
+    return 0;
+}
+
+static int write_node(const char *path, const char *value)
+{
+    int fd, len;
+
+    fd = open(path, O_WRONLY);
+    if (fd < 0)
+        return -1;
+    len = write(fd, value, strlen(value));
+    close(fd);
+
+    return len < 0 ? -1 : 0;
+}
+
+static int prepare_backing_file(const char *path, long long size)
+{
+    char buf[PAGE_BYTES * 16];
+    long long written;
+    unsigned int seed = 1;
+    struct stat st;
+    int fd, i;
+
+    fd = open(path, O_RDWR | O_CREAT, 0600);
+    if (fd < 0) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    if (fstat(fd, &st) == 0 && st.st_size >= size)
+        return fd;
+
+    printf("writing %lld MB to %s\n", size >> 20, path);
+    /* Incompressible, in case the backing store compresses. */
+    for (written = 0; written < size; written += sizeof(buf)) {
+        for (i = 0; i < (int)sizeof(buf); i++)
+            buf[i] = rand_r(&seed);
+        if (write(fd, buf, sizeof(buf)) != (ssize_t)sizeof(buf)) {
+            fprintf(stderr, "%s: %s\n", path, strerror(errno));
+            close(fd);
+            return -1;
+        }
+    }
+    fsync(fd);
+
+    return fd;
+}
+
+static int attach_loop(int backing_fd, char *loop_path, int size, int *loop_num)
+{
+    int ctl, fd, n;
+
+    ctl = open("/dev/loop-control", O_RDWR);
+    if (ctl < 0) {
+        fprintf(stderr, "/dev/loop-control: %s\n", strerror(errno));
+        return -1;
+    }
+    n = ioctl(ctl, LOOP_CTL_GET_FREE);
+    close(ctl);
+    if (n < 0) {
+        fprintf(stderr, "no free loop device: %s\n", strerror(errno));
+        return -1;
+    }
+
+    snprintf(loop_path, size, "/dev/block/loop%d", n);
+    if (access(loop_path, F_OK))
+        snprintf(loop_path, size, "/dev/loop%d", n);
+
+    fd = open(loop_path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "%s: %s\n", loop_path, strerror(errno));
+        return -1;
+    }
+
+    if (ioctl(fd, LOOP_SET_FD, backing_fd)) {
+        fprintf(stderr, "LOOP_SET_FD: %s\n", strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    *loop_num = n;
+    return fd;
+}
+
+static void drop_caches(int loop_fd)
+{
+    sync();
+    ioctl(loop_fd, BLKFLSBUF, 0);
+    if (write_node("/proc/sys/vm/drop_caches", "3"))
+        fprintf(stderr, "drop_caches: %s\n", strerror(errno));
+}
+
+static void apply_settings(int loop_num, int boosted)
+{
+    char path[128];
+    int i;
+
+    for (i = 0; i < NUM_SETTINGS; i++) {
+        if (!settings[i].present)
+            continue;
+        snprintf(path, sizeof(path), "/sys/block/loop%d/queue/%s",
+                loop_num, settings[i].node);
+        write_node(path, boosted ? settings[i].boosted : settings[i].saved);
+    }
+}
+
+/* Same extents every run, so both settings read identical data. */
+static long long run_workload(int loop_fd, long long size)
+{
+    char buf[PAGE_BYTES];
+    long long start, pages = size / PAGE_BYTES;
+    unsigned int seed = 42;
+    off_t offset;
+    int e, p, len;
+
+    start = now_us();
+    for (e = 0; e < NUM_EXTENTS; e++) {
+        len = MIN_EXTENT_PAGES +
+                rand_r(&seed) % (MAX_EXTENT_PAGES - MIN_EXTENT_PAGES + 1);
+        offset = (off_t)(rand_r(&seed) % (pages - len)) * PAGE_BYTES;
+        for (p = 0; p < len; p++) {
+            if (pread(loop_fd, buf, sizeof(buf),
+                        offset + (off_t)p * PAGE_BYTES) < 0)
+                return -1;
+        }
+    }
+
+    return now_us() - start;
+}
+
+static int compare_ll(const void *a, const void *b)
+{
+    long long x = *(const long long *)a, y = *(const long long *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+int main(int argc, char *argv[])
+{
+    long long times[2][MAX_RUNS];
+    long long size = (long long)DEFAULT_SIZE_MB << 20;
+    char loop_path[64];
+    char path[128];
+    int runs = DEFAULT_RUNS;
+    int backing_fd, loop_fd, loop_num;
+    int opt, i, r, boosted, ret = 0;
+
+    while ((opt = getopt(argc, argv, "s:r:")) != -1) {
+        switch (opt) {
+        case 's':
+            size = atoll(optarg) << 20;
+            break;
+        case 'r':
+            runs = atoi(optarg);
+            break;
+        default:
+            goto usage;
+        }
+    }
+
+    if (optind != argc - 1 || size < MAX_EXTENT_PAGES * PAGE_BYTES * 2 ||
+            runs < 1 || runs > MAX_RUNS)
+        goto usage;
+
+    backing_fd = prepare_backing_file(argv[optind], size);
+    if (backing_fd < 0)
+        return 1;
+
+    loop_fd = attach_loop(backing_fd, loop_path, sizeof(loop_path), &loop_num);
+    if (loop_fd < 0) {
+        close(backing_fd);
+        return 1;
+    }
+
+    for (i = 0; i < NUM_SETTINGS; i++) {
+        snprintf(path, sizeof(path), "/sys/block/loop%d/queue/%s",
+                loop_num, settings[i].node);
+        settings[i].present = !read_node(path, settings[i].saved,
+                sizeof(settings[i].saved));
+        printf("%s: %s -> %s%s\n", settings[i].node,
+                settings[i].present ? settings[i].saved : "-",
+                settings[i].boosted,
+                settings[i].present ? "" : " (not on this queue)");
+    }
+
+    for (r = 0; r < runs; r++) {
+        for (boosted = 0; boosted < 2; boosted++) {
+            apply_settings(loop_num, boosted);
+            drop_caches(loop_fd);
+            times[boosted][r] = run_workload(loop_fd, size);
+            if (times[boosted][r] < 0) {
+                fprintf(stderr, "read failed: %s\n", strerror(errno));
+                ret = 1;
+                goto out;
+            }
+        }
+    }
+
+    for (boosted = 0; boosted < 2; boosted++)
+        qsort(times[boosted], runs, sizeof(times[boosted][0]), compare_ll);
+
+    printf("%s, %d extents, median of %d cold runs\n", loop_path,
+            NUM_EXTENTS, runs);
+    printf("  default: %lld.%03lld ms\n", times[0][runs / 2] / 1000,
+            times[0][runs / 2] % 1000);
+    printf("  boosted: %lld.%03lld ms\n", times[1][runs / 2] / 1000,
+            times[1][runs / 2] % 1000);
+
+out:
+    apply_settings(loop_num, 0);
+    ioctl(loop_fd, LOOP_CLR_FD, 0);
+    close(loop_fd);
+    close(backing_fd);
+    return ret;
+
+usage:
+    fprintf(stderr, "usage: %s [-s size_mb] [-r runs] <backing_file>\n",
+            argv[0]);
+    return 2;
+}
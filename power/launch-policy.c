@@ -0,0 +1,481 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * Per-package launch boost policy.
+ *
+ * Every launch used to get the backend's one vector for a fixed two
+ * seconds, which is too short for a game loading its assets and far
+ * too long for a calculator. Packages can be given a vector class and
+ * a duration, or have the boost skipped, by the backend (through
+ * get_launch_policies()) and by LAUNCH_POLICY_PATH, whose lines win:
+ *
+ *   # package                  class    [duration_ms]
+ *   com.android.calculator2    light    300
+ *   com.example.game           heavy
+ *   com.example.widgethost     skip
+ *
+ * Packages without a duration use what their last launches took: the
+ * launching process is sampled until it goes quiet, and the time is
+ * kept in a small LRU. Everything else gets the backend's duration.
+ *
+ * Classes and durations only matter to the paths that consult them:
+ * backends that boost launches through launch_boost() (8916, 8952, 8974
+ * and 8994), and schedutil, which takes the duration alone. Elsewhere a
+ * launch hint does nothing but skip still applies.
+ *
+ * All tables are static; loading and lookup never allocate, so a
+ * launch hint costs a hash and a few string compares.
+ */
+
+#define LOG_NIDEBUG 0
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <hardware/power.h>
+
+#define LOG_TAG "QCOM PowerHAL"
+#include <utils/Log.h>
+
+#include "power-state.h"
+#include "power-timer.h"
+#include "launch-policy.h"
+
+#define LAUNCH_POLICY_FILE_MAX      (8192)
+/* Open addressing, kept at most half full */
+#define LAUNCH_POLICY_SLOTS         (256)
+
+/* Launch tracking: a launch is over once the process goes quiet */
+#define LAUNCH_SAMPLE_MS            (100)
+#define LAUNCH_QUIET_PCT            (25)
+
+struct policy_entry {
+    unsigned int hash;
+    char package[LAUNCH_PACKAGE_MAX];
+    int launch_class;
+    int duration_ms;
+};
+
+struct learned_entry {
+    unsigned int hash;
+    char package[LAUNCH_PACKAGE_MAX];
+    int duration_ms;
+    unsigned long stamp;
+};
+
+struct launch_tracker {
+    pid_t pid;
+    unsigned int hash;
+    char package[LAUNCH_PACKAGE_MAX];
+    long long start_ms;
+    long long sample_ms;
+    long long busy_ms;
+    unsigned long ticks;
+    struct power_timer timer;
+};
+
+static const char *class_names[LAUNCH_CLASS_COUNT] = {
+    [LAUNCH_CLASS_DEFAULT]  = "default",
+    [LAUNCH_CLASS_LIGHT]    = "light",
+    [LAUNCH_CLASS_HEAVY]    = "heavy",
+    [LAUNCH_CLASS_SKIP]     = "skip",
+};
+
+/* Written by launch_policy_init() only */
+static struct policy_entry policies[LAUNCH_POLICY_MAX];
+static unsigned char policy_slots[LAUNCH_POLICY_SLOTS];
+static int num_policies;
+static char file_buf[LAUNCH_POLICY_FILE_MAX];
+static long clock_ticks;
+
+/* The launch being boosted; hints are serialized by the caller */
+static int current_class = LAUNCH_CLASS_DEFAULT;
+static int current_duration;
+
+static pthread_mutex_t launch_mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct learned_entry learned[LAUNCH_LEARNED_MAX];
+static unsigned long learned_clock;
+static struct launch_tracker tracker;
+static struct launch_policy_stats launch_stats;
+
+int __attribute__ ((weak)) get_launch_policies(
+        __attribute__((unused)) const struct launch_policy **policies)
+{
+    return 0;
+}
+
+int __attribute__ ((weak)) get_launch_boost_resources(
+        __attribute__((unused)) int launch_class,
+        __attribute__((unused)) int **resources)
+{
+    return 0;
+}
+
+/* FNV-1a */
+static unsigned int hash_package(const char *package)
+{
+    unsigned int hash = 2166136261u;
+
+    while (*package) {
+        hash ^= (unsigned char)*package++;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+static struct policy_entry *find_policy(unsigned int hash, const char *package)
+{
+    unsigned int slot;
+    struct policy_entry *entry;
+
+    for (slot = hash; policy_slots[slot % LAUNCH_POLICY_SLOTS];
+            slot++) {
+        entry = &policies[policy_slots[slot % LAUNCH_POLICY_SLOTS] - 1];
+        if (entry->hash == hash && !strcmp(entry->package, package))
+            return entry;
+    }
+
+    return NULL;
+}
+
+static void add_policy(const char *package, int launch_class, int duration_ms)
+{
+    struct policy_entry *entry;
+    unsigned int hash, slot;
+
+    if (strlen(package) >= LAUNCH_PACKAGE_MAX) {
+        ALOGW("launch policy: package name too long: %s", package);
+        return;
+    }
+
+    hash = hash_package(package);
+    entry = find_policy(hash, package);
+    if (!entry) {
+        if (num_policies == LAUNCH_POLICY_MAX) {
+            ALOGW("launch policy: table full, dropping %s", package);
+            return;
+        }
+
+        entry = &policies[num_policies++];
+        entry->hash = hash;
+        snprintf(entry->package, LAUNCH_PACKAGE_MAX, "%s", package);
+
+        for (slot = hash; policy_slots[slot % LAUNCH_POLICY_SLOTS]; slot++)
+            ;
+        policy_slots[slot % LAUNCH_POLICY_SLOTS] = num_policies;
+    }
+
+    entry->launch_class = launch_class;
+    entry->duration_ms = duration_ms;
+}
+
+static int parse_class(const char *name)
+{
+    int i;
+
+    for (i = 0; i < LAUNCH_CLASS_COUNT; i++) {
+        if (!strcmp(name, class_names[i]))
+            return i;
+    }
+
+    return -1;
+}
+
+static void load_policy_file(void)
+{
+    char *line, *package, *name, *duration, *save_line, *save_field;
+    int fd, len, launch_class, line_num = 0;
+
+    fd = open(LAUNCH_POLICY_PATH, O_RDONLY);
+    if (fd < 0)
+        return;
+    len = read(fd, file_buf, sizeof(file_buf) - 1);
+    close(fd);
+    if (len < 0)
+        return;
+    file_buf[len] = '\0';
+
+    if (len == (int)sizeof(file_buf) - 1)
+        ALOGW("launch policy: %s truncated at %d bytes", LAUNCH_POLICY_PATH,
+                len);
+
+    for (line = strtok_r(file_buf, "\n", &save_line); line;
+            line = strtok_r(NULL, "\n", &save_line)) {
+        line_num++;
+        package = strtok_r(line, " \t\r", &save_field);
+        if (!package || package[0] == '#')
+            continue;
+
+        name = strtok_r(NULL, " \t\r", &save_field);
+        duration = strtok_r(NULL, " \t\r", &save_field);
+        launch_class = name ? parse_class(name) : -1;
+        if (launch_class < 0) {
+            ALOGW("launch policy: %s:%d: bad class", LAUNCH_POLICY_PATH,
+                    line_num);
+            continue;
+        }
+
+        add_policy(package, launch_class, duration ? atoi(duration) : 0);
+    }
+}
+
+void launch_policy_init(void)
+{
+    const struct launch_policy *table;
+    int i, num;
+
+    clock_ticks = sysconf(_SC_CLK_TCK);
+
+    num = get_launch_policies(&table);
+    for (i = 0; i < num; i++)
+        add_policy(table[i].package, table[i].launch_class,
+                table[i].duration_ms);
+
+    load_policy_file();
+
+    ALOGI("launch policy: %d packages", num_policies);
+}
+
+/* utime + stime of 'pid', or -1 once it is gone */
+static int read_cpu_ticks(pid_t pid, unsigned long *ticks)
+{
+    char path[32];
+    char stat[512];
+    unsigned long utime, stime;
+    char *p;
+    int fd, len;
+
+    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return -1;
+    len = read(fd, stat, sizeof(stat) - 1);
+    close(fd);
+    if (len <= 0)
+        return -1;
+    stat[len] = '\0';
+
+    /* The command name may hold spaces; fields resume after its ')'. */
+    p = strrchr(stat, ')');
+    if (!p || sscanf(p + 1, " %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u "
+            "%lu %lu", &utime, &stime) != 2)
+        return -1;
+
+    *ticks = utime + stime;
+    return 0;
+}
+
+static struct learned_entry *find_learned_locked(unsigned int hash,
+        const char *package)
+{
+    int i;
+
+    for (i = 0; i < LAUNCH_LEARNED_MAX; i++) {
+        if (learned[i].stamp && learned[i].hash == hash &&
+                !strcmp(learned[i].package, package))
+            return &learned[i];
+    }
+
+    return NULL;
+}
+
+/* Call with launch_mutex held. */
+static void publish_stats_locked(void)
+{
+    struct power_state_launch stats = {
+        .lookups = launch_stats.lookups,
+        .table_hits = launch_stats.table_hits,
+        .learned_hits = launch_stats.learned_hits,
+        .skipped = launch_stats.skipped,
+        .learned = launch_stats.learned,
+        .evictions = launch_stats.evictions,
+    };
+
+    power_state_set_launch(&stats);
+}
+
+static void learn_locked(int duration_ms)
+{
+    struct learned_entry *entry;
+    int i;
+
+    if (duration_ms < LAUNCH_LEARN_MIN_MS)
+        duration_ms = LAUNCH_LEARN_MIN_MS;
+
+    entry = find_learned_locked(tracker.hash, tracker.package);
+    if (entry) {
+        entry->duration_ms = (3 * entry->duration_ms + duration_ms) / 4;
+    } else {
+        /* A free slot has a stamp of 0, so it goes before any eviction. */
+        entry = &learned[0];
+        for (i = 1; i < LAUNCH_LEARNED_MAX; i++) {
+            if (learned[i].stamp < entry->stamp)
+                entry = &learned[i];
+        }
+        if (entry->stamp)
+            launch_stats.evictions++;
+
+        entry->hash = tracker.hash;
+        snprintf(entry->package, LAUNCH_PACKAGE_MAX, "%s", tracker.package);
+        entry->duration_ms = duration_ms;
+    }
+
+    entry->stamp = ++learned_clock;
+    launch_stats.learned++;
+    publish_stats_locked();
+
+    ALOGD("launch policy: %s took %d ms, now %d ms", tracker.package,
+            duration_ms, entry->duration_ms);
+}
+
+static void sample_launch(__attribute__((unused)) void *data)
+{
+    unsigned long ticks;
+    long long now, busy_pct;
+
+    pthread_mutex_lock(&launch_mutex);
+
+    /* Replaced by a newer launch, or its process died */
+    if (!tracker.pid)
+        goto out;
+    if (read_cpu_ticks(tracker.pid, &ticks)) {
+        tracker.pid = 0;
+        goto out;
+    }
+
+    now = power_timer_now_ms();
+    busy_pct = now > tracker.sample_ms ?
+            (long long)(ticks - tracker.ticks) * 1000 / clock_ticks * 100 /
+            (now - tracker.sample_ms) : 100;
+    if (busy_pct >= LAUNCH_QUIET_PCT)
+        tracker.busy_ms = now;
+    tracker.ticks = ticks;
+    tracker.sample_ms = now;
+
+    if (now - tracker.start_ms >= LAUNCH_LEARN_MAX_MS) {
+        learn_locked(LAUNCH_LEARN_MAX_MS);
+        tracker.pid = 0;
+    } else if (busy_pct < LAUNCH_QUIET_PCT &&
+            now - tracker.start_ms >= LAUNCH_LEARN_MIN_MS) {
+        learn_locked(tracker.busy_ms - tracker.start_ms);
+        tracker.pid = 0;
+    } else {
+        power_timer_arm(&tracker.timer, LAUNCH_SAMPLE_MS);
+    }
+
+out:
+    pthread_mutex_unlock(&launch_mutex);
+}
+
+/* Call with launch_mutex held; an older launch is abandoned. */
+static void track_launch_locked(pid_t pid, unsigned int hash,
+        const char *package)
+{
+    static int timer_ready;
+
+    if (!timer_ready) {
+        power_timer_init(&tracker.timer, sample_launch, NULL);
+        timer_ready = 1;
+    }
+
+    tracker.pid = 0;
+    if (pid <= 0 || clock_ticks <= 0 || read_cpu_ticks(pid, &tracker.ticks))
+        return;
+
+    tracker.pid = pid;
+    tracker.hash = hash;
+    snprintf(tracker.package, LAUNCH_PACKAGE_MAX, "%s", package);
+    tracker.start_ms = power_timer_now_ms();
+    tracker.sample_ms = tracker.start_ms;
+    tracker.busy_ms = tracker.start_ms;
+    power_timer_arm(&tracker.timer, LAUNCH_SAMPLE_MS);
+}
+
+/*
+ * Look up the policy for the launch in 'data', a launch_boost_info_t
+ * (or NULL), and remember it for the boost that follows. Returns the
+ * launch class; LAUNCH_CLASS_SKIP means no boost should be taken.
+ */
+int launch_policy_begin(void *data)
+{
+    launch_boost_info_t *info = data;
+    struct policy_entry *policy = NULL;
+    struct learned_entry *entry;
+    unsigned int hash;
+
+    current_class = LAUNCH_CLASS_DEFAULT;
+    current_duration = 0;
+
+    if (!info || !info->packageName ||
+            strlen(info->packageName) >= LAUNCH_PACKAGE_MAX)
+        return current_class;
+
+    hash = hash_package(info->packageName);
+    policy = find_policy(hash, info->packageName);
+    if (policy) {
+        current_class = policy->launch_class;
+        current_duration = policy->duration_ms;
+    }
+
+    pthread_mutex_lock(&launch_mutex);
+
+    launch_stats.lookups++;
+    if (policy)
+        launch_stats.table_hits++;
+
+    if (current_class == LAUNCH_CLASS_SKIP) {
+        launch_stats.skipped++;
+        tracker.pid = 0;
+        goto out;
+    }
+
+    entry = find_learned_locked(hash, info->packageName);
+    if (entry) {
+        entry->stamp = ++learned_clock;
+        if (current_duration <= 0) {
+            current_duration = entry->duration_ms * 5 / 4;
+            launch_stats.learned_hits++;
+        }
+    }
+
+    track_launch_locked(info->pid, hash, info->packageName);
+
+out:
+    publish_stats_locked();
+    pthread_mutex_unlock(&launch_mutex);
+
+    if (current_duration > LAUNCH_LEARN_MAX_MS)
+        current_duration = LAUNCH_LEARN_MAX_MS;
+
+    return current_class;
+}
+
+int launch_policy_class(void)
+{
+    return current_class;
+}
+
+/* The duration for the current launch; duration_ms if there's no policy. */
+int launch_policy_duration(int duration_ms)
+{
+    return current_duration > 0 ? current_duration : duration_ms;
+}
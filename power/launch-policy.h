@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef _QCOM_LAUNCH_POLICY_H
+#define _QCOM_LAUNCH_POLICY_H
+
+/* Optional "<package> <class> [duration_ms]" lines, see launch-policy.c */
+#define LAUNCH_POLICY_PATH          "/system/etc/power-launch-policy.conf"
+
+#define LAUNCH_POLICY_MAX           (128)
+#define LAUNCH_PACKAGE_MAX          (96)
+#define LAUNCH_LEARNED_MAX          (32)
+
+/* Bounds for learned durations */
+#define LAUNCH_LEARN_MIN_MS         (200)
+#define LAUNCH_LEARN_MAX_MS         (5000)
+
+enum launch_class {
+    /* The backend's own launch vector */
+    LAUNCH_CLASS_DEFAULT = 0,
+    LAUNCH_CLASS_LIGHT,
+    LAUNCH_CLASS_HEAVY,
+    /* No launch boost at all */
+    LAUNCH_CLASS_SKIP,
+    LAUNCH_CLASS_COUNT
+};
+
+struct launch_policy {
+    const char *package;
+    int launch_class;
+    /* 0 to use the learned duration, or the backend's */
+    int duration_ms;
+};
+
+struct launch_policy_stats {
+    unsigned long lookups;
+    /* Launches matched in the table, and with a learned duration */
+    unsigned long table_hits;
+    unsigned long learned_hits;
+    unsigned long skipped;
+    /* Launches timed, and learned entries evicted for room */
+    unsigned long learned;
+    unsigned long evictions;
+};
+
+void launch_policy_init(void);
+int launch_policy_begin(void *data);
+int launch_policy_class(void);
+int launch_policy_duration(int duration_ms);
+
+int get_launch_policies(const struct launch_policy **policies);
+int get_launch_boost_resources(int launch_class, int **resources);
+
+#endif
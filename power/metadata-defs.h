@@ -36,14 +36,17 @@
 
 #define MIN(x,y) (((x)>(y))?(y):(x))
 
+/* pid is the client holding the hint, 0 if it didn't say */
 struct video_encode_metadata_t {
     int hint_id;
     int state;
+    int pid;
 };
 
 struct video_decode_metadata_t {
     int hint_id;
     int state;
+    int pid;
 };
 
 struct audio_metadata_t {
@@ -90,6 +90,13 @@ int parse_video_encode_metadata(char *metadata,
             }
         }
 
+        if (strlen(attribute) == strlen("pid") &&
+            (strncmp(attribute, "pid", strlen("pid")) == 0)) {
+            if (strlen(value) > 0) {
+                video_encode_metadata->pid = atoi(value);
+            }
+        }
+
         temp_metadata = NULL;
     }
 
@@ -122,6 +129,13 @@ int parse_video_decode_metadata(char *metadata,
             }
         }
 
+        if (strlen(attribute) == strlen("pid") &&
+            (strncmp(attribute, "pid", strlen("pid")) == 0)) {
+            if (strlen(value) > 0) {
+                video_decode_metadata->pid = atoi(value);
+            }
+        }
+
         temp_metadata = NULL;
     }
 
@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Perflock health monitor.
+ *
+ * Handles returned by perf_lock_acq() only live as long as the perf
+ * daemon does. If it restarts, the indefinite locks are silently
+ * gone: the hint list (display off, profiles, video sessions), the
+ * vendor power profile, sustained performance caps and the vsync boost.
+ * Probe the daemon's pid periodically, and whenever a release fails; on
+ * a pid change, have each owner take its locks again. A daemon that
+ * was not running when the monitor started and turns up after locks
+ * were granted counts as a restart too.
+ */
+
+#define LOG_NIDEBUG 0
+
+#include <ctype.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define LOG_TAG "QCOM PowerHAL"
+#include <utils/Log.h>
+
+#include "utils.h"
+#include "power-state.h"
+#include "power-timer.h"
+#include "sustained-perf.h"
+#include "vsync-boost.h"
+#include "perflock-monitor.h"
+
+static pthread_mutex_t monitor_mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct power_timer probe_timer;
+static int started;
+static int daemon_pid;
+/* Set by the first perflock granted; read without monitor_mutex */
+static int locks_granted;
+
+static struct perflock_monitor_stats stats;
+
+static int is_daemon(int pid)
+{
+    char path[32];
+    char comm[32];
+    int fd, len;
+
+    /* Not sysfs_read(): processes exit under us and that isn't an error. */
+    snprintf(path, sizeof(path), "/proc/%d/comm", pid);
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return 0;
+    len = read(fd, comm, sizeof(comm) - 1);
+    close(fd);
+    if (len <= 0)
+        return 0;
+
+    comm[len] = '\0';
+    if (comm[len - 1] == '\n')
+        comm[len - 1] = '\0';
+
+    return strcmp(comm, PERFLOCK_DAEMON_NAME) == 0;
+}
+
+/* Returns the daemon's pid, or 0 if it isn't running. */
+static int find_daemon(void)
+{
+    struct dirent *entry;
+    DIR *dir;
+    int pid = 0;
+
+    /* Almost always still the same process; skip the /proc walk. */
+    if (daemon_pid && is_daemon(daemon_pid))
+        return daemon_pid;
+
+    dir = opendir("/proc");
+    if (!dir)
+        return 0;
+
+    while ((entry = readdir(dir))) {
+        if (!isdigit(entry->d_name[0]))
+            continue;
+        if (is_daemon(atoi(entry->d_name))) {
+            pid = atoi(entry->d_name);
+            break;
+        }
+    }
+    closedir(dir);
+
+    return pid;
+}
+
+/* Call with monitor_mutex held. */
+static void publish_stats_locked(void)
+{
+    struct power_state_perflock state = {
+        .daemon_pid = daemon_pid,
+        .probes = stats.probes,
+        .restarts = stats.restarts,
+        .failed_releases = stats.failed_releases,
+        .recoveries = stats.recoveries,
+        .locks_reacquired = stats.locks_reacquired,
+    };
+
+    power_state_set_perflock(&state);
+}
+
+/*
+ * Called with monitor_mutex held. A failed release while the daemon
+ * can't be identified is treated as a restart as well.
+ */
+static void probe_locked(int release_failed)
+{
+    int pid = find_daemon();
+    int restarted = 0;
+
+    stats.probes++;
+
+    if (pid && daemon_pid && pid != daemon_pid) {
+        ALOGW("%s restarted (pid %d -> %d)", PERFLOCK_DAEMON_NAME,
+                daemon_pid, pid);
+        stats.restarts++;
+        restarted = 1;
+    } else if (pid && !daemon_pid &&
+            __atomic_load_n(&locks_granted, __ATOMIC_RELAXED)) {
+        ALOGW("%s started (pid %d) after perflocks were granted",
+                PERFLOCK_DAEMON_NAME, pid);
+        stats.restarts++;
+        restarted = 1;
+    } else if (!pid && release_failed) {
+        restarted = 1;
+    }
+
+    if (pid)
+        daemon_pid = pid;
+
+    if (restarted) {
+        int hints = reacquire_hint_locks();
+        int others = reacquire_boost_locks() + sustained_perf_reacquire() +
+                vsync_boost_reacquire();
+
+        stats.recoveries++;
+        stats.locks_reacquired += hints + others;
+        ALOGI("Perflock recovery %lu: re-acquired %d hint and %d other locks",
+                stats.recoveries, hints, others);
+    }
+
+    publish_stats_locked();
+}
+
+static void probe_timer_expired(__attribute__((unused)) void *data)
+{
+    pthread_mutex_lock(&monitor_mutex);
+    probe_locked(0);
+    power_timer_arm(&probe_timer, PERFLOCK_PROBE_INTERVAL_MS);
+    pthread_mutex_unlock(&monitor_mutex);
+}
+
+/* Called once the vendor library is ready. */
+void perflock_monitor_start(void)
+{
+    pthread_mutex_lock(&monitor_mutex);
+    if (!started) {
+        started = 1;
+        daemon_pid = find_daemon();
+        publish_stats_locked();
+        power_timer_init(&probe_timer, probe_timer_expired, NULL);
+        power_timer_arm(&probe_timer, PERFLOCK_PROBE_INTERVAL_MS);
+    }
+    pthread_mutex_unlock(&monitor_mutex);
+}
+
+/* Must not be called with the hint list locked. */
+void perflock_monitor_release_failed(void)
+{
+    pthread_mutex_lock(&monitor_mutex);
+    stats.failed_releases++;
+    if (started)
+        probe_locked(1);
+    pthread_mutex_unlock(&monitor_mutex);
+}
+
+/* Called for every perflock granted, so it only sets a flag. */
+void perflock_monitor_lock_granted(void)
+{
+    if (!__atomic_load_n(&locks_granted, __ATOMIC_RELAXED))
+        __atomic_store_n(&locks_granted, 1, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,37 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _QCOM_PERFLOCK_MONITOR_H
+#define _QCOM_PERFLOCK_MONITOR_H
+
+/* Process serving perf_lock_acq(); its pid changes when it restarts. */
+#define PERFLOCK_DAEMON_NAME        "perfd"
+#define PERFLOCK_PROBE_INTERVAL_MS  (10 * 1000)
+
+struct perflock_monitor_stats {
+    unsigned long probes;
+    unsigned long restarts;
+    unsigned long failed_releases;
+    unsigned long recoveries;
+    /* Hint list, profile, sustained and vsync locks taken again */
+    unsigned long locks_reacquired;
+};
+
+void perflock_monitor_start(void);
+void perflock_monitor_release_failed(void);
+void perflock_monitor_lock_granted(void);
+
+#endif
@@ -0,0 +1,201 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * CPU wakeup latency votes for boosts.
+ *
+ * Without the vendor daemon there is nothing to keep the CPUs out of
+ * power collapse while the user is touching the screen, so boosts also
+ * vote through the kernel's PM QoS interface. A cpu_dma_latency request
+ * lasts as long as its fd is open: it is opened on the first vote,
+ * rewritten with the tightest latency any active vote type asks for,
+ * and closed when the last vote goes away. Votes are timed or held
+ * until unvoted. Timed votes of a type share one power_timer running to
+ * the latest deadline asked for; held votes are refcounted per type.
+ */
+
+#define LOG_NIDEBUG 0
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#define LOG_TAG "QCOM PowerHAL"
+#include <utils/Log.h>
+
+#include "power-state.h"
+#include "power-timer.h"
+#include "pm-qos.h"
+
+struct vote_state {
+    /* Untimed votes not yet unvoted */
+    int holds;
+    struct power_timer timer;
+};
+
+static pthread_mutex_t pm_qos_mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct vote_state votes[PM_QOS_VOTE_COUNT];
+static struct power_state_pm_qos pm_qos_stats = { .latency_us = -1 };
+static int timers_ready;
+static int qos_fd = -1;
+
+/* Return a latency in us, or -1 to not vote for that type. */
+int __attribute__ ((weak)) get_pm_qos_latency_us(
+        __attribute__((unused)) int type)
+{
+    return PM_QOS_DEFAULT_LATENCY_US;
+}
+
+static int vote_active(int type)
+{
+    return votes[type].holds > 0 || power_timer_pending(&votes[type].timer);
+}
+
+/* The kernel takes the latency as a raw s32. */
+static int write_latency_locked(int32_t latency_us)
+{
+    /* Rewinds a stand-in file; a no-op on the misc device. */
+    lseek(qos_fd, 0, SEEK_SET);
+
+    if (write(qos_fd, &latency_us, sizeof(latency_us)) !=
+            (ssize_t)sizeof(latency_us)) {
+        ALOGE("Failed to write %s: %s", PM_QOS_CPU_DMA_LATENCY_PATH,
+                strerror(errno));
+        pm_qos_stats.failures++;
+        return -1;
+    }
+
+    return 0;
+}
+
+static void set_latency_locked(void)
+{
+    int type, latency, target = -1;
+
+    for (type = 0; type < PM_QOS_VOTE_COUNT; type++) {
+        if (!vote_active(type))
+            continue;
+        latency = get_pm_qos_latency_us(type);
+        if (latency >= 0 && (target < 0 || latency < target))
+            target = latency;
+    }
+
+    if (target == pm_qos_stats.latency_us)
+        return;
+
+    if (target < 0) {
+        /* Closing the fd drops the request. */
+        close(qos_fd);
+        qos_fd = -1;
+        pm_qos_stats.latency_us = -1;
+        return;
+    }
+
+    if (qos_fd < 0) {
+        qos_fd = open(PM_QOS_CPU_DMA_LATENCY_PATH, O_WRONLY | O_CLOEXEC);
+        if (qos_fd < 0) {
+            ALOGE("Failed to open %s: %s", PM_QOS_CPU_DMA_LATENCY_PATH,
+                    strerror(errno));
+            pm_qos_stats.failures++;
+            return;
+        }
+        pm_qos_stats.requests++;
+    } else {
+        pm_qos_stats.updates++;
+    }
+
+    if (write_latency_locked(target)) {
+        close(qos_fd);
+        qos_fd = -1;
+        pm_qos_stats.latency_us = -1;
+        return;
+    }
+
+    pm_qos_stats.latency_us = target;
+}
+
+static void update_locked(void)
+{
+    set_latency_locked();
+    power_state_set_pm_qos(&pm_qos_stats);
+}
+
+static void vote_expired(__attribute__((unused)) void *data)
+{
+    pthread_mutex_lock(&pm_qos_mutex);
+    update_locked();
+    pthread_mutex_unlock(&pm_qos_mutex);
+}
+
+/*
+ * Hold the latency for 'type' for duration_ms. A running timed vote of
+ * the same type keeps the later of the two deadlines. A duration of 0
+ * holds the vote until pm_qos_unvote(). Returns 1 if a latency is held.
+ */
+int pm_qos_vote(int type, int duration_ms)
+{
+    int i, ret;
+
+    if (type < 0 || type >= PM_QOS_VOTE_COUNT || duration_ms < 0)
+        return 0;
+
+    pthread_mutex_lock(&pm_qos_mutex);
+
+    if (!timers_ready) {
+        for (i = 0; i < PM_QOS_VOTE_COUNT; i++)
+            power_timer_init(&votes[i].timer, vote_expired, NULL);
+        timers_ready = 1;
+    }
+
+    if (duration_ms > 0) {
+        if (power_timer_extend(&votes[type].timer, duration_ms))
+            goto out;
+    } else {
+        votes[type].holds++;
+    }
+
+    pm_qos_stats.votes++;
+    update_locked();
+
+out:
+    ret = pm_qos_stats.latency_us >= 0;
+    pthread_mutex_unlock(&pm_qos_mutex);
+
+    return ret;
+}
+
+void pm_qos_unvote(int type)
+{
+    if (type < 0 || type >= PM_QOS_VOTE_COUNT)
+        return;
+
+    pthread_mutex_lock(&pm_qos_mutex);
+
+    if (votes[type].holds == 0) {
+        ALOGW("Unbalanced PM QoS unvote of type %d", type);
+        goto out;
+    }
+
+    votes[type].holds--;
+    update_locked();
+
+out:
+    pthread_mutex_unlock(&pm_qos_mutex);
+}
@@ -0,0 +1,41 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef _QCOM_PM_QOS_H
+#define _QCOM_PM_QOS_H
+
+/* Overridable so the votes can be pointed at a stand-in file. */
+#ifndef PM_QOS_CPU_DMA_LATENCY_PATH
+#define PM_QOS_CPU_DMA_LATENCY_PATH     "/dev/cpu_dma_latency"
+#endif
+
+/* Rules out everything deeper than WFI, like ALL_CPUS_PWR_CLPS_DIS. */
+#define PM_QOS_DEFAULT_LATENCY_US       (1)
+
+enum pm_qos_vote_type {
+    PM_QOS_VOTE_INTERACTION = 0,
+    PM_QOS_VOTE_LAUNCH,
+    PM_QOS_VOTE_AUDIO,
+    PM_QOS_VOTE_COUNT
+};
+
+int pm_qos_vote(int type, int duration_ms);
+void pm_qos_unvote(int type);
+
+int get_pm_qos_latency_us(int type);
+
+#endif
@@ -46,10 +46,19 @@
 #include "hint-data.h"
 #include "performance.h"
 #include "power-common.h"
+#include "hint-table.h"
+#include "boost-budget.h"
 
 static int display_hint_sent;
 static int display_hint2_sent;
 static int first_display_off_hint;
+
+static const hint_table_t hint_table = {
+    [HINT_TYPE_DISPLAY_OFF] = {
+        [GOVERNOR_ONDEMAND] = HINT_VECTOR(MS_500, SYNC_FREQ_600, OPTIMAL_FREQ_600,
+                THREAD_MIGRATION_SYNC_OFF),
+    },
+};
 extern int display_boost;
 
 int get_number_of_profiles() {
@@ -58,6 +67,10 @@ int get_number_of_profiles() {
 
 static int current_power_profile = PROFILE_BALANCED;
 
+static int profile_power_save[] = { CPUS_ONLINE_MAX_LIMIT_2,
+    CPU0_MAX_FREQ_NONTURBO_MAX, CPU1_MAX_FREQ_NONTURBO_MAX,
+    CPU2_MAX_FREQ_NONTURBO_MAX, CPU3_MAX_FREQ_NONTURBO_MAX };
+
 static void set_power_profile(int profile) {
 
     if (profile == current_power_profile)
@@ -79,17 +92,20 @@ static void set_power_profile(int profile) {
         ALOGD("%s: set performance mode", __func__);
 
     } else if (profile == PROFILE_POWER_SAVE) {
-        int resource_values[] = { CPUS_ONLINE_MAX_LIMIT_2,
-            CPU0_MAX_FREQ_NONTURBO_MAX, CPU1_MAX_FREQ_NONTURBO_MAX,
-            CPU2_MAX_FREQ_NONTURBO_MAX, CPU3_MAX_FREQ_NONTURBO_MAX };
-        perform_hint_action(DEFAULT_PROFILE_HINT_ID,
-            resource_values, sizeof(resource_values)/sizeof(resource_values[0]));
+        perform_hint_action(DEFAULT_PROFILE_HINT_ID, profile_power_save,
+            sizeof(profile_power_save)/sizeof(profile_power_save[0]));
         ALOGD("%s: set powersave", __func__);
     }
 
     current_power_profile = profile;
 }
 
+int get_low_power_resources(int **resources)
+{
+    *resources = profile_power_save;
+    return sizeof(profile_power_save)/sizeof(profile_power_save[0]);
+}
+
 extern void interaction(int duration, int num_args, int opt_list[]);
 
 int power_hint_override(__attribute__((unused)) struct power_module *module,
@@ -101,7 +117,8 @@ int power_hint_override(__attribute__((unused)) struct power_module *module,
 	}
 
 	// Skip other hints in custom power modes
-	if (current_power_profile != PROFILE_BALANCED) {
+	if (current_power_profile != PROFILE_BALANCED &&
+			!boost_budget_layered_hint(hint)) {
 		return HINT_HANDLED;
 	}
 
@@ -120,14 +137,17 @@ int power_hint_override(__attribute__((unused)) struct power_module *module,
 
 int set_interactive_override(struct power_module *module, int on)
 {
-    char governor[80];
+    const struct hint_vector *display_off;
+    int governor = get_scaling_governor_id();
 
-    if (get_scaling_governor(governor, sizeof(governor)) == -1) {
+    if (governor == -1) {
         ALOGE("Can't obtain scaling governor.");
 
         return HINT_NONE;
     }
 
+    display_off = hint_table_lookup(hint_table, HINT_TYPE_DISPLAY_OFF, governor);
+
     if (!on) {
         /* Display off. */
         /*
@@ -146,13 +166,9 @@ int set_interactive_override(struct power_module *module, int on)
             }
         }
 
-        if ((strncmp(governor, ONDEMAND_GOVERNOR, strlen(ONDEMAND_GOVERNOR)) == 0) &&
-                (strlen(governor) == strlen(ONDEMAND_GOVERNOR))) {
-            int resource_values[] = {MS_500, SYNC_FREQ_600, OPTIMAL_FREQ_600, THREAD_MIGRATION_SYNC_OFF};
-
+        if (display_off) {
             if (!display_hint_sent) {
-                perform_hint_action(DISPLAY_STATE_HINT_ID,
-                        resource_values, sizeof(resource_values)/sizeof(resource_values[0]));
+                perform_hint_vector(DISPLAY_STATE_HINT_ID, display_off);
                 display_hint_sent = 1;
             }
 
@@ -167,8 +183,7 @@ int set_interactive_override(struct power_module *module, int on)
             display_hint2_sent = 0;
         }
 
-        if ((strncmp(governor, ONDEMAND_GOVERNOR, strlen(ONDEMAND_GOVERNOR)) == 0) &&
-                (strlen(governor) == strlen(ONDEMAND_GOVERNOR))) {
+        if (display_off) {
             undo_hint_action(DISPLAY_STATE_HINT_ID);
             display_hint_sent = 0;
 
@@ -47,8 +47,7 @@
 #include "hint-data.h"
 #include "performance.h"
 #include "power-common.h"
-
-static int display_hint_sent;
+#include "boost-budget.h"
 
 int get_number_of_profiles() {
     return 3;
@@ -56,6 +55,10 @@ int get_number_of_profiles() {
 
 static int current_power_profile = PROFILE_BALANCED;
 
+static int profile_power_save[] = { CPUS_ONLINE_MAX_LIMIT_2,
+    CPU0_MAX_FREQ_NONTURBO_MAX, CPU1_MAX_FREQ_NONTURBO_MAX,
+    CPU2_MAX_FREQ_NONTURBO_MAX, CPU3_MAX_FREQ_NONTURBO_MAX };
+
 static void set_power_profile(int profile) {
 
     if (profile == current_power_profile)
@@ -76,17 +79,20 @@ static void set_power_profile(int profile) {
             resource_values, sizeof(resource_values)/sizeof(resource_values[0]));
         ALOGD("%s: set performance mode", __func__);
     } else if (profile == PROFILE_POWER_SAVE) {
-        int resource_values[] = { CPUS_ONLINE_MAX_LIMIT_2,
-            CPU0_MAX_FREQ_NONTURBO_MAX, CPU1_MAX_FREQ_NONTURBO_MAX,
-            CPU2_MAX_FREQ_NONTURBO_MAX, CPU3_MAX_FREQ_NONTURBO_MAX };
-        perform_hint_action(DEFAULT_PROFILE_HINT_ID,
-            resource_values, sizeof(resource_values)/sizeof(resource_values[0]));
+        perform_hint_action(DEFAULT_PROFILE_HINT_ID, profile_power_save,
+            sizeof(profile_power_save)/sizeof(profile_power_save[0]));
         ALOGD("%s: set powersave", __func__);
     }
 
     current_power_profile = profile;
 }
 
+int get_low_power_resources(int **resources)
+{
+    *resources = profile_power_save;
+    return sizeof(profile_power_save)/sizeof(profile_power_save[0]);
+}
+
 extern void interaction(int duration, int num_args, int opt_list[]);
 
 int power_hint_override(__attribute__((unused)) struct power_module *module,
@@ -98,7 +104,8 @@ int power_hint_override(__attribute__((unused)) struct power_module *module,
     }
 
     // Skip other hints in custom power modes
-    if (current_power_profile != PROFILE_BALANCED) {
+    if (current_power_profile != PROFILE_BALANCED &&
+            !boost_budget_layered_hint(hint)) {
         return HINT_HANDLED;
     }
 
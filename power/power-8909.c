@@ -46,19 +46,17 @@
 #include "hint-data.h"
 #include "performance.h"
 #include "power-common.h"
+#include "hint-table.h"
 
+static const hint_table_t hint_table = {
+    [HINT_TYPE_VIDEO_ENCODE] = {
+        [GOVERNOR_INTERACTIVE] = HINT_VECTOR(HS_FREQ_800, THREAD_MIGRATION_SYNC_OFF),
+    },
+};
 
 static void process_video_encode_hint(void *metadata)
 {
-    char governor[80];
     struct video_encode_metadata_t video_encode_metadata;
-    char tmp_str[NODE_MAX];
-
-    if (get_scaling_governor(governor, sizeof(governor)) == -1) {
-        ALOGE("Can't obtain scaling governor.");
-
-        return;
-    }
 
     /* Initialize encode metadata struct fields. */
     memset(&video_encode_metadata, 0, sizeof(struct video_encode_metadata_t));
@@ -75,19 +73,9 @@ static void process_video_encode_hint(void *metadata)
         return;
     }
 
-    if (video_encode_metadata.state == 1) {
-        if ((strncmp(governor, INTERACTIVE_GOVERNOR, strlen(INTERACTIVE_GOVERNOR)) == 0) &&
-                (strlen(governor) == strlen(INTERACTIVE_GOVERNOR))) {
-            int resource_values[] = {HS_FREQ_800, THREAD_MIGRATION_SYNC_OFF};
-            perform_hint_action(video_encode_metadata.hint_id,
-                    resource_values, sizeof(resource_values)/sizeof(resource_values[0]));
-        }
-    } else if (video_encode_metadata.state == 0) {
-         if ((strncmp(governor, INTERACTIVE_GOVERNOR, strlen(INTERACTIVE_GOVERNOR)) == 0) &&
-                (strlen(governor) == strlen(INTERACTIVE_GOVERNOR))) {
-           undo_hint_action(video_encode_metadata.hint_id);
-        }
-    }
+    hint_table_dispatch(hint_table, HINT_TYPE_VIDEO_ENCODE,
+            video_encode_metadata.hint_id, video_encode_metadata.state,
+            video_encode_metadata.pid);
 }
 
 int power_hint_override(struct power_module *module, power_hint_t hint, void *data)
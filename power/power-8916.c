@@ -47,17 +47,20 @@
 #include "hint-data.h"
 #include "performance.h"
 #include "power-common.h"
+#include "hint-table.h"
+#include "sustained-perf.h"
+#include "vsync-boost.h"
+#include "cpufreq-policy.h"
+#include "boost-placement.h"
+#include "devfreq-boost.h"
+#include "boot-boost.h"
+#include "core-ctl.h"
+#include "socinfo.h"
+#include "boost-budget.h"
 
 #define MIN_FREQ_CPU0_DISP_OFF 400000
 #define MIN_FREQ_CPU0_DISP_ON  960000
 
-char scaling_min_freq[4][80] ={
-    "sys/devices/system/cpu/cpu0/cpufreq/scaling_min_freq",
-    "sys/devices/system/cpu/cpu1/cpufreq/scaling_min_freq",
-    "sys/devices/system/cpu/cpu2/cpufreq/scaling_min_freq",
-    "sys/devices/system/cpu/cpu3/cpufreq/scaling_min_freq"
-};
-
 static int is_8916 = -1;
 
 static int display_hint_sent;
@@ -66,32 +69,19 @@ static int saved_interactive_mode = -1;
 static int slack_node_rw_failed = 0;
 
 int get_number_of_profiles() {
-    return 3;
+    return 6;
 }
 
 static int current_power_profile = PROFILE_BALANCED;
 
 static int is_target_8916() /* Returns value=8916 if target is 8916 else value 0 */
 {
-    int fd;
-    char buf[10] = {0};
-
     if (is_8916 >= 0)
         return is_8916;
 
-    fd = open("/sys/devices/soc0/soc_id", O_RDONLY);
-    if (fd >= 0) {
-        if (read(fd, buf, sizeof(buf) - 1) == -1) {
-            ALOGW("Unable to read soc_id");
-            is_8916 = 0;
-        } else {
-            int soc_id = atoi(buf);
-            if (soc_id == 206 || (soc_id >= 247 && soc_id <= 250))  {
-            is_8916 = 8916; /* Above SOCID for 8916 */
-            }
-        }
-    }
-    close(fd);
+    /* Anything that isn't an 8916 is an 8939. */
+    is_8916 = socinfo_get()->family == SOC_FAMILY_MSM8916 ? 8916 : 0;
+
     return is_8916;
 }
 
@@ -124,42 +114,151 @@ static void set_power_profile(int profile) {
 
     ALOGV("%s: profile=%d", __func__, profile);
 
-    if (current_power_profile != PROFILE_BALANCED) {
+    if (current_power_profile == PROFILE_SUSTAINED_PERFORMANCE) {
+        sustained_perf_stop();
+    } else if (current_power_profile != PROFILE_BALANCED) {
         undo_hint_action(DEFAULT_PROFILE_HINT_ID);
         ALOGV("%s: hint undone", __func__);
     }
 
     if (profile == PROFILE_HIGH_PERFORMANCE) {
-        int *resource_values = is_target_8916() ?
-            profile_high_performance_8916 : profile_high_performance_8939;
-
-        perform_hint_action(DEFAULT_PROFILE_HINT_ID,
-            resource_values, sizeof(resource_values)/sizeof(resource_values[0]));
+        if (is_target_8916())
+            perform_hint_action(DEFAULT_PROFILE_HINT_ID,
+                profile_high_performance_8916,
+                sizeof(profile_high_performance_8916)/sizeof(profile_high_performance_8916[0]));
+        else
+            perform_hint_action(DEFAULT_PROFILE_HINT_ID,
+                profile_high_performance_8939,
+                sizeof(profile_high_performance_8939)/sizeof(profile_high_performance_8939[0]));
         ALOGD("%s: set performance mode", __func__);
 
     } else if (profile == PROFILE_POWER_SAVE) {
-        int* resource_values = is_target_8916() ?
-            profile_power_save_8916 : profile_power_save_8939;
-
-        perform_hint_action(DEFAULT_PROFILE_HINT_ID,
-            resource_values, sizeof(resource_values)/sizeof(resource_values[0]));
+        if (is_target_8916())
+            perform_hint_action(DEFAULT_PROFILE_HINT_ID,
+                profile_power_save_8916,
+                sizeof(profile_power_save_8916)/sizeof(profile_power_save_8916[0]));
+        else
+            perform_hint_action(DEFAULT_PROFILE_HINT_ID,
+                profile_power_save_8939,
+                sizeof(profile_power_save_8939)/sizeof(profile_power_save_8939[0]));
         ALOGD("%s: set powersave", __func__);
+
+    } else if (profile == PROFILE_SUSTAINED_PERFORMANCE) {
+        sustained_perf_start();
+        ALOGD("%s: set sustained perf mode", __func__);
     }
 
     current_power_profile = profile;
 }
 
-static void process_video_decode_hint(void *metadata)
+int get_low_power_resources(int **resources)
 {
-    char governor[80];
-    struct video_decode_metadata_t video_decode_metadata;
+    if (is_target_8916()) {
+        *resources = profile_power_save_8916;
+        return sizeof(profile_power_save_8916)/sizeof(profile_power_save_8916[0]);
+    }
 
-    if (get_scaling_governor(governor, sizeof(governor)) == -1) {
-        ALOGE("Can't obtain scaling governor.");
+    *resources = profile_power_save_8939;
+    return sizeof(profile_power_save_8939)/sizeof(profile_power_save_8939[0]);
+}
 
-        return;
+static const struct sustained_cluster sustained_clusters_8916[] = {
+    { 0, 4 },
+};
+
+static const struct sustained_cluster sustained_clusters_8939[] = {
+    { 0, 4 }, { 4, 4 },
+};
+
+int get_sustained_perf_clusters(const struct sustained_cluster **clusters)
+{
+    if (is_target_8916()) {
+        *clusters = sustained_clusters_8916;
+        return sizeof(sustained_clusters_8916)/sizeof(sustained_clusters_8916[0]);
     }
 
+    *clusters = sustained_clusters_8939;
+    return sizeof(sustained_clusters_8939)/sizeof(sustained_clusters_8939[0]);
+}
+
+static const struct core_ctl_cluster core_ctl_clusters_8916[] = {
+    { 0, 4 },
+};
+
+static const struct core_ctl_cluster core_ctl_clusters_8939[] = {
+    { 0, 4 }, { 4, 4 },
+};
+
+int get_core_ctl_clusters(const struct core_ctl_cluster **clusters)
+{
+    if (is_target_8916()) {
+        *clusters = core_ctl_clusters_8916;
+        return sizeof(core_ctl_clusters_8916)/sizeof(core_ctl_clusters_8916[0]);
+    }
+
+    *clusters = core_ctl_clusters_8939;
+    return sizeof(core_ctl_clusters_8939)/sizeof(core_ctl_clusters_8939[0]);
+}
+
+/* 8939: let boosted foreground work onto the big cluster, and move it sooner. */
+static const struct boost_placement_node boost_placement[] = {
+    { CPUSET_PATH "foreground/cpus",        "0-7" },
+    { CPUSET_PATH "top-app/cpus",           "0-7" },
+    { SCHED_KNOB_PATH "sched_downmigrate",  "30" },
+    { SCHED_KNOB_PATH "sched_upmigrate",    "45" },
+};
+
+int get_boost_placement(const struct boost_placement_node **nodes)
+{
+    if (is_target_8916())
+        return 0;
+
+    *nodes = boost_placement;
+    return sizeof(boost_placement)/sizeof(boost_placement[0]);
+}
+
+static const hint_table_t hint_table_8916 = {
+    [HINT_TYPE_VIDEO_ENCODE] = {
+        [GOVERNOR_ONDEMAND] = HINT_VECTOR(IO_BUSY_OFF, SAMPLING_DOWN_FACTOR_1,
+                THREAD_MIGRATION_SYNC_OFF),
+        [GOVERNOR_INTERACTIVE] = HINT_VECTOR(HS_FREQ_800, 0x1C00),
+    },
+    [HINT_TYPE_VIDEO_DECODE] = {
+        [GOVERNOR_ONDEMAND] = HINT_VECTOR(THREAD_MIGRATION_SYNC_OFF),
+        [GOVERNOR_INTERACTIVE] = HINT_VECTOR(TR_MS_30, HISPEED_LOAD_90, HS_FREQ_1026),
+    },
+    [HINT_TYPE_DISPLAY_OFF] = {
+        [GOVERNOR_INTERACTIVE] = HINT_VECTOR(TR_MS_50, THREAD_MIGRATION_SYNC_OFF),
+    },
+};
+
+/* 8939 only differs in its per-cluster display off timer rate */
+static const hint_table_t hint_table_8939 = {
+    [HINT_TYPE_VIDEO_ENCODE] = {
+        [GOVERNOR_ONDEMAND] = HINT_VECTOR(IO_BUSY_OFF, SAMPLING_DOWN_FACTOR_1,
+                THREAD_MIGRATION_SYNC_OFF),
+        [GOVERNOR_INTERACTIVE] = HINT_VECTOR(HS_FREQ_800, 0x1C00),
+    },
+    [HINT_TYPE_VIDEO_DECODE] = {
+        [GOVERNOR_ONDEMAND] = HINT_VECTOR(THREAD_MIGRATION_SYNC_OFF),
+        [GOVERNOR_INTERACTIVE] = HINT_VECTOR(TR_MS_30, HISPEED_LOAD_90, HS_FREQ_1026),
+    },
+    [HINT_TYPE_DISPLAY_OFF] = {
+        [GOVERNOR_INTERACTIVE] = HINT_VECTOR(TR_MS_CPU0_50, TR_MS_CPU4_50,
+                THREAD_MIGRATION_SYNC_OFF),
+    },
+};
+
+/* Row-of-governors pointer, which is what a hint_table_t decays to. */
+static const struct hint_vector (*get_hint_table(void))[GOVERNOR_COUNT]
+{
+    return is_target_8916() ? hint_table_8916 : hint_table_8939;
+}
+
+static void process_video_decode_hint(void *metadata)
+{
+    struct video_decode_metadata_t video_decode_metadata;
+
     if (metadata) {
         ALOGI("Processing video decode hint. Metadata: %s", (char *)metadata);
     }
@@ -179,41 +278,15 @@ static void process_video_decode_hint(void *metadata)
         return;
     }
 
-    if (video_decode_metadata.state == 1) {
-        if ((strncmp(governor, ONDEMAND_GOVERNOR, strlen(ONDEMAND_GOVERNOR)) == 0) &&
-                (strlen(governor) == strlen(ONDEMAND_GOVERNOR))) {
-            int resource_values[] = {THREAD_MIGRATION_SYNC_OFF};
-
-            perform_hint_action(video_decode_metadata.hint_id,
-                    resource_values, sizeof(resource_values)/sizeof(resource_values[0]));
-        } else if ((strncmp(governor, INTERACTIVE_GOVERNOR, strlen(INTERACTIVE_GOVERNOR)) == 0) &&
-                (strlen(governor) == strlen(INTERACTIVE_GOVERNOR))) {
-            int resource_values[] = {TR_MS_30, HISPEED_LOAD_90, HS_FREQ_1026};
-
-            perform_hint_action(video_decode_metadata.hint_id,
-                    resource_values, sizeof(resource_values)/sizeof(resource_values[0]));
-        }
-    } else if (video_decode_metadata.state == 0) {
-        if ((strncmp(governor, ONDEMAND_GOVERNOR, strlen(ONDEMAND_GOVERNOR)) == 0) &&
-                (strlen(governor) == strlen(ONDEMAND_GOVERNOR))) {
-        } else if ((strncmp(governor, INTERACTIVE_GOVERNOR, strlen(INTERACTIVE_GOVERNOR)) == 0) &&
-                (strlen(governor) == strlen(INTERACTIVE_GOVERNOR))) {
-            undo_hint_action(video_decode_metadata.hint_id);
-        }
-    }
+    hint_table_dispatch(get_hint_table(), HINT_TYPE_VIDEO_DECODE,
+            video_decode_metadata.hint_id, video_decode_metadata.state,
+            video_decode_metadata.pid);
 }
 
 static void process_video_encode_hint(void *metadata)
 {
-    char governor[80];
     struct video_encode_metadata_t video_encode_metadata;
 
-    if (get_scaling_governor(governor, sizeof(governor)) == -1) {
-        ALOGE("Can't obtain scaling governor.");
-
-        return;
-    }
-
     /* Initialize encode metadata struct fields. */
     memset(&video_encode_metadata, 0, sizeof(struct video_encode_metadata_t));
     video_encode_metadata.state = -1;
@@ -229,29 +302,9 @@ static void process_video_encode_hint(void *metadata)
         return;
     }
 
-    if (video_encode_metadata.state == 1) {
-        if ((strncmp(governor, ONDEMAND_GOVERNOR, strlen(ONDEMAND_GOVERNOR)) == 0) &&
-                (strlen(governor) == strlen(ONDEMAND_GOVERNOR))) {
-            int resource_values[] = {IO_BUSY_OFF, SAMPLING_DOWN_FACTOR_1, THREAD_MIGRATION_SYNC_OFF};
-
-            perform_hint_action(video_encode_metadata.hint_id,
-                resource_values, sizeof(resource_values)/sizeof(resource_values[0]));
-        } else if ((strncmp(governor, INTERACTIVE_GOVERNOR, strlen(INTERACTIVE_GOVERNOR)) == 0) &&
-                (strlen(governor) == strlen(INTERACTIVE_GOVERNOR))) {
-            int resource_values[] = {HS_FREQ_800, 0x1C00};
-
-            perform_hint_action(video_encode_metadata.hint_id,
-                    resource_values, sizeof(resource_values)/sizeof(resource_values[0]));
-        }
-    } else if (video_encode_metadata.state == 0) {
-        if ((strncmp(governor, ONDEMAND_GOVERNOR, strlen(ONDEMAND_GOVERNOR)) == 0) &&
-                (strlen(governor) == strlen(ONDEMAND_GOVERNOR))) {
-            undo_hint_action(video_encode_metadata.hint_id);
-        } else if ((strncmp(governor, INTERACTIVE_GOVERNOR, strlen(INTERACTIVE_GOVERNOR)) == 0) &&
-                (strlen(governor) == strlen(INTERACTIVE_GOVERNOR))) {
-            undo_hint_action(video_encode_metadata.hint_id);
-        }
-    }
+    hint_table_dispatch(get_hint_table(), HINT_TYPE_VIDEO_ENCODE,
+            video_encode_metadata.hint_id, video_encode_metadata.state,
+            video_encode_metadata.pid);
 }
 
 extern void interaction(int duration, int num_args, int opt_list[]);
@@ -264,36 +317,29 @@ typedef int hintdata;
 
 int  set_interactive_override(struct power_module *module __unused, int on)
 {
-    char governor[80];
+    const struct hint_vector *display_off;
     char tmp_str[NODE_MAX];
-    struct video_encode_metadata_t video_encode_metadata;
-    int rc;
+    int governor;
 
     ALOGI("Got set_interactive hint");
-    if (get_scaling_governor_check_cores(governor, sizeof(governor),CPU0) == -1) {
-        if (get_scaling_governor_check_cores(governor, sizeof(governor),CPU1) == -1) {
-            if (get_scaling_governor_check_cores(governor, sizeof(governor),CPU2) == -1) {
-                if (get_scaling_governor_check_cores(governor, sizeof(governor),CPU3) == -1) {
-                    ALOGE("Can't obtain scaling governor.");
-                    return HINT_HANDLED;
-                }
-            }
-        }
+    governor = get_scaling_governor_id();
+    if (governor == -1) {
+        ALOGE("Can't obtain scaling governor.");
+        return HINT_HANDLED;
     }
 
+    display_off = hint_table_lookup(get_hint_table(), HINT_TYPE_DISPLAY_OFF,
+            governor);
+
     if (!on) {
         /* Display off. */
        switch(is_target_8916()) {
 
           case 8916:
            {
-            if ((strncmp(governor, INTERACTIVE_GOVERNOR, strlen(INTERACTIVE_GOVERNOR)) == 0) &&
-                (strlen(governor) == strlen(INTERACTIVE_GOVERNOR))) {
-               int resource_values[] = {TR_MS_50, THREAD_MIGRATION_SYNC_OFF};
-
+            if (display_off) {
                   if (!display_hint_sent) {
-                      perform_hint_action(DISPLAY_STATE_HINT_ID,
-                      resource_values, sizeof(resource_values)/sizeof(resource_values[0]));
+                      perform_hint_vector(DISPLAY_STATE_HINT_ID, display_off);
                       display_hint_sent = 1;
                   }
             } /* Perf time rate set for 8916 target*/
@@ -302,29 +348,19 @@ int  set_interactive_override(struct power_module *module __unused, int on)
 
             default:
             {
-             if ((strncmp(governor, INTERACTIVE_GOVERNOR, strlen(INTERACTIVE_GOVERNOR)) == 0) &&
-                (strlen(governor) == strlen(INTERACTIVE_GOVERNOR))) {
-               int resource_values[] = {TR_MS_CPU0_50,TR_MS_CPU4_50, THREAD_MIGRATION_SYNC_OFF};
-
+             if (display_off) {
                /* Set CPU0 MIN FREQ to 400Mhz avoid extra peak power
                   impact in volume key press  */
                snprintf(tmp_str, NODE_MAX, "%d", MIN_FREQ_CPU0_DISP_OFF);
-               if (sysfs_write(scaling_min_freq[0], tmp_str) != 0) {
-                   if (sysfs_write(scaling_min_freq[1], tmp_str) != 0) {
-                       if (sysfs_write(scaling_min_freq[2], tmp_str) != 0) {
-                           if (sysfs_write(scaling_min_freq[3], tmp_str) != 0) {
-                               if(!slack_node_rw_failed) {
-                                  ALOGE("Failed to write to %s",SCALING_MIN_FREQ );
-                               }
-                                rc = 1;
-                           }
-                       }
+               if (cpufreq_policy_write(0, "scaling_min_freq", tmp_str) ==
+                       CPUFREQ_POLICY_ERROR) {
+                   if(!slack_node_rw_failed) {
+                      ALOGE("Failed to write to %s",SCALING_MIN_FREQ );
                    }
-                }
+               }
 
                   if (!display_hint_sent) {
-                      perform_hint_action(DISPLAY_STATE_HINT_ID,
-                      resource_values, sizeof(resource_values)/sizeof(resource_values[0]));
+                      perform_hint_vector(DISPLAY_STATE_HINT_ID, display_off);
                       display_hint_sent = 1;
                   }
              } /* Perf time rate set for CORE0,CORE4 8939 target*/
@@ -337,8 +373,7 @@ int  set_interactive_override(struct power_module *module __unused, int on)
       switch(is_target_8916()){
          case 8916:
          {
-          if ((strncmp(governor, INTERACTIVE_GOVERNOR, strlen(INTERACTIVE_GOVERNOR)) == 0) &&
-                (strlen(governor) == strlen(INTERACTIVE_GOVERNOR))) {
+          if (display_off) {
             undo_hint_action(DISPLAY_STATE_HINT_ID);
             display_hint_sent = 0;
          }
@@ -347,23 +382,16 @@ int  set_interactive_override(struct power_module *module __unused, int on)
          default :
          {
 
-          if ((strncmp(governor, INTERACTIVE_GOVERNOR, strlen(INTERACTIVE_GOVERNOR)) == 0) &&
-                (strlen(governor) == strlen(INTERACTIVE_GOVERNOR))) {
+          if (display_off) {
 
               /* Recovering MIN_FREQ in display ON case */
                snprintf(tmp_str, NODE_MAX, "%d", MIN_FREQ_CPU0_DISP_ON);
-               if (sysfs_write(scaling_min_freq[0], tmp_str) != 0) {
-                   if (sysfs_write(scaling_min_freq[1], tmp_str) != 0) {
-                       if (sysfs_write(scaling_min_freq[2], tmp_str) != 0) {
-                           if (sysfs_write(scaling_min_freq[3], tmp_str) != 0) {
-                               if(!slack_node_rw_failed) {
-                                  ALOGE("Failed to write to %s",SCALING_MIN_FREQ );
-                               }
-                                rc = 1;
-                           }
-                       }
+               if (cpufreq_policy_write(0, "scaling_min_freq", tmp_str) ==
+                       CPUFREQ_POLICY_ERROR) {
+                   if(!slack_node_rw_failed) {
+                      ALOGE("Failed to write to %s",SCALING_MIN_FREQ );
                    }
-                }
+               }
              undo_hint_action(DISPLAY_STATE_HINT_ID);
              display_hint_sent = 0;
           }
@@ -376,6 +404,42 @@ int  set_interactive_override(struct power_module *module __unused, int on)
     return HINT_HANDLED;
 }
 
+/*
+ * Vsync boost: 8939 already holds cpu0 at MIN_FREQ_CPU0_DISP_ON while
+ * the display is on, so its floor has to sit above that.
+ */
+int get_vsync_boost_resources(int resources[], int max_resources)
+{
+    if (max_resources < 1)
+        return 0;
+
+    resources[0] = is_target_8916() ? 0x208 : 0x20B;
+    return 1;
+}
+
+/* Adreno 405 (8939) or 306 (8916) and the CPU-DDR bus */
+static const struct devfreq_boost_node devfreq_boost_nodes[] = {
+    { "kgsl-3d0",   { "310000000", "400000000" } },
+    { "cpubw",      { "2929",      "4248" } },
+};
+
+int get_devfreq_boost_nodes(const struct devfreq_boost_node **nodes)
+{
+    *nodes = devfreq_boost_nodes;
+    return sizeof(devfreq_boost_nodes)/sizeof(devfreq_boost_nodes[0]);
+}
+
+/* Boot: the launch vector, until boot completes */
+static const int boot_boost_resources[] = {
+    SCHED_BOOST_ON, 0x20F, 0x101, 0x1C00, 0x3E01, 0x4001, 0x4101, 0x4201,
+};
+
+int get_boot_boost_resources(const int **resources)
+{
+    *resources = boot_boost_resources;
+    return sizeof(boot_boost_resources)/sizeof(boot_boost_resources[0]);
+}
+
 int power_hint_override(struct power_module *module __unused, power_hint_t hint, void *data)
 {
     if (hint == POWER_HINT_SET_PROFILE) {
@@ -383,7 +447,8 @@ int power_hint_override(struct power_module *module __unused, power_hint_t hint,
     }
 
     // Skip other hints in custom power modes
-    if (current_power_profile != PROFILE_BALANCED) {
+    if (current_power_profile != PROFILE_BALANCED &&
+            !boost_budget_layered_hint(hint)) {
         return HINT_HANDLED;
     }
 
@@ -391,7 +456,7 @@ int power_hint_override(struct power_module *module __unused, power_hint_t hint,
         int duration = 2000;
         int resources[] = { SCHED_BOOST_ON, 0x20F, 0x101, 0x1C00, 0x3E01, 0x4001, 0x4101, 0x4201 };
 
-        interaction(duration, sizeof(resources)/sizeof(resources[0]), resources);
+        launch_boost(duration, sizeof(resources)/sizeof(resources[0]), resources);
 
         return HINT_HANDLED;
 	}
@@ -47,13 +47,29 @@
 #include "hint-data.h"
 #include "performance.h"
 #include "power-common.h"
+#include "hint-table.h"
+#include "sustained-perf.h"
+#include "vsync-boost.h"
+#include "boost-placement.h"
+#include "devfreq-boost.h"
+#include "boot-boost.h"
+#include "core-ctl.h"
+#include "boost-budget.h"
 
 #define ARRAY_SIZE(arr) (sizeof((arr)) / sizeof((arr)[0]))
 
 static int display_hint_sent;
-static int video_encode_hint_sent;
 static int current_power_profile = PROFILE_BALANCED;
 
+static const hint_table_t hint_table = {
+    [HINT_TYPE_VIDEO_ENCODE] = {
+        [GOVERNOR_INTERACTIVE] = HINT_VECTOR(TR_MS_CPU0_30, TR_MS_CPU4_30),
+    },
+    [HINT_TYPE_DISPLAY_OFF] = {
+        [GOVERNOR_INTERACTIVE] = HINT_VECTOR(TR_MS_CPU0_50, TR_MS_CPU4_50),
+    },
+};
+
 static void process_video_encode_hint(void *metadata);
 
 extern void interaction(int duration, int num_args, int opt_list[]);
@@ -67,7 +83,7 @@ static int profile_high_performance_8952[11] = {
     CPU6_MIN_FREQ_TURBO_MAX, CPU7_MIN_FREQ_TURBO_MAX,
 };
 
-static int profile_power_save_8952[5] = {
+static int profile_power_save_8952[] = {
     0x8fe, 0x3dfd, /* 1 big core, 2 little cores*/
     CPUS_ONLINE_MAX_LIMIT_2,
     CPU0_MAX_FREQ_NONTURBO_MAX, CPU1_MAX_FREQ_NONTURBO_MAX,
@@ -75,7 +91,7 @@ static int profile_power_save_8952[5] = {
 };
 
 int get_number_of_profiles() {
-    return 3;
+    return 6;
 }
 
 static void set_power_profile(int profile) {
@@ -85,27 +101,97 @@ static void set_power_profile(int profile) {
 
     ALOGV("%s: profile=%d", __func__, profile);
 
-    if (current_power_profile != PROFILE_BALANCED) {
+    if (current_power_profile == PROFILE_SUSTAINED_PERFORMANCE) {
+        sustained_perf_stop();
+    } else if (current_power_profile != PROFILE_BALANCED) {
         undo_hint_action(DEFAULT_PROFILE_HINT_ID);
         ALOGV("%s: hint undone", __func__);
     }
 
     if (profile == PROFILE_HIGH_PERFORMANCE) {
-        int *resource_values = profile_high_performance_8952;
-        perform_hint_action(DEFAULT_PROFILE_HINT_ID, resource_values,
-                ARRAY_SIZE(resource_values));
+        perform_hint_action(DEFAULT_PROFILE_HINT_ID,
+                profile_high_performance_8952,
+                ARRAY_SIZE(profile_high_performance_8952));
         ALOGD("%s: set performance mode", __func__);
 
     } else if (profile == PROFILE_POWER_SAVE) {
-        int *resource_values = profile_power_save_8952;
-        perform_hint_action(DEFAULT_PROFILE_HINT_ID, resource_values,
-                ARRAY_SIZE(resource_values));
+        perform_hint_action(DEFAULT_PROFILE_HINT_ID, profile_power_save_8952,
+                ARRAY_SIZE(profile_power_save_8952));
         ALOGD("%s: set powersave", __func__);
+
+    } else if (profile == PROFILE_SUSTAINED_PERFORMANCE) {
+        sustained_perf_start();
+        ALOGD("%s: set sustained perf mode", __func__);
     }
 
     current_power_profile = profile;
 }
 
+int get_low_power_resources(int **resources)
+{
+    *resources = profile_power_save_8952;
+    return ARRAY_SIZE(profile_power_save_8952);
+}
+
+static const struct sustained_cluster sustained_clusters[] = {
+    { 0, 4 }, { 4, 4 },
+};
+
+int get_sustained_perf_clusters(const struct sustained_cluster **clusters)
+{
+    *clusters = sustained_clusters;
+    return ARRAY_SIZE(sustained_clusters);
+}
+
+/* 0x7NN/0x8NN address the big cluster, 0x4DNN/0x3DNN the little one. */
+static const struct core_ctl_cluster core_ctl_clusters[] = {
+    { 0, 4 }, { 4, 4 },
+};
+
+int get_core_ctl_clusters(const struct core_ctl_cluster **clusters)
+{
+    *clusters = core_ctl_clusters;
+    return ARRAY_SIZE(core_ctl_clusters);
+}
+
+/* Let boosted foreground work onto the big cluster, and move it sooner. */
+static const struct boost_placement_node boost_placement[] = {
+    { CPUSET_PATH "foreground/cpus",        "0-7" },
+    { CPUSET_PATH "top-app/cpus",           "0-7" },
+    { SCHED_KNOB_PATH "sched_downmigrate",  "30" },
+    { SCHED_KNOB_PATH "sched_upmigrate",    "45" },
+};
+
+int get_boost_placement(const struct boost_placement_node **nodes)
+{
+    *nodes = boost_placement;
+    return ARRAY_SIZE(boost_placement);
+}
+
+/* Adreno 405, the CPU-DDR bus and its latency floor */
+static const struct devfreq_boost_node devfreq_boost_nodes[] = {
+    { "kgsl-3d0",   { "310000000", "465000000" } },
+    { "cpubw",      { "3051",      "5712" } },
+    { "mincpubw",   { NULL,        "1525" } },
+};
+
+int get_devfreq_boost_nodes(const struct devfreq_boost_node **nodes)
+{
+    *nodes = devfreq_boost_nodes;
+    return ARRAY_SIZE(devfreq_boost_nodes);
+}
+
+/* Boot: the launch vector, until boot completes */
+static const int boot_boost_resources[] = {
+    SCHED_BOOST_ON, 0x20F, 0x101, 0x3E01, 0x4001, 0x4101, 0x4201,
+};
+
+int get_boot_boost_resources(const int **resources)
+{
+    *resources = boot_boost_resources;
+    return ARRAY_SIZE(boot_boost_resources);
+}
+
 int  power_hint_override(struct power_module *module, power_hint_t hint,
         void *data)
 {
@@ -132,14 +218,15 @@ int  power_hint_override(struct power_module *module, power_hint_t hint,
     }
 
     // Skip other hints in custom power modes
-    if (current_power_profile != PROFILE_BALANCED) {
+    if (current_power_profile != PROFILE_BALANCED &&
+            !boost_budget_layered_hint(hint)) {
         return HINT_HANDLED;
     }
 
     switch (hint) {
         case POWER_HINT_LAUNCH_BOOST:
             duration = 2000;
-            interaction(duration, ARRAY_SIZE(resources_launch_boost),
+            launch_boost(duration, ARRAY_SIZE(resources_launch_boost),
                     resources_launch_boost);
             return HINT_HANDLED;
         case POWER_HINT_CPU_BOOST:
@@ -158,69 +245,42 @@ int  power_hint_override(struct power_module *module, power_hint_t hint,
 
 int  set_interactive_override(struct power_module *module, int on)
 {
-    char governor[80];
+    const struct hint_vector *display_off;
+    int governor;
 
     ALOGI("Got set_interactive hint");
 
-    if (get_scaling_governor_check_cores(governor, sizeof(governor),CPU0) == -1) {
-        if (get_scaling_governor_check_cores(governor, sizeof(governor),CPU1) == -1) {
-            if (get_scaling_governor_check_cores(governor, sizeof(governor),CPU2) == -1) {
-                if (get_scaling_governor_check_cores(governor, sizeof(governor),CPU3) == -1) {
-                    ALOGE("Can't obtain scaling governor.");
-                    return HINT_HANDLED;
-                }
-            }
-        }
+    governor = get_scaling_governor_id();
+    if (governor == -1) {
+        ALOGE("Can't obtain scaling governor.");
+        return HINT_HANDLED;
     }
 
+    display_off = hint_table_lookup(hint_table, HINT_TYPE_DISPLAY_OFF, governor);
+    if (!display_off)
+        return HINT_HANDLED;
+
     if (!on) {
         /* Display off. */
-             if ((strncmp(governor, INTERACTIVE_GOVERNOR, strlen(INTERACTIVE_GOVERNOR)) == 0) &&
-                (strlen(governor) == strlen(INTERACTIVE_GOVERNOR))) {
-               int resource_values[] = {TR_MS_CPU0_50, TR_MS_CPU4_50};
-
-               if (!display_hint_sent) {
-                   perform_hint_action(DISPLAY_STATE_HINT_ID,
-                   resource_values, ARRAY_SIZE(resource_values));
-                  display_hint_sent = 1;
-                }
-             } /* Perf time rate set for CORE0,CORE4 8952 target*/
-
+        if (!display_hint_sent) {
+            perform_hint_vector(DISPLAY_STATE_HINT_ID, display_off);
+            display_hint_sent = 1;
+        }
     } else {
         /* Display on. */
-          if ((strncmp(governor, INTERACTIVE_GOVERNOR, strlen(INTERACTIVE_GOVERNOR)) == 0) &&
-                (strlen(governor) == strlen(INTERACTIVE_GOVERNOR))) {
-
-             undo_hint_action(DISPLAY_STATE_HINT_ID);
-             display_hint_sent = 0;
-          }
-   }
+        undo_hint_action(DISPLAY_STATE_HINT_ID);
+        display_hint_sent = 0;
+    }
     return HINT_HANDLED;
 }
 
 /* Video Encode Hint */
 static void process_video_encode_hint(void *metadata)
 {
-    char governor[80];
     struct video_encode_metadata_t video_encode_metadata;
 
     ALOGI("Got process_video_encode_hint");
 
-    if (get_scaling_governor_check_cores(governor,
-        sizeof(governor),CPU0) == -1) {
-            if (get_scaling_governor_check_cores(governor,
-                sizeof(governor),CPU1) == -1) {
-                    if (get_scaling_governor_check_cores(governor,
-                        sizeof(governor),CPU2) == -1) {
-                            if (get_scaling_governor_check_cores(governor,
-                                sizeof(governor),CPU3) == -1) {
-                                    ALOGE("Can't obtain scaling governor.");
-                                    return HINT_HANDLED;
-                            }
-                    }
-            }
-    }
-
     /* Initialize encode metadata struct fields. */
     memset(&video_encode_metadata, 0, sizeof(struct video_encode_metadata_t));
     video_encode_metadata.state = -1;
@@ -236,26 +296,8 @@ static void process_video_encode_hint(void *metadata)
         return;
     }
 
-    if (video_encode_metadata.state == 1) {
-        if ((strncmp(governor, INTERACTIVE_GOVERNOR,
-            strlen(INTERACTIVE_GOVERNOR)) == 0) &&
-            (strlen(governor) == strlen(INTERACTIVE_GOVERNOR))) {
-            int resource_values[] = {TR_MS_CPU0_30, TR_MS_CPU4_30};
-            if (!video_encode_hint_sent) {
-                perform_hint_action(video_encode_metadata.hint_id,
-                resource_values,
-                ARRAY_SIZE(resource_values));
-                video_encode_hint_sent = 1;
-            }
-        }
-    } else if (video_encode_metadata.state == 0) {
-        if ((strncmp(governor, INTERACTIVE_GOVERNOR,
-            strlen(INTERACTIVE_GOVERNOR)) == 0) &&
-            (strlen(governor) == strlen(INTERACTIVE_GOVERNOR))) {
-            undo_hint_action(video_encode_metadata.hint_id);
-            video_encode_hint_sent = 0;
-            return ;
-        }
-    }
-    return;
+    /* Repeats renew the hint, see perform_hint_action(). */
+    hint_table_dispatch(hint_table, HINT_TYPE_VIDEO_ENCODE,
+            video_encode_metadata.hint_id, video_encode_metadata.state,
+            video_encode_metadata.pid);
 }
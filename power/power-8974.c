@@ -47,10 +47,22 @@
 #include "hint-data.h"
 #include "performance.h"
 #include "power-common.h"
+#include "hint-table.h"
+#include "devfreq-boost.h"
+#include "boot-boost.h"
+#include "boost-budget.h"
+#include "launch-policy.h"
 
 static int display_hint_sent;
 static int display_hint2_sent;
 static int first_display_off_hint;
+
+static const hint_table_t hint_table = {
+    [HINT_TYPE_DISPLAY_OFF] = {
+        [GOVERNOR_ONDEMAND] = HINT_VECTOR(MS_500, SYNC_FREQ_600, OPTIMAL_FREQ_600,
+                THREAD_MIGRATION_SYNC_OFF),
+    },
+};
 extern int display_boost;
 
 static int current_power_profile = PROFILE_BALANCED;
@@ -59,6 +71,10 @@ int get_number_of_profiles() {
     return 5;
 }
 
+static int profile_power_save[] = { 0x0A03, CPUS_ONLINE_MAX_LIMIT_2,
+    CPU0_MAX_FREQ_NONTURBO_MAX, CPU1_MAX_FREQ_NONTURBO_MAX,
+    CPU2_MAX_FREQ_NONTURBO_MAX, CPU3_MAX_FREQ_NONTURBO_MAX };
+
 static void set_power_profile(int profile) {
 
     if (profile == current_power_profile)
@@ -93,19 +109,73 @@ static void set_power_profile(int profile) {
             resource_values, sizeof(resource_values)/sizeof(resource_values[0]));
         ALOGD("%s: set bias power mode", __func__);
     } else if (profile == PROFILE_POWER_SAVE) {
-        int resource_values[] = { 0x0A03, CPUS_ONLINE_MAX_LIMIT_2,
-            CPU0_MAX_FREQ_NONTURBO_MAX, CPU1_MAX_FREQ_NONTURBO_MAX,
-            CPU2_MAX_FREQ_NONTURBO_MAX, CPU3_MAX_FREQ_NONTURBO_MAX };
-        perform_hint_action(DEFAULT_PROFILE_HINT_ID,
-            resource_values, sizeof(resource_values)/sizeof(resource_values[0]));
+        perform_hint_action(DEFAULT_PROFILE_HINT_ID, profile_power_save,
+            sizeof(profile_power_save)/sizeof(profile_power_save[0]));
         ALOGD("%s: set powersave", __func__);
     }
 
     current_power_profile = profile;
 }
 
+int get_low_power_resources(int **resources)
+{
+    *resources = profile_power_save;
+    return sizeof(profile_power_save)/sizeof(profile_power_save[0]);
+}
+
 extern void interaction(int duration, int num_args, int opt_list[]);
 
+/* Adreno 330 and the CPU-DDR bus */
+static const struct devfreq_boost_node devfreq_boost_nodes[] = {
+    { "kgsl-3d0",   { "320000000", "450000000" } },
+    { "cpubw",      { "3051",      "4066" } },
+};
+
+int get_devfreq_boost_nodes(const struct devfreq_boost_node **nodes)
+{
+    *nodes = devfreq_boost_nodes;
+    return sizeof(devfreq_boost_nodes)/sizeof(devfreq_boost_nodes[0]);
+}
+
+/* Boot: every core online at its top frequency, until boot completes */
+static const int boot_boost_resources[] = {
+    CPUS_ONLINE_MIN_4,
+    CPU0_MIN_FREQ_TURBO_MAX, CPU1_MIN_FREQ_TURBO_MAX,
+    CPU2_MIN_FREQ_TURBO_MAX, CPU3_MIN_FREQ_TURBO_MAX,
+};
+
+int get_boot_boost_resources(const int **resources)
+{
+    *resources = boot_boost_resources;
+    return sizeof(boot_boost_resources)/sizeof(boot_boost_resources[0]);
+}
+
+/* Launches: two cores below turbo for light apps, all four for heavy ones */
+static int launch_light_resources[] = {
+    CPUS_ONLINE_MIN_2,
+    CPU0_MIN_FREQ_NONTURBO_MAX, CPU1_MIN_FREQ_NONTURBO_MAX,
+};
+
+static int launch_heavy_resources[] = {
+    CPUS_ONLINE_MIN_4,
+    CPU0_MIN_FREQ_TURBO_MAX, CPU1_MIN_FREQ_TURBO_MAX,
+    CPU2_MIN_FREQ_TURBO_MAX, CPU3_MIN_FREQ_TURBO_MAX,
+};
+
+int get_launch_boost_resources(int launch_class, int **resources)
+{
+    switch (launch_class) {
+    case LAUNCH_CLASS_LIGHT:
+        *resources = launch_light_resources;
+        return sizeof(launch_light_resources)/sizeof(launch_light_resources[0]);
+    case LAUNCH_CLASS_HEAVY:
+        *resources = launch_heavy_resources;
+        return sizeof(launch_heavy_resources)/sizeof(launch_heavy_resources[0]);
+    default:
+        return 0;
+    }
+}
+
 int power_hint_override(__attribute__((unused)) struct power_module *module,
         power_hint_t hint, void *data)
 {
@@ -115,8 +185,9 @@ int power_hint_override(__attribute__((unused)) struct power_module *module,
     }
 
     // Skip other hints in high/low power modes
-    if (current_power_profile == PROFILE_POWER_SAVE ||
-            current_power_profile == PROFILE_HIGH_PERFORMANCE) {
+    if ((current_power_profile == PROFILE_POWER_SAVE ||
+            current_power_profile == PROFILE_HIGH_PERFORMANCE) &&
+            !boost_budget_layered_hint(hint)) {
         return HINT_HANDLED;
     }
 
@@ -126,7 +197,7 @@ int power_hint_override(__attribute__((unused)) struct power_module *module,
             CPU0_MIN_FREQ_TURBO_MAX, CPU1_MIN_FREQ_TURBO_MAX,
             CPU2_MIN_FREQ_TURBO_MAX, CPU3_MIN_FREQ_TURBO_MAX };
 
-        interaction(duration, sizeof(resources)/sizeof(resources[0]), resources);
+        launch_boost(duration, sizeof(resources)/sizeof(resources[0]), resources);
 
         return HINT_HANDLED;
     }
@@ -147,14 +218,17 @@ int power_hint_override(__attribute__((unused)) struct power_module *module,
 
 int set_interactive_override(struct power_module *module __unused, int on)
 {
-    char governor[80];
+    const struct hint_vector *display_off;
+    int governor = get_scaling_governor_id();
 
-    if (get_scaling_governor(governor, sizeof(governor)) == -1) {
+    if (governor == -1) {
         ALOGE("Can't obtain scaling governor.");
 
         return HINT_NONE;
     }
 
+    display_off = hint_table_lookup(hint_table, HINT_TYPE_DISPLAY_OFF, governor);
+
     if (!on) {
         /* Display off. */
         /*
@@ -173,13 +247,9 @@ int set_interactive_override(struct power_module *module __unused, int on)
             }
         }
 
-        if ((strncmp(governor, ONDEMAND_GOVERNOR, strlen(ONDEMAND_GOVERNOR)) == 0) &&
-                (strlen(governor) == strlen(ONDEMAND_GOVERNOR))) {
-            int resource_values[] = {MS_500, SYNC_FREQ_600, OPTIMAL_FREQ_600, THREAD_MIGRATION_SYNC_OFF};
-
+        if (display_off) {
             if (!display_hint_sent) {
-                perform_hint_action(DISPLAY_STATE_HINT_ID,
-                        resource_values, sizeof(resource_values)/sizeof(resource_values[0]));
+                perform_hint_vector(DISPLAY_STATE_HINT_ID, display_off);
                 display_hint_sent = 1;
             }
 
@@ -194,8 +264,7 @@ int set_interactive_override(struct power_module *module __unused, int on)
             display_hint2_sent = 0;
         }
 
-        if ((strncmp(governor, ONDEMAND_GOVERNOR, strlen(ONDEMAND_GOVERNOR)) == 0) &&
-                (strlen(governor) == strlen(ONDEMAND_GOVERNOR))) {
+        if (display_off) {
             undo_hint_action(DISPLAY_STATE_HINT_ID);
             display_hint_sent = 0;
 
@@ -46,20 +46,42 @@
 #include "hint-data.h"
 #include "performance.h"
 #include "power-common.h"
+#include "hint-table.h"
+#include "core-ctl.h"
 
 static int display_hint_sent;
 
+static const hint_table_t hint_table = {
+    [HINT_TYPE_VIDEO_ENCODE] = {
+        /* sched and cpufreq params
+         * hispeed freq - 768 MHz
+         * target load - 90
+         * above_hispeed_delay - 40ms
+         * sched_small_tsk - 50
+         */
+        [GOVERNOR_INTERACTIVE] = HINT_VECTOR(0x2C07, 0x2F5A, 0x2704, 0x4032),
+    },
+    [HINT_TYPE_DISPLAY_OFF] = {
+        /* 4+0 core config in display off */
+        [GOVERNOR_INTERACTIVE] = HINT_VECTOR(0x777),
+    },
+};
+
+/* Little first, so 0x777 parks the A57s. */
+static const struct core_ctl_cluster core_ctl_clusters[] = {
+    { 0, 4 }, { 4, 2 },
+};
+
+int get_core_ctl_clusters(const struct core_ctl_cluster **clusters)
+{
+    *clusters = core_ctl_clusters;
+    return sizeof(core_ctl_clusters)/sizeof(core_ctl_clusters[0]);
+}
+
 static int process_video_encode_hint(void *metadata)
 {
-    char governor[80];
     struct video_encode_metadata_t video_encode_metadata;
 
-    if (get_scaling_governor(governor, sizeof(governor)) == -1) {
-        ALOGE("Can't obtain scaling governor.");
-
-        return HINT_NONE;
-    }
-
     /* Initialize encode metadata struct fields */
     memset(&video_encode_metadata, 0, sizeof(struct video_encode_metadata_t));
     video_encode_metadata.state = -1;
@@ -75,29 +97,9 @@ static int process_video_encode_hint(void *metadata)
         return HINT_NONE;
     }
 
-    if (video_encode_metadata.state == 1) {
-        if ((strncmp(governor, INTERACTIVE_GOVERNOR, strlen(INTERACTIVE_GOVERNOR)) == 0) &&
-                (strlen(governor) == strlen(INTERACTIVE_GOVERNOR))) {
-            /* sched and cpufreq params
-             * hispeed freq - 768 MHz
-             * target load - 90
-             * above_hispeed_delay - 40ms
-             * sched_small_tsk - 50
-             */
-            int resource_values[] = {0x2C07, 0x2F5A, 0x2704, 0x4032};
-
-            perform_hint_action(video_encode_metadata.hint_id,
-                    resource_values, sizeof(resource_values)/sizeof(resource_values[0]));
-            return HINT_HANDLED;
-        }
-    } else if (video_encode_metadata.state == 0) {
-        if ((strncmp(governor, INTERACTIVE_GOVERNOR, strlen(INTERACTIVE_GOVERNOR)) == 0) &&
-                (strlen(governor) == strlen(INTERACTIVE_GOVERNOR))) {
-            undo_hint_action(video_encode_metadata.hint_id);
-            return HINT_HANDLED;
-        }
-    }
-    return HINT_NONE;
+    return hint_table_dispatch(hint_table, HINT_TYPE_VIDEO_ENCODE,
+            video_encode_metadata.hint_id, video_encode_metadata.state,
+            video_encode_metadata.pid);
 }
 
 int power_hint_override(struct power_module *module, power_hint_t hint, void *data)
@@ -115,34 +117,31 @@ int power_hint_override(struct power_module *module, power_hint_t hint, void *da
 
 int set_interactive_override(struct power_module *module, int on)
 {
-    char governor[80];
+    const struct hint_vector *display_off;
+    int governor = get_scaling_governor_id();
 
-    if (get_scaling_governor(governor, sizeof(governor)) == -1) {
+    if (governor == -1) {
         ALOGE("Can't obtain scaling governor.");
 
         return HINT_NONE;
     }
 
+    display_off = hint_table_lookup(hint_table, HINT_TYPE_DISPLAY_OFF, governor);
+    if (!display_off)
+        return HINT_NONE;
+
     if (!on) {
         /* Display off */
-        if ((strncmp(governor, INTERACTIVE_GOVERNOR, strlen(INTERACTIVE_GOVERNOR)) == 0) &&
-            (strlen(governor) == strlen(INTERACTIVE_GOVERNOR))) {
-            int resource_values[] = {0x777}; /* 4+0 core config in display off */
-            if (!display_hint_sent) {
-                perform_hint_action(DISPLAY_STATE_HINT_ID,
-                resource_values, sizeof(resource_values)/sizeof(resource_values[0]));
-                display_hint_sent = 1;
-                return HINT_HANDLED;
-            }
+        if (!display_hint_sent) {
+            perform_hint_vector(DISPLAY_STATE_HINT_ID, display_off);
+            display_hint_sent = 1;
+            return HINT_HANDLED;
         }
     } else {
         /* Display on */
-        if ((strncmp(governor, INTERACTIVE_GOVERNOR, strlen(INTERACTIVE_GOVERNOR)) == 0) &&
-            (strlen(governor) == strlen(INTERACTIVE_GOVERNOR))) {
-            undo_hint_action(DISPLAY_STATE_HINT_ID);
-            display_hint_sent = 0;
-            return HINT_HANDLED;
-        }
+        undo_hint_action(DISPLAY_STATE_HINT_ID);
+        display_hint_sent = 0;
+        return HINT_HANDLED;
     }
     return HINT_NONE;
 }
@@ -46,15 +46,45 @@
 #include "hint-data.h"
 #include "performance.h"
 #include "power-common.h"
+#include "hint-table.h"
+#include "sustained-perf.h"
+#include "boost-placement.h"
+#include "devfreq-boost.h"
+#include "boot-boost.h"
+#include "core-ctl.h"
+#include "boost-budget.h"
+#include "launch-policy.h"
 
 static int display_hint_sent;
 
+static const hint_table_t hint_table = {
+    [HINT_TYPE_VIDEO_ENCODE] = {
+        /* sched and cpufreq params
+         * hispeed freq - 768 MHz
+         * target load - 90
+         * above_hispeed_delay - 40ms
+         * sched_small_tsk - 50
+         */
+        [GOVERNOR_INTERACTIVE] = HINT_VECTOR(0x2C07, 0x2F5A, 0x2704, 0x4032),
+    },
+    [HINT_TYPE_DISPLAY_OFF] = {
+        /* 4+0 core config in display off */
+        [GOVERNOR_INTERACTIVE] = HINT_VECTOR(0x777),
+    },
+};
+
 int get_number_of_profiles() {
-    return 5;
+    return 6;
 }
 
 static int current_power_profile = PROFILE_BALANCED;
 
+static int profile_power_save[] = { CPUS_ONLINE_MPD_OVERRIDE, 0x0A03,
+    CPU0_MAX_FREQ_NONTURBO_MAX - 2, CPU1_MAX_FREQ_NONTURBO_MAX - 2,
+    CPU2_MAX_FREQ_NONTURBO_MAX - 2, CPU3_MAX_FREQ_NONTURBO_MAX - 2,
+    CPU4_MAX_FREQ_NONTURBO_MAX - 2, CPU5_MAX_FREQ_NONTURBO_MAX - 2,
+    CPU6_MAX_FREQ_NONTURBO_MAX - 2, CPU7_MAX_FREQ_NONTURBO_MAX - 2 };
+
 static void set_power_profile(int profile) {
 
     if (profile == current_power_profile)
@@ -62,19 +92,16 @@ static void set_power_profile(int profile) {
 
     ALOGV("%s: profile=%d", __func__, profile);
 
-    if (current_power_profile != PROFILE_BALANCED) {
+    if (current_power_profile == PROFILE_SUSTAINED_PERFORMANCE) {
+        sustained_perf_stop();
+    } else if (current_power_profile != PROFILE_BALANCED) {
         undo_hint_action(DEFAULT_PROFILE_HINT_ID);
         ALOGV("%s: hint undone", __func__);
     }
 
     if (profile == PROFILE_POWER_SAVE) {
-        int resource_values[] = { CPUS_ONLINE_MPD_OVERRIDE, 0x0A03,
-            CPU0_MAX_FREQ_NONTURBO_MAX - 2, CPU1_MAX_FREQ_NONTURBO_MAX - 2,
-            CPU2_MAX_FREQ_NONTURBO_MAX - 2, CPU3_MAX_FREQ_NONTURBO_MAX - 2,
-            CPU4_MAX_FREQ_NONTURBO_MAX - 2, CPU5_MAX_FREQ_NONTURBO_MAX - 2,
-            CPU6_MAX_FREQ_NONTURBO_MAX - 2, CPU7_MAX_FREQ_NONTURBO_MAX - 2 };
-        perform_hint_action(DEFAULT_PROFILE_HINT_ID,
-            resource_values, sizeof(resource_values)/sizeof(resource_values[0]));
+        perform_hint_action(DEFAULT_PROFILE_HINT_ID, profile_power_save,
+            sizeof(profile_power_save)/sizeof(profile_power_save[0]));
         ALOGD("%s: set powersave", __func__);
     } else if (profile == PROFILE_HIGH_PERFORMANCE) {
         int resource_values[] = { SCHED_BOOST_ON, CPUS_ONLINE_MAX, 0x0901, 0x101,
@@ -101,11 +128,55 @@ static void set_power_profile(int profile) {
         perform_hint_action(DEFAULT_PROFILE_HINT_ID,
             resource_values, sizeof(resource_values)/sizeof(resource_values[0]));
         ALOGD("%s: set bias perf mode", __func__);
+    } else if (profile == PROFILE_SUSTAINED_PERFORMANCE) {
+        sustained_perf_start();
+        ALOGD("%s: set sustained perf mode", __func__);
     }
 
     current_power_profile = profile;
 }
 
+int get_low_power_resources(int **resources)
+{
+    *resources = profile_power_save;
+    return sizeof(profile_power_save)/sizeof(profile_power_save[0]);
+}
+
+static const struct sustained_cluster sustained_clusters[] = {
+    { 0, 4 }, { 4, 4 },
+};
+
+int get_sustained_perf_clusters(const struct sustained_cluster **clusters)
+{
+    *clusters = sustained_clusters;
+    return sizeof(sustained_clusters)/sizeof(sustained_clusters[0]);
+}
+
+/* Little first, so 0x777 parks the A57s. */
+static const struct core_ctl_cluster core_ctl_clusters[] = {
+    { 0, 4 }, { 4, 4 },
+};
+
+int get_core_ctl_clusters(const struct core_ctl_cluster **clusters)
+{
+    *clusters = core_ctl_clusters;
+    return sizeof(core_ctl_clusters)/sizeof(core_ctl_clusters[0]);
+}
+
+/* Let boosted foreground work onto the big cluster, and move it sooner. */
+static const struct boost_placement_node boost_placement[] = {
+    { CPUSET_PATH "foreground/cpus",        "0-7" },
+    { CPUSET_PATH "top-app/cpus",           "0-7" },
+    { SCHED_KNOB_PATH "sched_downmigrate",  "30" },
+    { SCHED_KNOB_PATH "sched_upmigrate",    "45" },
+};
+
+int get_boost_placement(const struct boost_placement_node **nodes)
+{
+    *nodes = boost_placement;
+    return sizeof(boost_placement)/sizeof(boost_placement[0]);
+}
+
 extern void interaction(int duration, int num_args, int opt_list[]);
 
 #ifdef __LP64__
@@ -116,15 +187,8 @@ typedef int hintdata;
 
 static int process_video_encode_hint(void *metadata)
 {
-    char governor[80];
     struct video_encode_metadata_t video_encode_metadata;
 
-    if (get_scaling_governor(governor, sizeof(governor)) == -1) {
-        ALOGE("Can't obtain scaling governor.");
-
-        return HINT_NONE;
-    }
-
     /* Initialize encode metadata struct fields */
     memset(&video_encode_metadata, 0, sizeof(struct video_encode_metadata_t));
     video_encode_metadata.state = -1;
@@ -140,29 +204,57 @@ static int process_video_encode_hint(void *metadata)
         return HINT_NONE;
     }
 
-    if (video_encode_metadata.state == 1) {
-        if ((strncmp(governor, INTERACTIVE_GOVERNOR, strlen(INTERACTIVE_GOVERNOR)) == 0) &&
-                (strlen(governor) == strlen(INTERACTIVE_GOVERNOR))) {
-            /* sched and cpufreq params
-             * hispeed freq - 768 MHz
-             * target load - 90
-             * above_hispeed_delay - 40ms
-             * sched_small_tsk - 50
-             */
-            int resource_values[] = {0x2C07, 0x2F5A, 0x2704, 0x4032};
-
-            perform_hint_action(video_encode_metadata.hint_id,
-                    resource_values, sizeof(resource_values)/sizeof(resource_values[0]));
-            return HINT_HANDLED;
-        }
-    } else if (video_encode_metadata.state == 0) {
-        if ((strncmp(governor, INTERACTIVE_GOVERNOR, strlen(INTERACTIVE_GOVERNOR)) == 0) &&
-                (strlen(governor) == strlen(INTERACTIVE_GOVERNOR))) {
-            undo_hint_action(video_encode_metadata.hint_id);
-            return HINT_HANDLED;
-        }
+    return hint_table_dispatch(hint_table, HINT_TYPE_VIDEO_ENCODE,
+            video_encode_metadata.hint_id, video_encode_metadata.state,
+            video_encode_metadata.pid);
+}
+
+/* Adreno 430, the CPU-DDR bus and its latency floor */
+static const struct devfreq_boost_node devfreq_boost_nodes[] = {
+    { "kgsl-3d0",   { "305000000", "450000000" } },
+    { "cpubw",      { "4577",      "7759" } },
+    { "mincpubw",   { NULL,        "1525" } },
+};
+
+int get_devfreq_boost_nodes(const struct devfreq_boost_node **nodes)
+{
+    *nodes = devfreq_boost_nodes;
+    return sizeof(devfreq_boost_nodes)/sizeof(devfreq_boost_nodes[0]);
+}
+
+/* Boot: the launch vector, until boot completes */
+static const int boot_boost_resources[] = {
+    SCHED_BOOST_ON, 0x20F, 0x101, 0x3E01,
+};
+
+int get_boot_boost_resources(const int **resources)
+{
+    *resources = boot_boost_resources;
+    return sizeof(boot_boost_resources)/sizeof(boot_boost_resources[0]);
+}
+
+/* Launches: no sched boost for light apps, the big cluster for heavy ones */
+static int launch_light_resources[] = {
+    0x20D, 0x3E01,
+};
+
+static int launch_heavy_resources[] = {
+    SCHED_BOOST_ON, 0x20F, 0x101, 0x3E01,
+    CPU4_MIN_FREQ_TURBO_MAX, CPU5_MIN_FREQ_TURBO_MAX,
+};
+
+int get_launch_boost_resources(int launch_class, int **resources)
+{
+    switch (launch_class) {
+    case LAUNCH_CLASS_LIGHT:
+        *resources = launch_light_resources;
+        return sizeof(launch_light_resources)/sizeof(launch_light_resources[0]);
+    case LAUNCH_CLASS_HEAVY:
+        *resources = launch_heavy_resources;
+        return sizeof(launch_heavy_resources)/sizeof(launch_heavy_resources[0]);
+    default:
+        return 0;
     }
-    return HINT_NONE;
 }
 
 int power_hint_override(__attribute__((unused)) struct power_module *module,
@@ -174,8 +266,10 @@ int power_hint_override(__attribute__((unused)) struct power_module *module,
     }
 
     // Skip other hints in custom power modes
-    if (current_power_profile == PROFILE_POWER_SAVE ||
-            current_power_profile == PROFILE_HIGH_PERFORMANCE) {
+    if ((current_power_profile == PROFILE_POWER_SAVE ||
+            current_power_profile == PROFILE_HIGH_PERFORMANCE ||
+            current_power_profile == PROFILE_SUSTAINED_PERFORMANCE) &&
+            !boost_budget_layered_hint(hint)) {
         return HINT_HANDLED;
     }
 
@@ -191,7 +285,7 @@ int power_hint_override(__attribute__((unused)) struct power_module *module,
         int duration = 2000;
         int resources[] = { SCHED_BOOST_ON, 0x20F, 0x101, 0x3E01 };
 
-        interaction(duration, sizeof(resources)/sizeof(resources[0]), resources);
+        launch_boost(duration, sizeof(resources)/sizeof(resources[0]), resources);
 
         return HINT_HANDLED;
     }
@@ -215,34 +309,31 @@ int power_hint_override(__attribute__((unused)) struct power_module *module,
 
 int set_interactive_override(__attribute__((unused)) struct power_module *module, int on)
 {
-    char governor[80];
+    const struct hint_vector *display_off;
+    int governor = get_scaling_governor_id();
 
-    if (get_scaling_governor(governor, sizeof(governor)) == -1) {
+    if (governor == -1) {
         ALOGE("Can't obtain scaling governor.");
 
         return HINT_NONE;
     }
 
+    display_off = hint_table_lookup(hint_table, HINT_TYPE_DISPLAY_OFF, governor);
+    if (!display_off)
+        return HINT_NONE;
+
     if (!on) {
         /* Display off */
-        if ((strncmp(governor, INTERACTIVE_GOVERNOR, strlen(INTERACTIVE_GOVERNOR)) == 0) &&
-            (strlen(governor) == strlen(INTERACTIVE_GOVERNOR))) {
-            int resource_values[] = {0x777}; /* 4+0 core config in display off */
-            if (!display_hint_sent) {
-                perform_hint_action(DISPLAY_STATE_HINT_ID,
-                resource_values, sizeof(resource_values)/sizeof(resource_values[0]));
-                display_hint_sent = 1;
-                return HINT_HANDLED;
-            }
+        if (!display_hint_sent) {
+            perform_hint_vector(DISPLAY_STATE_HINT_ID, display_off);
+            display_hint_sent = 1;
+            return HINT_HANDLED;
         }
     } else {
         /* Display on */
-        if ((strncmp(governor, INTERACTIVE_GOVERNOR, strlen(INTERACTIVE_GOVERNOR)) == 0) &&
-            (strlen(governor) == strlen(INTERACTIVE_GOVERNOR))) {
-            undo_hint_action(DISPLAY_STATE_HINT_ID);
-            display_hint_sent = 0;
-            return HINT_HANDLED;
-        }
+        undo_hint_action(DISPLAY_STATE_HINT_ID);
+        display_hint_sent = 0;
+        return HINT_HANDLED;
     }
     return HINT_NONE;
 }
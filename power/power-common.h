@@ -28,7 +28,13 @@
  */
 #define NODE_MAX (64)
 
+/* Overridable so governor detection can be pointed at a fake tree. */
+#ifndef SCALING_GOVERNOR_PATH
 #define SCALING_GOVERNOR_PATH "/sys/devices/system/cpu/cpu0/cpufreq/scaling_governor"
+#endif
+#ifndef SCALING_GOVERNOR_CPU_PATH
+#define SCALING_GOVERNOR_CPU_PATH "/sys/devices/system/cpu/cpu%d/cpufreq/scaling_governor"
+#endif
 #define DCVS_CPU0_SLACK_MAX_NODE "/sys/module/msm_dcvs/cores/cpu0/slack_time_max_us"
 #define DCVS_CPU0_SLACK_MIN_NODE "/sys/module/msm_dcvs/cores/cpu0/slack_time_min_us"
 #define MPDECISION_SLACK_MAX_NODE "/sys/module/msm_mpdecision/slack_time_max_us"
@@ -38,9 +44,20 @@
 #define ONDEMAND_GOVERNOR "ondemand"
 #define INTERACTIVE_GOVERNOR "interactive"
 #define MSMDCVS_GOVERNOR "msm-dcvs"
+#define SCHEDUTIL_GOVERNOR "schedutil"
+
+enum scaling_governor {
+    GOVERNOR_UNKNOWN = 0,
+    GOVERNOR_ONDEMAND,
+    GOVERNOR_INTERACTIVE,
+    GOVERNOR_MSMDCVS,
+    GOVERNOR_SCHEDUTIL,
+    GOVERNOR_COUNT
+};
 
 #define INTERACTIVE_PATH "/sys/devices/system/cpu/cpufreq/interactive/"
 #define ONDEMAND_PATH "/sys/devices/system/cpu/cpufreq/ondemand/"
+#define SCHEDUTIL_PATH "/sys/devices/system/cpu/cpufreq/schedutil/"
 
 #define CPU0_CPUFREQ_PATH "/sys/devices/system/cpu/cpu0/cpufreq/"
 #define CPU1_CPUFREQ_PATH "/sys/devices/system/cpu/cpu1/cpufreq/"
@@ -62,5 +79,6 @@ enum {
     PROFILE_BALANCED,
     PROFILE_HIGH_PERFORMANCE,
     PROFILE_BIAS_POWER,
-    PROFILE_BIAS_PERFORMANCE
+    PROFILE_BIAS_PERFORMANCE,
+    PROFILE_SUSTAINED_PERFORMANCE
 };
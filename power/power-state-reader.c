@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "power-state.h"
+
+/* Give up rather than spin forever on a writer that died mid-update. */
+#define SNAPSHOT_MAX_TRIES (1000)
+
+/*
+ * Map the state page, or return NULL with errno set. A file shorter
+ * than the page is refused, as touching past its end would SIGBUS:
+ * EAGAIN while the HAL is still creating it, EINVAL if it was left by
+ * a HAL with a smaller page.
+ */
+const struct power_state_page *power_state_map(void)
+{
+    struct stat st;
+    void *addr;
+    int fd;
+
+    fd = open(POWER_STATE_PATH, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return NULL;
+
+    if (fstat(fd, &st) == -1) {
+        close(fd);
+        return NULL;
+    }
+    if (st.st_size < (off_t)sizeof(struct power_state_page)) {
+        close(fd);
+        errno = st.st_size ? EINVAL : EAGAIN;
+        return NULL;
+    }
+
+    addr = mmap(NULL, sizeof(struct power_state_page), PROT_READ,
+            MAP_SHARED, fd, 0);
+    close(fd);
+
+    return addr == MAP_FAILED ? NULL : addr;
+}
+
+void power_state_unmap(const struct power_state_page *page)
+{
+    if (page)
+        munmap((void *)page, sizeof(*page));
+}
+
+/*
+ * Copy a consistent view of 'page' into 'out'. Returns 0 on success,
+ * -EAGAIN if no stable copy could be taken and -EINVAL if the page is
+ * not (yet) a state page this reader understands.
+ */
+int power_state_snapshot(const struct power_state_page *page,
+        struct power_state_page *out)
+{
+    uint32_t start, end;
+    int tries;
+
+    if (!page)
+        return -EINVAL;
+
+    /* The layout past these two is only known for this version. */
+    if (__atomic_load_n(&page->magic, __ATOMIC_RELAXED) != POWER_STATE_MAGIC ||
+            __atomic_load_n(&page->version, __ATOMIC_RELAXED) !=
+            POWER_STATE_VERSION)
+        return -EINVAL;
+
+    for (tries = 0; tries < SNAPSHOT_MAX_TRIES; tries++) {
+        start = __atomic_load_n(&page->seq, __ATOMIC_ACQUIRE);
+        if (start & 1)
+            continue;
+
+        memcpy(out, page, sizeof(*out));
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        end = __atomic_load_n(&page->seq, __ATOMIC_RELAXED);
+        if (start != end)
+            continue;
+
+        if (out->magic != POWER_STATE_MAGIC ||
+                out->version != POWER_STATE_VERSION)
+            return -EINVAL;
+        if (out->num_hints < 0 || out->num_hints > POWER_STATE_MAX_HINTS)
+            return -EINVAL;
+        if (out->num_budgets < 0 ||
+                out->num_budgets > POWER_STATE_MAX_BUDGETS)
+            return -EINVAL;
+        if (out->num_reaper < 0 || out->num_reaper > POWER_STATE_MAX_REAPER)
+            return -EINVAL;
+
+        return 0;
+    }
+
+    return -EAGAIN;
+}
@@ -0,0 +1,275 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_NIDEBUG 0
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define LOG_TAG "QCOM PowerHAL"
+#include <utils/Log.h>
+
+#include "power-common.h"
+#include "power-timer.h"
+#include "power-state.h"
+
+/* Retry interval while /data is not mounted yet */
+#define STATE_INIT_RETRY_MS     (1000)
+
+static pthread_mutex_t state_mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct power_state_page *page;
+static long long next_init_ms;
+
+/*
+ * What the page should say. Updates land here first, so that nothing
+ * sent before the page could be set up is lost once it is.
+ */
+static struct power_state_page state = {
+    .magic = POWER_STATE_MAGIC,
+    .version = POWER_STATE_VERSION,
+    .profile = PROFILE_BALANCED,
+    .display_on = -1,
+    .budget = -1,
+    .pm_qos = { .latency_us = -1 },
+};
+
+/* Map the page. /data may not be mounted yet; try again later if not. */
+static int state_init_locked(void)
+{
+    long long now = power_timer_now_ms();
+    void *addr;
+    int fd;
+
+    if (now < next_init_ms)
+        return -1;
+    next_init_ms = now + STATE_INIT_RETRY_MS;
+
+    mkdir("/data/misc/power", 0771);
+
+    /* Don't truncate: readers of a previous instance keep their mapping. */
+    fd = open(POWER_STATE_PATH, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        ALOGE("Unable to open %s: %s", POWER_STATE_PATH, strerror(errno));
+        return -1;
+    }
+
+    if (ftruncate(fd, sizeof(*page)) == -1) {
+        ALOGE("Unable to size %s: %s", POWER_STATE_PATH, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    addr = mmap(NULL, sizeof(*page), PROT_READ | PROT_WRITE, MAP_SHARED,
+            fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        ALOGE("Unable to map %s: %s", POWER_STATE_PATH, strerror(errno));
+        return -1;
+    }
+
+    page = addr;
+    return 0;
+}
+
+static struct power_state_page *write_begin(void)
+{
+    pthread_mutex_lock(&state_mutex);
+
+    return &state;
+}
+
+/* Copy the state out under the seqlock, keeping seq moving forward. */
+static void write_end(void)
+{
+    uint32_t seq;
+
+    if (page || state_init_locked() == 0) {
+        seq = page->seq | 1;
+        __atomic_store_n(&page->seq, seq, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        state.seq = seq;
+        memcpy(page, &state, sizeof(state));
+        __atomic_store_n(&page->seq, seq + 1, __ATOMIC_RELEASE);
+    }
+
+    pthread_mutex_unlock(&state_mutex);
+}
+
+void power_state_set_profile(int profile)
+{
+    struct power_state_page *p = write_begin();
+
+    p->profile = profile;
+    write_end();
+}
+
+void power_state_set_display(int on)
+{
+    struct power_state_page *p = write_begin();
+
+    p->display_on = !!on;
+    write_end();
+}
+
+void power_state_set_low_power(int on)
+{
+    struct power_state_page *p = write_begin();
+
+    p->low_power = !!on;
+    write_end();
+}
+
+void power_state_boost(int duration_ms)
+{
+    struct power_state_page *p = write_begin();
+    long long now = power_timer_now_ms();
+
+    p->last_boost_ms = now;
+    if (now + duration_ms > p->boost_expiry_ms)
+        p->boost_expiry_ms = now + duration_ms;
+    write_end();
+}
+
+void power_state_add_hint(int hint_id, int64_t expiry_ms)
+{
+    struct power_state_page *p = write_begin();
+    int i;
+
+    for (i = 0; i < p->num_hints; i++) {
+        if (p->hints[i].hint_id == hint_id)
+            break;
+    }
+
+    if (i < POWER_STATE_MAX_HINTS) {
+        p->hints[i].hint_id = hint_id;
+        p->hints[i].expiry_ms = expiry_ms;
+        if (i == p->num_hints)
+            p->num_hints++;
+    }
+    write_end();
+}
+
+void power_state_remove_hint(int hint_id)
+{
+    struct power_state_page *p = write_begin();
+    int i;
+
+    for (i = 0; i < p->num_hints; i++) {
+        if (p->hints[i].hint_id == hint_id) {
+            p->hints[i] = p->hints[--p->num_hints];
+            memset(&p->hints[p->num_hints], 0, sizeof(p->hints[0]));
+            break;
+        }
+    }
+    write_end();
+}
+
+void power_state_set_budget(int budget, const struct power_state_budget *stats)
+{
+    struct power_state_page *p = write_begin();
+
+    if (budget >= 0 && budget < POWER_STATE_MAX_BUDGETS) {
+        p->budget = budget;
+        p->budgets[budget] = *stats;
+        if (budget >= p->num_budgets)
+            p->num_budgets = budget + 1;
+    }
+    write_end();
+}
+
+void power_state_set_reaper(int hint_id, unsigned long renewals,
+        unsigned long reaped)
+{
+    struct power_state_page *p = write_begin();
+    int i;
+
+    for (i = 0; i < p->num_reaper; i++) {
+        if (p->reaper[i].hint_id == hint_id)
+            break;
+    }
+
+    if (i < POWER_STATE_MAX_REAPER) {
+        p->reaper[i].hint_id = hint_id;
+        p->reaper[i].renewals = renewals;
+        p->reaper[i].reaped = reaped;
+        if (i == p->num_reaper)
+            p->num_reaper++;
+    }
+    write_end();
+}
+
+void power_state_set_boot_boost(int state, int64_t start_ms, int64_t held_ms)
+{
+    struct power_state_page *p = write_begin();
+
+    p->boot_boost_state = state;
+    p->boot_boost_start_ms = start_ms;
+    p->boot_boost_held_ms = held_ms;
+    write_end();
+}
+
+void power_state_set_launch(const struct power_state_launch *stats)
+{
+    struct power_state_page *p = write_begin();
+
+    p->launch = *stats;
+    write_end();
+}
+
+void power_state_set_core_ctl(const struct power_state_core_ctl *stats)
+{
+    struct power_state_page *p = write_begin();
+
+    p->core_ctl = *stats;
+    write_end();
+}
+
+void power_state_set_perflock(const struct power_state_perflock *stats)
+{
+    struct power_state_page *p = write_begin();
+
+    p->perflock = *stats;
+    write_end();
+}
+
+void power_state_set_cpufreq(const struct power_state_cpufreq *stats)
+{
+    struct power_state_page *p = write_begin();
+
+    p->cpufreq = *stats;
+    write_end();
+}
+
+void power_state_set_pm_qos(const struct power_state_pm_qos *stats)
+{
+    struct power_state_page *p = write_begin();
+
+    p->pm_qos = *stats;
+    write_end();
+}
+
+void power_state_set_vsync(const struct power_state_vsync *stats)
+{
+    struct power_state_page *p = write_begin();
+
+    p->vsync = *stats;
+    write_end();
+}
@@ -0,0 +1,198 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _QCOM_POWER_STATE_H
+#define _QCOM_POWER_STATE_H
+
+#include <stdint.h>
+
+/*
+ * State page published by the power HAL. The HAL is the only writer;
+ * readers mmap the file read-only and take snapshots under the seqlock
+ * with power_state_snapshot(). All times are CLOCK_MONOTONIC in ms.
+ */
+#define POWER_STATE_PATH        "/data/misc/power/state"
+#define POWER_STATE_MAGIC       (0x53525750) /* "PWRS" */
+#define POWER_STATE_VERSION     (10)
+#define POWER_STATE_MAX_HINTS   (16)
+/* One per power profile, then battery saver; see boost-budget.h */
+#define POWER_STATE_MAX_BUDGETS (8)
+#define POWER_STATE_MAX_REAPER  (16)
+#define POWER_STATE_MAX_CLUSTERS (2)
+
+struct power_state_hint {
+    int32_t hint_id;
+    int32_t reserved;
+    /* 0 while the hint is held until it is undone */
+    int64_t expiry_ms;
+};
+
+/* Boost budget counters since boot */
+struct power_state_budget {
+    /* Time left in the bucket, -1 if unbudgeted */
+    int32_t tokens_ms;
+    uint32_t granted;
+    /* Granted, but shorter than asked for */
+    uint32_t clamped;
+    uint32_t denied;
+    int64_t consumed_ms;
+};
+
+/* Renewals and reaps of a hint id since boot, see utils.c */
+struct power_state_reaper {
+    int32_t hint_id;
+    uint32_t renewals;
+    uint32_t reaped;
+    int32_t reserved;
+};
+
+/* Launch policy counters since boot, see launch-policy.h */
+struct power_state_launch {
+    uint32_t lookups;
+    uint32_t table_hits;
+    uint32_t learned_hits;
+    uint32_t skipped;
+    uint32_t learned;
+    uint32_t evictions;
+};
+
+/* Native core count manager, see core-ctl.c */
+struct power_state_core_ctl {
+    uint32_t requests;
+    uint32_t transitions;
+    /* In the minute up to the last transition */
+    uint32_t transitions_per_min;
+    /* CPUs online after the last transition */
+    uint32_t online_mask;
+    /* 0 before the first transition */
+    int64_t last_transition_ms;
+    int32_t num_clusters;
+    int32_t reserved;
+    /* Applied limits per cluster */
+    int32_t min_cpus[POWER_STATE_MAX_CLUSTERS];
+    int32_t max_cpus[POWER_STATE_MAX_CLUSTERS];
+};
+
+/* Perf daemon restarts and lock recovery, see perflock-monitor.c */
+struct power_state_perflock {
+    /* 0 while the daemon isn't known */
+    int32_t daemon_pid;
+    uint32_t probes;
+    uint32_t restarts;
+    uint32_t failed_releases;
+    uint32_t recoveries;
+    uint32_t locks_reacquired;
+};
+
+/* cpufreq node writes, see cpufreq-policy.c */
+struct power_state_cpufreq {
+    uint32_t writes;
+    /* No CPU of the policy was online */
+    uint32_t deferred;
+    /* Nodes rewritten because a CPU came online */
+    uint32_t replays;
+    uint32_t replay_failures;
+};
+
+/* cpu_dma_latency votes, see pm-qos.c */
+struct power_state_pm_qos {
+    /* Votes cast, timed or held */
+    uint32_t votes;
+    /* Times the request went from idle to active */
+    uint32_t requests;
+    /* Latency values written to an open request */
+    uint32_t updates;
+    uint32_t failures;
+    /* Current request in us, -1 if none is held */
+    int32_t latency_us;
+    int32_t reserved;
+};
+
+/* Vsync boost counters since boot, see vsync-boost.h */
+struct power_state_vsync {
+    uint32_t bursts;
+    /* Bursts that had to take a new lock / found the hold-off one */
+    uint32_t cold_starts;
+    uint32_t warm_starts;
+    uint32_t acquires;
+    uint32_t releases;
+    uint32_t reserved;
+    /* Time spent holding released locks */
+    int64_t boosted_ms;
+};
+
+/* Every field is naturally aligned so 32 and 64-bit readers agree. */
+struct power_state_page {
+    uint32_t magic;
+    uint32_t version;
+    /* Odd while an update is in progress */
+    uint32_t seq;
+    int32_t profile;
+    /* -1 until the first set_interactive() */
+    int32_t display_on;
+    int32_t low_power;
+    int64_t last_boost_ms;
+    int64_t boost_expiry_ms;
+    int32_t num_hints;
+    int32_t reserved;
+    struct power_state_hint hints[POWER_STATE_MAX_HINTS];
+    /* Budget in force, -1 before the first boost */
+    int32_t budget;
+    int32_t num_budgets;
+    struct power_state_budget budgets[POWER_STATE_MAX_BUDGETS];
+    int32_t num_reaper;
+    int32_t reserved2;
+    struct power_state_reaper reaper[POWER_STATE_MAX_REAPER];
+    /* enum boot_boost_state, see boot-boost.h */
+    int32_t boot_boost_state;
+    int32_t reserved3;
+    int64_t boot_boost_start_ms;
+    /* 0 while the boost is held */
+    int64_t boot_boost_held_ms;
+    struct power_state_launch launch;
+    struct power_state_core_ctl core_ctl;
+    struct power_state_perflock perflock;
+    struct power_state_cpufreq cpufreq;
+    struct power_state_pm_qos pm_qos;
+    struct power_state_vsync vsync;
+};
+
+/* Writer side, used by the HAL itself. */
+void power_state_set_profile(int profile);
+void power_state_set_display(int on);
+void power_state_set_low_power(int on);
+void power_state_boost(int duration_ms);
+void power_state_add_hint(int hint_id, int64_t expiry_ms);
+void power_state_remove_hint(int hint_id);
+void power_state_set_budget(int budget, const struct power_state_budget *stats);
+void power_state_set_reaper(int hint_id, unsigned long renewals,
+        unsigned long reaped);
+void power_state_set_boot_boost(int state, int64_t start_ms,
+        int64_t held_ms);
+void power_state_set_launch(const struct power_state_launch *stats);
+void power_state_set_core_ctl(const struct power_state_core_ctl *stats);
+void power_state_set_perflock(const struct power_state_perflock *stats);
+void power_state_set_cpufreq(const struct power_state_cpufreq *stats);
+void power_state_set_pm_qos(const struct power_state_pm_qos *stats);
+void power_state_set_vsync(const struct power_state_vsync *stats);
+
+/* Reader side, provided by libqcompowerstate. */
+const struct power_state_page *power_state_map(void);
+void power_state_unmap(const struct power_state_page *page);
+int power_state_snapshot(const struct power_state_page *page,
+        struct power_state_page *out);
+
+#endif
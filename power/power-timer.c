@@ -0,0 +1,239 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_NIDEBUG 0
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+
+#define LOG_TAG "QCOM PowerHAL"
+#include <utils/Log.h>
+
+#include "power-timer.h"
+
+static pthread_mutex_t timer_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t timer_once = PTHREAD_ONCE_INIT;
+static struct power_timer *timer_list_head;
+static int timer_fd = -1;
+
+long long power_timer_now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* Program the timerfd for the head of the list. Called with timer_mutex held. */
+static void rearm_timerfd(void)
+{
+    struct itimerspec its;
+
+    if (timer_fd < 0)
+        return;
+
+    memset(&its, 0, sizeof(its));
+
+    if (timer_list_head) {
+        /* A zero it_value disarms the fd, so never pass an exact 0. */
+        long long deadline_ms = timer_list_head->deadline_ms > 0 ?
+                timer_list_head->deadline_ms : 1;
+
+        its.it_value.tv_sec = deadline_ms / 1000;
+        its.it_value.tv_nsec = (deadline_ms % 1000) * 1000000;
+    }
+
+    if (timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &its, NULL) == -1)
+        ALOGE("Failed to program timerfd: %s", strerror(errno));
+}
+
+/* Unlink 'timer' from the pending list. Called with timer_mutex held. */
+static void unlink_timer(struct power_timer *timer)
+{
+    struct power_timer **link = &timer_list_head;
+
+    while (*link) {
+        if (*link == timer) {
+            *link = timer->next;
+            break;
+        }
+        link = &(*link)->next;
+    }
+
+    timer->next = NULL;
+    timer->armed = 0;
+}
+
+static void *timer_thread(__attribute__((unused)) void *arg)
+{
+    uint64_t expirations;
+
+    for (;;) {
+        if (read(timer_fd, &expirations, sizeof(expirations)) < 0 &&
+                errno != EAGAIN && errno != EINTR) {
+            ALOGE("Timer thread read failed: %s", strerror(errno));
+            break;
+        }
+
+        /*
+         * Pop expired timers one at a time and drop the lock around
+         * each callback, so callbacks (or other threads) are free to
+         * re-arm any timer, including one that expired in this pass.
+         */
+        pthread_mutex_lock(&timer_mutex);
+        while (timer_list_head &&
+                timer_list_head->deadline_ms <= power_timer_now_ms()) {
+            struct power_timer *timer = timer_list_head;
+            void (*callback)(void *data) = timer->callback;
+            void *data = timer->data;
+
+            unlink_timer(timer);
+
+            pthread_mutex_unlock(&timer_mutex);
+            callback(data);
+            pthread_mutex_lock(&timer_mutex);
+        }
+        rearm_timerfd();
+        pthread_mutex_unlock(&timer_mutex);
+    }
+
+    return NULL;
+}
+
+static void timer_thread_start(void)
+{
+    pthread_attr_t attr;
+    pthread_t thread;
+
+    timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (timer_fd < 0) {
+        ALOGE("Failed to create timerfd: %s", strerror(errno));
+        return;
+    }
+
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    if (pthread_create(&thread, &attr, timer_thread, NULL)) {
+        ALOGE("Failed to start timer thread.");
+        close(timer_fd);
+        timer_fd = -1;
+    }
+    pthread_attr_destroy(&attr);
+}
+
+void power_timer_init(struct power_timer *timer,
+        void (*callback)(void *data), void *data)
+{
+    memset(timer, 0, sizeof(*timer));
+    timer->callback = callback;
+    timer->data = data;
+}
+
+/* Queue 'timer' for deadline_ms. Called with timer_mutex held. */
+static void arm_locked(struct power_timer *timer, long long deadline_ms)
+{
+    struct power_timer **link;
+
+    if (timer->armed)
+        unlink_timer(timer);
+
+    timer->deadline_ms = deadline_ms;
+    timer->armed = 1;
+
+    /* Keep the list sorted by deadline; equal deadlines fire in order. */
+    link = &timer_list_head;
+    while (*link && (*link)->deadline_ms <= timer->deadline_ms)
+        link = &(*link)->next;
+    timer->next = *link;
+    *link = timer;
+
+    if (timer_list_head == timer)
+        rearm_timerfd();
+}
+
+/*
+ * (Re)arm 'timer' to fire once, 'timeout_ms' from now. Arming an
+ * already pending timer moves its deadline.
+ */
+int power_timer_arm(struct power_timer *timer, int timeout_ms)
+{
+    pthread_once(&timer_once, timer_thread_start);
+    if (timer_fd < 0)
+        return -1;
+
+    if (timeout_ms < 0)
+        timeout_ms = 0;
+
+    pthread_mutex_lock(&timer_mutex);
+    arm_locked(timer, power_timer_now_ms() + timeout_ms);
+    pthread_mutex_unlock(&timer_mutex);
+
+    return 0;
+}
+
+/*
+ * As power_timer_arm(), but a pending deadline is only ever pushed out:
+ * a shorter request does not cut a longer one short.
+ */
+int power_timer_extend(struct power_timer *timer, int timeout_ms)
+{
+    long long deadline_ms;
+
+    pthread_once(&timer_once, timer_thread_start);
+    if (timer_fd < 0)
+        return -1;
+
+    if (timeout_ms < 0)
+        timeout_ms = 0;
+
+    pthread_mutex_lock(&timer_mutex);
+    deadline_ms = power_timer_now_ms() + timeout_ms;
+    if (!timer->armed || timer->deadline_ms < deadline_ms)
+        arm_locked(timer, deadline_ms);
+    pthread_mutex_unlock(&timer_mutex);
+
+    return 0;
+}
+
+void power_timer_cancel(struct power_timer *timer)
+{
+    pthread_mutex_lock(&timer_mutex);
+    if (timer->armed) {
+        int was_head = (timer_list_head == timer);
+
+        unlink_timer(timer);
+        if (was_head)
+            rearm_timerfd();
+    }
+    pthread_mutex_unlock(&timer_mutex);
+}
+
+int power_timer_pending(struct power_timer *timer)
+{
+    int armed;
+
+    pthread_mutex_lock(&timer_mutex);
+    armed = timer->armed;
+    pthread_mutex_unlock(&timer_mutex);
+
+    return armed;
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _QCOM_POWER_TIMER_H
+#define _QCOM_POWER_TIMER_H
+
+/*
+ * One-shot timers serviced by a single timerfd-driven thread.
+ *
+ * Timers are owned by the caller (usually a static struct) and are
+ * never allocated here. Callbacks run on the timer thread without any
+ * timer lock held, so they may re-arm or cancel any timer, but they
+ * must take whatever lock protects the state they touch. A callback
+ * may still run shortly after power_timer_cancel() returns if it had
+ * already fired; callers recheck their own state in the callback.
+ */
+struct power_timer {
+    struct power_timer *next;
+    long long deadline_ms;
+    int armed;
+    void (*callback)(void *data);
+    void *data;
+};
+
+void power_timer_init(struct power_timer *timer,
+        void (*callback)(void *data), void *data);
+int power_timer_arm(struct power_timer *timer, int timeout_ms);
+int power_timer_extend(struct power_timer *timer, int timeout_ms);
+void power_timer_cancel(struct power_timer *timer);
+int power_timer_pending(struct power_timer *timer);
+
+long long power_timer_now_ms(void);
+
+#endif
@@ -49,15 +49,37 @@
 #include "hint-data.h"
 #include "performance.h"
 #include "power-common.h"
+#include "hint-table.h"
+#include "governor-tunables.h"
+#include "schedutil.h"
 #include "power-feature.h"
+#include "power-state.h"
+#include "vsync-boost.h"
+#include "boot-boost.h"
+#include "socinfo.h"
+#include "sysfs-snapshot.h"
+#include "pm-qos.h"
+#include "boost-budget.h"
+#include "launch-policy.h"
+#include "boost-policy.h"
+
+#define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
+
+static struct sysfs_snapshot display_off_snapshot;
+
+/* Ten times the slack: the CPUs ramp more lazily with the display off. */
+static const struct sysfs_transform msmdcvs_display_off[] = {
+    { DCVS_CPU0_SLACK_MAX_NODE, SYSFS_TRANSFORM_SCALE, 10, 0 },
+    { DCVS_CPU0_SLACK_MIN_NODE, SYSFS_TRANSFORM_SCALE, 10, 0 },
+    { MPDECISION_SLACK_MAX_NODE, SYSFS_TRANSFORM_SCALE, 10, 0 },
+    { MPDECISION_SLACK_MIN_NODE, SYSFS_TRANSFORM_SCALE, 10, 0 },
+};
 
-static int saved_dcvs_cpu0_slack_max = -1;
-static int saved_dcvs_cpu0_slack_min = -1;
-static int saved_mpdecision_slack_max = -1;
-static int saved_mpdecision_slack_min = -1;
-static int saved_interactive_mode = -1;
-static int slack_node_rw_failed = 0;
 static int display_hint_sent;
+static int audio_qos_held;
+static int low_power_mode;
+static int low_power_hint_sent;
+static int user_power_profile = PROFILE_BALANCED;
 int display_boost;
 
 static struct hw_module_methods_t power_module_methods = {
@@ -66,38 +88,44 @@ static struct hw_module_methods_t power_module_methods = {
 
 static pthread_mutex_t hint_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+static const hint_table_t hint_table = {
+    [HINT_TYPE_VIDEO_ENCODE] = {
+        [GOVERNOR_ONDEMAND] = HINT_VECTOR(IO_BUSY_OFF, SAMPLING_DOWN_FACTOR_1,
+                THREAD_MIGRATION_SYNC_OFF),
+        [GOVERNOR_INTERACTIVE] = HINT_VECTOR(TR_MS_30, HISPEED_LOAD_90,
+                HS_FREQ_1026, THREAD_MIGRATION_SYNC_OFF, INTERACTIVE_IO_BUSY_OFF),
+    },
+    [HINT_TYPE_VIDEO_DECODE] = {
+        [GOVERNOR_ONDEMAND] = HINT_VECTOR(THREAD_MIGRATION_SYNC_OFF),
+        [GOVERNOR_INTERACTIVE] = HINT_VECTOR(TR_MS_30, HISPEED_LOAD_90,
+                HS_FREQ_1026, THREAD_MIGRATION_SYNC_OFF),
+    },
+    [HINT_TYPE_DISPLAY_OFF] = {
+        [GOVERNOR_ONDEMAND] = HINT_VECTOR(DISPLAY_OFF, MS_500,
+                THREAD_MIGRATION_SYNC_OFF),
+        [GOVERNOR_INTERACTIVE] = HINT_VECTOR(TR_MS_50, THREAD_MIGRATION_SYNC_OFF),
+    },
+};
+
 static void power_init(__attribute__((unused))struct power_module *module)
 {
     ALOGI("QCOM power HAL initing.");
 
-    int fd;
-    char buf[10] = {0};
-
-    fd = open("/sys/devices/soc0/soc_id", O_RDONLY);
-    if (fd >= 0) {
-        if (read(fd, buf, sizeof(buf) - 1) == -1) {
-            ALOGW("Unable to read soc_id");
-        } else {
-            int soc_id = atoi(buf);
-            if (soc_id == 194 || (soc_id >= 208 && soc_id <= 218) || soc_id == 178) {
-                display_boost = 1;
-            }
-        }
-        close(fd);
+    int family = socinfo_get()->family;
+
+    if (family == SOC_FAMILY_MSM8974PRO || family == SOC_FAMILY_APQ8084) {
+        display_boost = 1;
     }
+
+    governor_tunables_init();
+    launch_policy_init();
+    boot_boost_start();
 }
 
 static void process_video_decode_hint(void *metadata)
 {
-    char governor[80];
     struct video_decode_metadata_t video_decode_metadata;
 
-    if (get_scaling_governor(governor, sizeof(governor)) == -1) {
-        ALOGE("Can't obtain scaling governor.");
-
-        return;
-    }
-
     if (metadata) {
         ALOGI("Processing video decode hint. Metadata: %s", (char *)metadata);
     }
@@ -117,41 +145,15 @@ static void process_video_decode_hint(void *metadata)
         return;
     }
 
-    if (video_decode_metadata.state == 1) {
-        if ((strncmp(governor, ONDEMAND_GOVERNOR, strlen(ONDEMAND_GOVERNOR)) == 0) &&
-                (strlen(governor) == strlen(ONDEMAND_GOVERNOR))) {
-            int resource_values[] = {THREAD_MIGRATION_SYNC_OFF};
-
-            perform_hint_action(video_decode_metadata.hint_id,
-                    resource_values, sizeof(resource_values)/sizeof(resource_values[0]));
-        } else if ((strncmp(governor, INTERACTIVE_GOVERNOR, strlen(INTERACTIVE_GOVERNOR)) == 0) &&
-                (strlen(governor) == strlen(INTERACTIVE_GOVERNOR))) {
-            int resource_values[] = {TR_MS_30, HISPEED_LOAD_90, HS_FREQ_1026, THREAD_MIGRATION_SYNC_OFF};
-
-            perform_hint_action(video_decode_metadata.hint_id,
-                    resource_values, sizeof(resource_values)/sizeof(resource_values[0]));
-        }
-    } else if (video_decode_metadata.state == 0) {
-        if ((strncmp(governor, ONDEMAND_GOVERNOR, strlen(ONDEMAND_GOVERNOR)) == 0) &&
-                (strlen(governor) == strlen(ONDEMAND_GOVERNOR))) {
-        } else if ((strncmp(governor, INTERACTIVE_GOVERNOR, strlen(INTERACTIVE_GOVERNOR)) == 0) &&
-                (strlen(governor) == strlen(INTERACTIVE_GOVERNOR))) {
-            undo_hint_action(video_decode_metadata.hint_id);
-        }
-    }
+    hint_table_dispatch(hint_table, HINT_TYPE_VIDEO_DECODE,
+            video_decode_metadata.hint_id, video_decode_metadata.state,
+            video_decode_metadata.pid);
 }
 
 static void process_video_encode_hint(void *metadata)
 {
-    char governor[80];
     struct video_encode_metadata_t video_encode_metadata;
 
-    if (get_scaling_governor(governor, sizeof(governor)) == -1) {
-        ALOGE("Can't obtain scaling governor.");
-
-        return;
-    }
-
     /* Initialize encode metadata struct fields. */
     memset(&video_encode_metadata, 0, sizeof(struct video_encode_metadata_t));
     video_encode_metadata.state = -1;
@@ -167,30 +169,9 @@ static void process_video_encode_hint(void *metadata)
         return;
     }
 
-    if (video_encode_metadata.state == 1) {
-        if ((strncmp(governor, ONDEMAND_GOVERNOR, strlen(ONDEMAND_GOVERNOR)) == 0) &&
-                (strlen(governor) == strlen(ONDEMAND_GOVERNOR))) {
-            int resource_values[] = {IO_BUSY_OFF, SAMPLING_DOWN_FACTOR_1, THREAD_MIGRATION_SYNC_OFF};
-
-            perform_hint_action(video_encode_metadata.hint_id,
-                resource_values, sizeof(resource_values)/sizeof(resource_values[0]));
-        } else if ((strncmp(governor, INTERACTIVE_GOVERNOR, strlen(INTERACTIVE_GOVERNOR)) == 0) &&
-                (strlen(governor) == strlen(INTERACTIVE_GOVERNOR))) {
-            int resource_values[] = {TR_MS_30, HISPEED_LOAD_90, HS_FREQ_1026, THREAD_MIGRATION_SYNC_OFF,
-                INTERACTIVE_IO_BUSY_OFF};
-
-            perform_hint_action(video_encode_metadata.hint_id,
-                    resource_values, sizeof(resource_values)/sizeof(resource_values[0]));
-        }
-    } else if (video_encode_metadata.state == 0) {
-        if ((strncmp(governor, ONDEMAND_GOVERNOR, strlen(ONDEMAND_GOVERNOR)) == 0) &&
-                (strlen(governor) == strlen(ONDEMAND_GOVERNOR))) {
-            undo_hint_action(video_encode_metadata.hint_id);
-        } else if ((strncmp(governor, INTERACTIVE_GOVERNOR, strlen(INTERACTIVE_GOVERNOR)) == 0) &&
-                (strlen(governor) == strlen(INTERACTIVE_GOVERNOR))) {
-            undo_hint_action(video_encode_metadata.hint_id);
-        }
-    }
+    hint_table_dispatch(hint_table, HINT_TYPE_VIDEO_ENCODE,
+            video_encode_metadata.hint_id, video_encode_metadata.state,
+            video_encode_metadata.pid);
 }
 
 int __attribute__ ((weak)) power_hint_override(
@@ -201,13 +182,108 @@ int __attribute__ ((weak)) power_hint_override(
     return HINT_NONE;
 }
 
-extern void interaction(int duration, int num_args, int opt_list[]);
+int __attribute__ ((weak)) get_low_power_resources(
+        __attribute__((unused)) int **resources)
+{
+    return 0;
+}
+
+/*
+ * Battery saver stacks on top of the user-selected profile: power-leaning
+ * profiles keep their own caps, while performance-leaning ones drop back
+ * to balanced until battery saver is turned off again.
+ */
+static int effective_power_profile(int profile)
+{
+    return boost_policy_profile(profile, low_power_mode);
+}
+
+static void set_low_power_mode_locked(struct power_module *module, int on)
+{
+    int old_profile = effective_power_profile(user_power_profile);
+    int new_profile;
+
+    if (on == low_power_mode)
+        return;
+
+    ALOGI("%s low power mode", on ? "Entering" : "Leaving");
+
+    low_power_mode = on;
+    boost_budget_set_low_power(on);
+
+    power_state_set_low_power(on);
+
+    new_profile = effective_power_profile(user_power_profile);
+    if (new_profile != old_profile) {
+        power_hint_override(module, POWER_HINT_SET_PROFILE, &new_profile);
+        power_state_set_profile(new_profile);
+        boost_budget_set_profile(new_profile);
+    }
+
+    if (on) {
+        int *resources;
+        int num_resources = get_low_power_resources(&resources);
+
+        if (num_resources > 0 && !low_power_hint_sent) {
+            perform_hint_action(DEFAULT_LOW_POWER_HINT_ID,
+                    resources, num_resources);
+            low_power_hint_sent = 1;
+        }
+    } else if (low_power_hint_sent) {
+        undo_hint_action(DEFAULT_LOW_POWER_HINT_ID);
+        low_power_hint_sent = 0;
+    }
+}
 
 static void power_hint(__attribute__((unused)) struct power_module *module, power_hint_t hint,
         void *data)
 {
     pthread_mutex_lock(&hint_mutex);
 
+    /*
+     * Battery saver must be seen even when a backend swallows hints
+     * in its custom profiles, so it is handled before the override.
+     */
+    if (hint == POWER_HINT_LOW_POWER) {
+        set_low_power_mode_locked(module, data != NULL);
+        goto out;
+    }
+
+    /*
+     * Low-latency audio holds a wakeup latency vote for as long as it
+     * runs, whatever the governor; data is non-NULL while it does.
+     */
+    if (hint == POWER_HINT_AUDIO && !!data != audio_qos_held) {
+        audio_qos_held = !!data;
+        if (audio_qos_held)
+            pm_qos_vote(PM_QOS_VOTE_AUDIO, 0);
+        else
+            pm_qos_unvote(PM_QOS_VOTE_AUDIO);
+    }
+
+    if (hint == POWER_HINT_SET_PROFILE && data) {
+        int32_t profile;
+
+        user_power_profile = *(int32_t *)data;
+        profile = effective_power_profile(user_power_profile);
+        power_hint_override(module, hint, &profile);
+        power_state_set_profile(profile);
+        boost_budget_set_profile(profile);
+        goto out;
+    }
+
+    /* Per-package launch policy, for whichever path boosts the launch */
+    if (hint == POWER_HINT_LAUNCH_BOOST &&
+            launch_policy_begin(data) == LAUNCH_CLASS_SKIP)
+        goto out;
+
+    /*
+     * The backends' vectors are written for interactive and ondemand;
+     * under schedutil, hints are driven directly instead.
+     */
+    if (schedutil_power_hint(hint, data) == HINT_HANDLED)
+        goto out;
+
     /* Check if this hint has been overridden. */
     if (power_hint_override(module, hint, data) == HINT_HANDLED) {
         /* The power_hint has been handled. We can skip the rest. */
@@ -216,6 +292,9 @@ static void power_hint(__attribute__((unused)) struct power_module *module, powe
 
     switch(hint) {
         case POWER_HINT_VSYNC:
+            /* No frame boost in battery saver; treat it as vsync-off. */
+            vsync_boost_hint(data != NULL && !low_power_mode);
+        break;
         case POWER_HINT_INTERACTION:
         case POWER_HINT_CPU_BOOST:
         case POWER_HINT_LAUNCH_BOOST:
@@ -249,16 +328,29 @@ int __attribute__ ((weak)) get_number_of_profiles()
     return 0;
 }
 
+/*
+ * Nodes to retune while the display is off, for governors without a
+ * DISPLAY_OFF hint vector. They are put back when it comes on.
+ */
+int __attribute__ ((weak)) get_display_off_transforms(int governor,
+        const struct sysfs_transform **transforms)
+{
+    if (governor != GOVERNOR_MSMDCVS)
+        return 0;
+
+    *transforms = msmdcvs_display_off;
+    return ARRAY_SIZE(msmdcvs_display_off);
+}
+
 #ifdef SET_INTERACTIVE_EXT
 extern void cm_power_set_interactive_ext(int on);
 #endif
 
 void set_interactive(struct power_module *module, int on)
 {
-    char governor[80];
-    char tmp_str[NODE_MAX];
-    struct video_encode_metadata_t video_encode_metadata;
-    int rc = 0;
+    const struct hint_vector *display_off;
+    const struct sysfs_transform *transforms;
+    int governor, num_transforms;
 
     pthread_mutex_lock(&hint_mutex);
 
@@ -266,202 +358,48 @@ void set_interactive(struct power_module *module, int on)
     cm_power_set_interactive_ext(on);
 #endif
 
+    power_state_set_display(on);
+
     if (set_interactive_override(module, on) == HINT_HANDLED) {
         goto out;
     }
 
     ALOGI("Got set_interactive hint");
 
-    if (get_scaling_governor(governor, sizeof(governor)) == -1) {
+    if (on) {
+        /*
+         * Undo what display off applied, whatever the governor is now:
+         * it may have changed, and gained a DISPLAY_OFF vector or lost
+         * one, while the display was off.
+         */
+        if (display_hint_sent) {
+            undo_hint_action(DISPLAY_STATE_HINT_ID);
+            display_hint_sent = 0;
+        }
+        sysfs_snapshot_restore(&display_off_snapshot);
+        goto out;
+    }
+
+    governor = get_scaling_governor_id();
+    if (governor == -1) {
         ALOGE("Can't obtain scaling governor.");
         goto out;
     }
 
-    if (!on) {
-        /* Display off. */
-        if ((strncmp(governor, ONDEMAND_GOVERNOR, strlen(ONDEMAND_GOVERNOR)) == 0) &&
-                (strlen(governor) == strlen(ONDEMAND_GOVERNOR))) {
-            int resource_values[] = {DISPLAY_OFF, MS_500, THREAD_MIGRATION_SYNC_OFF};
-
-            if (!display_hint_sent) {
-                perform_hint_action(DISPLAY_STATE_HINT_ID,
-                        resource_values, sizeof(resource_values)/sizeof(resource_values[0]));
-                display_hint_sent = 1;
-            }
-        } else if ((strncmp(governor, INTERACTIVE_GOVERNOR, strlen(INTERACTIVE_GOVERNOR)) == 0) &&
-                (strlen(governor) == strlen(INTERACTIVE_GOVERNOR))) {
-            int resource_values[] = {TR_MS_50, THREAD_MIGRATION_SYNC_OFF};
-
-            if (!display_hint_sent) {
-                perform_hint_action(DISPLAY_STATE_HINT_ID,
-                        resource_values, sizeof(resource_values)/sizeof(resource_values[0]));
-                display_hint_sent = 1;
-            }
-        } else if ((strncmp(governor, MSMDCVS_GOVERNOR, strlen(MSMDCVS_GOVERNOR)) == 0) &&
-                (strlen(governor) == strlen(MSMDCVS_GOVERNOR))) {
-            if (saved_interactive_mode == 1){
-                /* Display turned off. */
-                if (sysfs_read(DCVS_CPU0_SLACK_MAX_NODE, tmp_str, NODE_MAX - 1)) {
-                    if (!slack_node_rw_failed) {
-                        ALOGE("Failed to read from %s", DCVS_CPU0_SLACK_MAX_NODE);
-                    }
-
-                    rc = 1;
-                } else {
-                    saved_dcvs_cpu0_slack_max = atoi(tmp_str);
-                }
-
-                if (sysfs_read(DCVS_CPU0_SLACK_MIN_NODE, tmp_str, NODE_MAX - 1)) {
-                    if (!slack_node_rw_failed) {
-                        ALOGE("Failed to read from %s", DCVS_CPU0_SLACK_MIN_NODE);
-                    }
-
-                    rc = 1;
-                } else {
-                    saved_dcvs_cpu0_slack_min = atoi(tmp_str);
-                }
-
-                if (sysfs_read(MPDECISION_SLACK_MAX_NODE, tmp_str, NODE_MAX - 1)) {
-                    if (!slack_node_rw_failed) {
-                        ALOGE("Failed to read from %s", MPDECISION_SLACK_MAX_NODE);
-                    }
-
-                    rc = 1;
-                } else {
-                    saved_mpdecision_slack_max = atoi(tmp_str);
-                }
-
-                if (sysfs_read(MPDECISION_SLACK_MIN_NODE, tmp_str, NODE_MAX - 1)) {
-                    if(!slack_node_rw_failed) {
-                        ALOGE("Failed to read from %s", MPDECISION_SLACK_MIN_NODE);
-                    }
-
-                    rc = 1;
-                } else {
-                    saved_mpdecision_slack_min = atoi(tmp_str);
-                }
-
-                /* Write new values. */
-                if (saved_dcvs_cpu0_slack_max != -1) {
-                    snprintf(tmp_str, NODE_MAX, "%d", 10 * saved_dcvs_cpu0_slack_max);
-
-                    if (sysfs_write(DCVS_CPU0_SLACK_MAX_NODE, tmp_str) != 0) {
-                        if (!slack_node_rw_failed) {
-                            ALOGE("Failed to write to %s", DCVS_CPU0_SLACK_MAX_NODE);
-                        }
-
-                        rc = 1;
-                    }
-                }
-
-                if (saved_dcvs_cpu0_slack_min != -1) {
-                    snprintf(tmp_str, NODE_MAX, "%d", 10 * saved_dcvs_cpu0_slack_min);
-
-                    if (sysfs_write(DCVS_CPU0_SLACK_MIN_NODE, tmp_str) != 0) {
-                        if(!slack_node_rw_failed) {
-                            ALOGE("Failed to write to %s", DCVS_CPU0_SLACK_MIN_NODE);
-                        }
-
-                        rc = 1;
-                    }
-                }
-
-                if (saved_mpdecision_slack_max != -1) {
-                    snprintf(tmp_str, NODE_MAX, "%d", 10 * saved_mpdecision_slack_max);
-
-                    if (sysfs_write(MPDECISION_SLACK_MAX_NODE, tmp_str) != 0) {
-                        if(!slack_node_rw_failed) {
-                            ALOGE("Failed to write to %s", MPDECISION_SLACK_MAX_NODE);
-                        }
-
-                        rc = 1;
-                    }
-                }
-
-                if (saved_mpdecision_slack_min != -1) {
-                    snprintf(tmp_str, NODE_MAX, "%d", 10 * saved_mpdecision_slack_min);
-
-                    if (sysfs_write(MPDECISION_SLACK_MIN_NODE, tmp_str) != 0) {
-                        if(!slack_node_rw_failed) {
-                            ALOGE("Failed to write to %s", MPDECISION_SLACK_MIN_NODE);
-                        }
-
-                        rc = 1;
-                    }
-                }
-            }
-
-            slack_node_rw_failed = rc;
-        }
-    } else {
-        /* Display on. */
-        if ((strncmp(governor, ONDEMAND_GOVERNOR, strlen(ONDEMAND_GOVERNOR)) == 0) &&
-                (strlen(governor) == strlen(ONDEMAND_GOVERNOR))) {
-            undo_hint_action(DISPLAY_STATE_HINT_ID);
-            display_hint_sent = 0;
-        } else if ((strncmp(governor, INTERACTIVE_GOVERNOR, strlen(INTERACTIVE_GOVERNOR)) == 0) &&
-                (strlen(governor) == strlen(INTERACTIVE_GOVERNOR))) {
-            undo_hint_action(DISPLAY_STATE_HINT_ID);
-            display_hint_sent = 0;
-        } else if ((strncmp(governor, MSMDCVS_GOVERNOR, strlen(MSMDCVS_GOVERNOR)) == 0) && 
-                (strlen(governor) == strlen(MSMDCVS_GOVERNOR))) {
-            if (saved_interactive_mode == -1 || saved_interactive_mode == 0) {
-                /* Display turned on. Restore if possible. */
-                if (saved_dcvs_cpu0_slack_max != -1) {
-                    snprintf(tmp_str, NODE_MAX, "%d", saved_dcvs_cpu0_slack_max);
-
-                    if (sysfs_write(DCVS_CPU0_SLACK_MAX_NODE, tmp_str) != 0) {
-                        if (!slack_node_rw_failed) {
-                            ALOGE("Failed to write to %s", DCVS_CPU0_SLACK_MAX_NODE);
-                        }
-
-                        rc = 1;
-                    }
-                }
-
-                if (saved_dcvs_cpu0_slack_min != -1) {
-                    snprintf(tmp_str, NODE_MAX, "%d", saved_dcvs_cpu0_slack_min);
-
-                    if (sysfs_write(DCVS_CPU0_SLACK_MIN_NODE, tmp_str) != 0) {
-                        if (!slack_node_rw_failed) {
-                            ALOGE("Failed to write to %s", DCVS_CPU0_SLACK_MIN_NODE);
-                        }
-
-                        rc = 1;
-                    }
-                }
-
-                if (saved_mpdecision_slack_max != -1) {
-                    snprintf(tmp_str, NODE_MAX, "%d", saved_mpdecision_slack_max);
-
-                    if (sysfs_write(MPDECISION_SLACK_MAX_NODE, tmp_str) != 0) {
-                        if (!slack_node_rw_failed) {
-                            ALOGE("Failed to write to %s", MPDECISION_SLACK_MAX_NODE);
-                        }
-
-                        rc = 1;
-                    }
-                }
-
-                if (saved_mpdecision_slack_min != -1) {
-                    snprintf(tmp_str, NODE_MAX, "%d", saved_mpdecision_slack_min);
-
-                    if (sysfs_write(MPDECISION_SLACK_MIN_NODE, tmp_str) != 0) {
-                        if (!slack_node_rw_failed) {
-                            ALOGE("Failed to write to %s", MPDECISION_SLACK_MIN_NODE);
-                        }
-
-                        rc = 1;
-                    }
-                }
-            }
-
-            slack_node_rw_failed = rc;
+    display_off = hint_table_lookup(hint_table, HINT_TYPE_DISPLAY_OFF, governor);
+    num_transforms = get_display_off_transforms(governor, &transforms);
+
+    /* Display off. */
+    if (display_off) {
+        if (!display_hint_sent) {
+            perform_hint_vector(DISPLAY_STATE_HINT_ID, display_off);
+            display_hint_sent = 1;
         }
+    } else if (num_transforms > 0) {
+        sysfs_snapshot_apply(&display_off_snapshot, transforms,
+                num_transforms);
     }
 
-    saved_interactive_mode = !!on;
-
 out:
     pthread_mutex_unlock(&hint_mutex);
 }
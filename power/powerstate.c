@@ -0,0 +1,219 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * powerstate: print the state page published by the power HAL.
+ *
+ *   powerstate [-i interval_ms] [-n count]
+ *
+ * With no options a single snapshot is printed. With -i the page is
+ * polled until -n snapshots have been printed (forever if -n is 0).
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "power-state.h"
+
+static const char *profile_names[] = {
+    "power_save", "balanced", "high_performance", "bias_power",
+    "bias_performance", "sustained_performance",
+};
+
+static const char *boot_boost_names[] = {
+    "idle", "held", "completed", "timed_out",
+};
+
+/* Boost budgets follow the profiles, then battery saver. */
+static const char *budget_names[] = {
+    "power_save", "balanced", "high_performance", "bias_power",
+    "bias_performance", "sustained_performance", "low_power",
+};
+
+static long long now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void print_state(const struct power_state_page *s)
+{
+    long long now = now_ms();
+    int i;
+
+    if (s->profile >= 0 &&
+            s->profile < (int)(sizeof(profile_names)/sizeof(profile_names[0])))
+        printf("profile: %s\n", profile_names[s->profile]);
+    else
+        printf("profile: %d\n", s->profile);
+
+    printf("display: %s\n", s->display_on < 0 ? "unknown" :
+            s->display_on ? "on" : "off");
+    printf("low_power: %d\n", s->low_power);
+
+    if (s->last_boost_ms)
+        printf("last_boost: %lld ms ago\n", now - s->last_boost_ms);
+    else
+        printf("last_boost: never\n");
+    printf("boost_active: %d\n", s->boost_expiry_ms > now);
+
+    printf("hints: %d\n", s->num_hints);
+    for (i = 0; i < s->num_hints; i++) {
+        if (s->hints[i].expiry_ms)
+            printf("  0x%04x expires in %lld ms\n", s->hints[i].hint_id,
+                    (long long)s->hints[i].expiry_ms - now);
+        else
+            printf("  0x%04x held\n", s->hints[i].hint_id);
+    }
+
+    printf("budgets:\n");
+    for (i = 0; i < s->num_budgets; i++) {
+        const struct power_state_budget *b = &s->budgets[i];
+
+        if (!b->granted && !b->denied && i != s->budget)
+            continue;
+        if (i < (int)(sizeof(budget_names)/sizeof(budget_names[0])))
+            printf("  %s%s:", budget_names[i], i == s->budget ? "*" : "");
+        else
+            printf("  %d%s:", i, i == s->budget ? "*" : "");
+        if (i == s->budget && b->tokens_ms >= 0)
+            printf(" tokens %d ms,", b->tokens_ms);
+        printf(" granted %u clamped %u denied %u consumed %lld ms\n",
+                b->granted, b->clamped, b->denied, (long long)b->consumed_ms);
+    }
+
+    if (s->boot_boost_state >= 0 && s->boot_boost_state <
+            (int)(sizeof(boot_boost_names)/sizeof(boot_boost_names[0])))
+        printf("boot_boost: %s", boot_boost_names[s->boot_boost_state]);
+    else
+        printf("boot_boost: %d", s->boot_boost_state);
+    if (s->boot_boost_held_ms)
+        printf(", held %lld ms\n", (long long)s->boot_boost_held_ms);
+    else if (s->boot_boost_start_ms)
+        printf(", %lld ms so far\n", now - s->boot_boost_start_ms);
+    else
+        printf("\n");
+
+    printf("reaper: %d\n", s->num_reaper);
+    for (i = 0; i < s->num_reaper; i++)
+        printf("  0x%04x renewed %u reaped %u\n", s->reaper[i].hint_id,
+                s->reaper[i].renewals, s->reaper[i].reaped);
+
+    printf("launch: %u lookups, %u in table, %u learned duration, "
+            "%u skipped\n", s->launch.lookups, s->launch.table_hits,
+            s->launch.learned_hits, s->launch.skipped);
+    printf("  %u launches timed, %u evicted\n", s->launch.learned,
+            s->launch.evictions);
+
+    printf("core_ctl: %u requests, %u transitions\n", s->core_ctl.requests,
+            s->core_ctl.transitions);
+    if (s->core_ctl.last_transition_ms) {
+        printf("  last %lld ms ago, %u in the minute before it, online %#x\n",
+                now - s->core_ctl.last_transition_ms,
+                s->core_ctl.transitions_per_min, s->core_ctl.online_mask);
+        for (i = 0; i < s->core_ctl.num_clusters &&
+                i < POWER_STATE_MAX_CLUSTERS; i++)
+            printf("  cluster%d: min %d max %d\n", i,
+                    s->core_ctl.min_cpus[i], s->core_ctl.max_cpus[i]);
+    }
+
+    printf("perflock: daemon pid %d, %u probes, %u restarts, "
+            "%u failed releases\n", s->perflock.daemon_pid,
+            s->perflock.probes, s->perflock.restarts,
+            s->perflock.failed_releases);
+    printf("  %u recoveries, %u locks re-acquired\n",
+            s->perflock.recoveries, s->perflock.locks_reacquired);
+
+    printf("cpufreq: %u writes, %u deferred, %u replayed, "
+            "%u replays failed\n", s->cpufreq.writes, s->cpufreq.deferred,
+            s->cpufreq.replays, s->cpufreq.replay_failures);
+
+    printf("pm_qos: %u votes, %u requests, %u updates, %u failures",
+            s->pm_qos.votes, s->pm_qos.requests, s->pm_qos.updates,
+            s->pm_qos.failures);
+    if (s->pm_qos.latency_us >= 0)
+        printf(", holding %d us\n", s->pm_qos.latency_us);
+    else
+        printf("\n");
+
+    printf("vsync: %u bursts, %u cold, %u warm, %u acquires, %u releases\n",
+            s->vsync.bursts, s->vsync.cold_starts, s->vsync.warm_starts,
+            s->vsync.acquires, s->vsync.releases);
+    printf("  boosted %lld ms\n", (long long)s->vsync.boosted_ms);
+}
+
+int main(int argc, char *argv[])
+{
+    const struct power_state_page *page;
+    struct power_state_page snapshot;
+    int interval_ms = 0, count = -1;
+    int opt, printed = 0, ret;
+
+    while ((opt = getopt(argc, argv, "i:n:")) != -1) {
+        switch (opt) {
+        case 'i':
+            interval_ms = atoi(optarg);
+            break;
+        case 'n':
+            count = atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-i interval_ms] [-n count]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    /* One snapshot, or with -i, as many as -n asks for (0 forever). */
+    if (count < 0)
+        count = interval_ms ? 0 : 1;
+
+    page = power_state_map();
+    if (!page) {
+        fprintf(stderr, "Unable to map %s: %s\n", POWER_STATE_PATH,
+                strerror(errno));
+        return 1;
+    }
+
+    for (;;) {
+        ret = power_state_snapshot(page, &snapshot);
+        if (ret) {
+            fprintf(stderr, "No consistent snapshot: %s\n", strerror(-ret));
+        } else {
+            if (printed)
+                printf("\n");
+            print_state(&snapshot);
+            fflush(stdout);
+        }
+        printed++;
+
+        if (count && printed >= count)
+            break;
+        if (!interval_ms)
+            break;
+        usleep(interval_ms * 1000);
+    }
+
+    power_state_unmap(page);
+
+    return ret ? 1 : 0;
+}
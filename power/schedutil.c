@@ -0,0 +1,494 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * schedutil backend.
+ *
+ * schedutil has no perflock opcodes and none of the interactive or
+ * ondemand tunables, so hints are turned into direct changes: the
+ * top-app cpu.uclamp.min, per-policy scaling_min_freq and the
+ * governor's rate limit. Each hint is a request that is either timed,
+ * with the same replace-on-repeat semantics as interaction(), or held
+ * until released. The merged result of all active requests is
+ * written, and the original values are put back once none are left.
+ */
+
+#define LOG_NIDEBUG 0
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define LOG_TAG "QCOM PowerHAL"
+#include <utils/Log.h>
+
+#include "utils.h"
+#include "metadata-defs.h"
+#include "power-common.h"
+#include "governor-tunables.h"
+#include "power-state.h"
+#include "power-timer.h"
+#include "schedutil.h"
+#include "pm-qos.h"
+#include "boost-budget.h"
+#include "launch-policy.h"
+
+#define VALUE_MAX   (32)
+#define PATH_LEN    (128)
+
+static const struct schedutil_request request_params[SCHEDUTIL_REQ_COUNT] = {
+    [SCHEDUTIL_REQ_INTERACTION]  = { .uclamp_min = 50, .fast_ramp = 1 },
+    [SCHEDUTIL_REQ_LAUNCH]       = { .uclamp_min = 100, .min_freq_pct = 70,
+                                     .fast_ramp = 1 },
+    [SCHEDUTIL_REQ_CPU_BOOST]    = { .uclamp_min = 50, .fast_ramp = 1 },
+    [SCHEDUTIL_REQ_VIDEO_ENCODE] = { .uclamp_min = 30, .fast_ramp = 1 },
+    [SCHEDUTIL_REQ_VIDEO_DECODE] = { .fast_ramp = 1 },
+};
+
+/* Both spellings exist depending on the kernel. */
+static const char *rate_limit_tunables[] = {
+    "rate_limit_us", "up_rate_limit_us",
+};
+
+#define NUM_RATE_LIMITS \
+    (sizeof(rate_limit_tunables)/sizeof(rate_limit_tunables[0]))
+
+static pthread_mutex_t schedutil_mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct power_timer expiry_timer;
+static int expiry_timer_ready;
+
+static struct {
+    int active;
+    long long expiry_ms; /* 0 while held */
+} requests[SCHEDUTIL_REQ_COUNT];
+
+/* Open video sessions; the video requests are held while any is open. */
+static struct {
+    int in_use;
+    int id;
+    int hint_id;
+} video_sessions[SCHEDUTIL_MAX_VIDEO_SESSIONS];
+
+static struct {
+    char min_freq_path[PATH_LEN];
+    int max_freq;
+    char saved_min_freq[VALUE_MAX];
+} policies[SCHEDUTIL_MAX_POLICIES];
+static int num_policies = -1;
+
+/* Merged request currently written out. */
+static struct schedutil_request applied;
+/* Values from before the first request; empty if not exposed. */
+static int saved;
+static char saved_uclamp[VALUE_MAX];
+static char saved_rate_limit[NUM_RATE_LIMITS][VALUE_MAX];
+
+/* Not sysfs_read(): nodes this kernel lacks are expected. */
+static int read_node(const char *path, char *value, int size)
+{
+    int fd, len;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return -1;
+    len = read(fd, value, size - 1);
+    close(fd);
+    if (len < 0)
+        return -1;
+
+    while (len > 0 && value[len - 1] == '\n')
+        len--;
+    value[len] = '\0';
+
+    return 0;
+}
+
+/*
+ * Whether this kernel can run schedutil at all. Checked once so that
+ * hints on other kernels don't pay for a governor read.
+ */
+static int schedutil_available(void)
+{
+    static int available = -1;
+    char governors[256];
+
+    if (available < 0) {
+        available = !read_node(AVAILABLE_GOVERNORS_PATH, governors,
+                sizeof(governors)) &&
+                strstr(governors, SCHEDUTIL_GOVERNOR) != NULL;
+    }
+
+    return available;
+}
+
+static void discover_policies(void)
+{
+    char path[PATH_LEN];
+    char value[VALUE_MAX];
+    int i;
+
+    num_policies = 0;
+
+    for (i = 0; i < SCHEDUTIL_MAX_POLICIES; i++) {
+        snprintf(path, sizeof(path), CPUFREQ_POLICY_PATH "cpuinfo_max_freq", i);
+        if (read_node(path, value, sizeof(value)))
+            continue;
+
+        snprintf(policies[num_policies].min_freq_path, PATH_LEN,
+                CPUFREQ_POLICY_PATH "scaling_min_freq", i);
+        policies[num_policies].max_freq = atoi(value);
+        num_policies++;
+    }
+
+    ALOGI("schedutil: %d cpufreq policies", num_policies);
+}
+
+static void save_locked(void)
+{
+    unsigned int i;
+    int p;
+
+    if (num_policies < 0)
+        discover_policies();
+
+    if (read_node(SCHEDUTIL_UCLAMP_PATH, saved_uclamp, VALUE_MAX))
+        saved_uclamp[0] = '\0';
+
+    for (p = 0; p < num_policies; p++) {
+        if (read_node(policies[p].min_freq_path, policies[p].saved_min_freq,
+                    VALUE_MAX))
+            policies[p].saved_min_freq[0] = '\0';
+    }
+
+    for (i = 0; i < NUM_RATE_LIMITS; i++) {
+        if (governor_read_tunable(SCHEDUTIL_GOVERNOR, rate_limit_tunables[i],
+                    saved_rate_limit[i], VALUE_MAX))
+            saved_rate_limit[i][0] = '\0';
+    }
+
+    saved = 1;
+}
+
+static void write_uclamp(int uclamp_min)
+{
+    char value[VALUE_MAX];
+
+    if (!saved_uclamp[0])
+        return;
+
+    if (uclamp_min)
+        snprintf(value, sizeof(value), "%d", uclamp_min);
+    else
+        snprintf(value, sizeof(value), "%s", saved_uclamp);
+
+    sysfs_write(SCHEDUTIL_UCLAMP_PATH, value);
+}
+
+static void write_min_freq(int min_freq_pct)
+{
+    char value[VALUE_MAX];
+    int p;
+
+    for (p = 0; p < num_policies; p++) {
+        if (!policies[p].saved_min_freq[0])
+            continue;
+
+        if (min_freq_pct)
+            snprintf(value, sizeof(value), "%lld",
+                    (long long)policies[p].max_freq * min_freq_pct / 100);
+        else
+            snprintf(value, sizeof(value), "%s", policies[p].saved_min_freq);
+
+        sysfs_write(policies[p].min_freq_path, value);
+    }
+}
+
+static void write_rate_limit(int fast_ramp)
+{
+    struct tunable_setting setting;
+    struct tunable_apply_stats stats = { 0 };
+    char value[VALUE_MAX];
+    unsigned int i;
+
+    snprintf(value, sizeof(value), "%d", SCHEDUTIL_BOOST_RATE_LIMIT_US);
+
+    for (i = 0; i < NUM_RATE_LIMITS; i++) {
+        if (!saved_rate_limit[i][0])
+            continue;
+
+        setting.name = rate_limit_tunables[i];
+        setting.value = fast_ramp ? value : saved_rate_limit[i];
+        governor_apply_tunables(SCHEDUTIL_GOVERNOR, &setting, 1, &stats);
+    }
+}
+
+/* Write out the merge of all active requests. */
+static void update_locked(void)
+{
+    struct schedutil_request merged = { 0 };
+    int i, any = 0;
+
+    for (i = 0; i < SCHEDUTIL_REQ_COUNT; i++) {
+        const struct schedutil_request *r = &request_params[i];
+
+        if (!requests[i].active)
+            continue;
+
+        any = 1;
+        if (r->uclamp_min > merged.uclamp_min)
+            merged.uclamp_min = r->uclamp_min;
+        if (r->min_freq_pct > merged.min_freq_pct)
+            merged.min_freq_pct = r->min_freq_pct;
+        merged.fast_ramp |= r->fast_ramp;
+    }
+
+    if (!any && !saved)
+        return;
+    if (!saved)
+        save_locked();
+
+    if (merged.uclamp_min != applied.uclamp_min)
+        write_uclamp(merged.uclamp_min);
+    if (merged.min_freq_pct != applied.min_freq_pct)
+        write_min_freq(merged.min_freq_pct);
+    if (merged.fast_ramp != applied.fast_ramp)
+        write_rate_limit(merged.fast_ramp);
+
+    applied = merged;
+
+    /* Everything is back to the originals; re-read them next time. */
+    if (!any)
+        saved = 0;
+}
+
+static void rearm_locked(void)
+{
+    long long next = 0, now;
+    int i;
+
+    for (i = 0; i < SCHEDUTIL_REQ_COUNT; i++) {
+        if (requests[i].active && requests[i].expiry_ms &&
+                (!next || requests[i].expiry_ms < next))
+            next = requests[i].expiry_ms;
+    }
+
+    if (!next) {
+        power_timer_cancel(&expiry_timer);
+        return;
+    }
+
+    now = power_timer_now_ms();
+    power_timer_arm(&expiry_timer, next > now ? (int)(next - now) : 1);
+}
+
+static void expiry_timer_expired(__attribute__((unused)) void *data)
+{
+    long long now = power_timer_now_ms();
+    int i;
+
+    pthread_mutex_lock(&schedutil_mutex);
+
+    for (i = 0; i < SCHEDUTIL_REQ_COUNT; i++) {
+        if (requests[i].active && requests[i].expiry_ms &&
+                requests[i].expiry_ms <= now)
+            requests[i].active = 0;
+    }
+
+    update_locked();
+    rearm_locked();
+
+    pthread_mutex_unlock(&schedutil_mutex);
+}
+
+static void request_locked(int id, int duration_ms)
+{
+    if (!expiry_timer_ready) {
+        power_timer_init(&expiry_timer, expiry_timer_expired, NULL);
+        expiry_timer_ready = 1;
+    }
+
+    requests[id].active = 1;
+    requests[id].expiry_ms = duration_ms > 0 ?
+            power_timer_now_ms() + duration_ms : 0;
+
+    update_locked();
+    rearm_locked();
+}
+
+static void release_locked(int id)
+{
+    if (requests[id].active) {
+        requests[id].active = 0;
+        update_locked();
+        if (expiry_timer_ready)
+            rearm_locked();
+    }
+}
+
+/*
+ * Activate request 'id' for 'duration_ms', replacing any earlier
+ * expiry, or until schedutil_release() if 'duration_ms' is 0.
+ */
+void schedutil_request(int id, int duration_ms)
+{
+    if (id < 0 || id >= SCHEDUTIL_REQ_COUNT)
+        return;
+
+    pthread_mutex_lock(&schedutil_mutex);
+    request_locked(id, duration_ms);
+    pthread_mutex_unlock(&schedutil_mutex);
+
+    if (duration_ms > 0)
+        power_state_boost(duration_ms);
+}
+
+void schedutil_release(int id)
+{
+    if (id < 0 || id >= SCHEDUTIL_REQ_COUNT)
+        return;
+
+    pthread_mutex_lock(&schedutil_mutex);
+    release_locked(id);
+    pthread_mutex_unlock(&schedutil_mutex);
+}
+
+/* Returns what the boost budget granted, 0 if it refused. */
+static int timed_request(int id, int duration_ms)
+{
+    int granted = boost_budget_grant(duration_ms);
+
+    if (granted > 0) {
+        schedutil_request(id, granted);
+        boost_budget_charge(duration_ms, granted);
+    }
+
+    return granted > 0 ? granted : 0;
+}
+
+/*
+ * Track sessions by hint_id so that one of two concurrent encodes
+ * ending doesn't drop the request the other still needs.
+ */
+static void video_request(int id, int hint_id, int state)
+{
+    int i, slot = -1, open = 0;
+
+    if (state != 0 && state != 1)
+        return;
+
+    pthread_mutex_lock(&schedutil_mutex);
+
+    for (i = 0; i < SCHEDUTIL_MAX_VIDEO_SESSIONS; i++) {
+        if (video_sessions[i].in_use && video_sessions[i].id == id &&
+                video_sessions[i].hint_id == hint_id)
+            slot = i;
+    }
+
+    if (state == 1 && slot < 0) {
+        for (i = 0; i < SCHEDUTIL_MAX_VIDEO_SESSIONS && slot < 0; i++) {
+            if (!video_sessions[i].in_use)
+                slot = i;
+        }
+        if (slot >= 0) {
+            video_sessions[slot].in_use = 1;
+            video_sessions[slot].id = id;
+            video_sessions[slot].hint_id = hint_id;
+        } else {
+            ALOGW("schedutil: no room for video session 0x%x", hint_id);
+        }
+    } else if (state == 0 && slot >= 0) {
+        video_sessions[slot].in_use = 0;
+    }
+
+    for (i = 0; i < SCHEDUTIL_MAX_VIDEO_SESSIONS; i++) {
+        if (video_sessions[i].in_use && video_sessions[i].id == id)
+            open = 1;
+    }
+
+    if (state == 1)
+        request_locked(id, 0);
+    else if (!open)
+        release_locked(id);
+
+    pthread_mutex_unlock(&schedutil_mutex);
+}
+
+/* Returns HINT_NONE unless schedutil is the running governor. */
+int schedutil_power_hint(power_hint_t hint, void *data)
+{
+    struct video_encode_metadata_t encode;
+    struct video_decode_metadata_t decode;
+    int duration, granted;
+
+    switch (hint) {
+    case POWER_HINT_INTERACTION:
+    case POWER_HINT_LAUNCH_BOOST:
+    case POWER_HINT_CPU_BOOST:
+    case POWER_HINT_VIDEO_ENCODE:
+    case POWER_HINT_VIDEO_DECODE:
+        break;
+    default:
+        return HINT_NONE;
+    }
+
+    if (!schedutil_available() ||
+            get_scaling_governor_id() != GOVERNOR_SCHEDUTIL)
+        return HINT_NONE;
+
+    switch (hint) {
+    case POWER_HINT_INTERACTION:
+        duration = data ? *(int32_t *)data : 0;
+        if (duration <= 0)
+            duration = SCHEDUTIL_INTERACTION_MS;
+        if (duration > SCHEDUTIL_INTERACTION_MAX_MS)
+            duration = SCHEDUTIL_INTERACTION_MAX_MS;
+        granted = timed_request(SCHEDUTIL_REQ_INTERACTION, duration);
+        if (granted)
+            pm_qos_vote(PM_QOS_VOTE_INTERACTION, granted);
+        break;
+    case POWER_HINT_LAUNCH_BOOST:
+        duration = launch_policy_duration(SCHEDUTIL_LAUNCH_MS);
+        granted = timed_request(SCHEDUTIL_REQ_LAUNCH, duration);
+        if (granted)
+            pm_qos_vote(PM_QOS_VOTE_LAUNCH, granted);
+        break;
+    case POWER_HINT_CPU_BOOST:
+        if (data)
+            timed_request(SCHEDUTIL_REQ_CPU_BOOST, *(int32_t *)data / 1000);
+        break;
+    case POWER_HINT_VIDEO_ENCODE:
+        memset(&encode, 0, sizeof(encode));
+        encode.state = -1;
+        if (data && parse_video_encode_metadata((char *)data, &encode) != -1)
+            video_request(SCHEDUTIL_REQ_VIDEO_ENCODE, encode.hint_id,
+                    encode.state);
+        break;
+    case POWER_HINT_VIDEO_DECODE:
+        memset(&decode, 0, sizeof(decode));
+        decode.state = -1;
+        if (data && parse_video_decode_metadata((char *)data, &decode) != -1)
+            video_request(SCHEDUTIL_REQ_VIDEO_DECODE, decode.hint_id,
+                    decode.state);
+        break;
+    default:
+        break;
+    }
+
+    return HINT_HANDLED;
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _QCOM_SCHEDUTIL_H
+#define _QCOM_SCHEDUTIL_H
+
+#include <hardware/power.h>
+
+/* Overridable so the backend can be pointed at a fake tree. */
+#ifndef SCHEDUTIL_UCLAMP_PATH
+#define SCHEDUTIL_UCLAMP_PATH   "/dev/cpuctl/top-app/cpu.uclamp.min"
+#endif
+#ifndef CPUFREQ_POLICY_PATH
+#define CPUFREQ_POLICY_PATH     "/sys/devices/system/cpu/cpufreq/policy%d/"
+#endif
+#ifndef AVAILABLE_GOVERNORS_PATH
+#define AVAILABLE_GOVERNORS_PATH \
+    "/sys/devices/system/cpu/cpu0/cpufreq/scaling_available_governors"
+#endif
+
+#define SCHEDUTIL_MAX_POLICIES          (8)
+/* Concurrent video encode/decode sessions tracked by hint_id */
+#define SCHEDUTIL_MAX_VIDEO_SESSIONS    (8)
+
+/* rate_limit_us while a fast-ramp request is active */
+#define SCHEDUTIL_BOOST_RATE_LIMIT_US   (500)
+
+#define SCHEDUTIL_INTERACTION_MS        (500)
+#define SCHEDUTIL_INTERACTION_MAX_MS    (5000)
+#define SCHEDUTIL_LAUNCH_MS             (2000)
+
+enum schedutil_request_id {
+    SCHEDUTIL_REQ_INTERACTION = 0,
+    SCHEDUTIL_REQ_LAUNCH,
+    SCHEDUTIL_REQ_CPU_BOOST,
+    SCHEDUTIL_REQ_VIDEO_ENCODE,
+    SCHEDUTIL_REQ_VIDEO_DECODE,
+    SCHEDUTIL_REQ_COUNT
+};
+
+/*
+ * What one request asks for. Active requests are merged by taking the
+ * highest uclamp and min freq, and fast ramp if any of them wants it.
+ */
+struct schedutil_request {
+    /* top-app cpu.uclamp.min, percent */
+    int uclamp_min;
+    /* Per-policy scaling_min_freq, percent of cpuinfo_max_freq */
+    int min_freq_pct;
+    /* Drop rate_limit_us to SCHEDUTIL_BOOST_RATE_LIMIT_US */
+    int fast_ramp;
+};
+
+int schedutil_power_hint(power_hint_t hint, void *data);
+void schedutil_request(int id, int duration_ms);
+void schedutil_release(int id);
+
+#endif
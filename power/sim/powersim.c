@@ -0,0 +1,556 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * powersim: replay hint and workload traces against a model CPU.
+ *
+ *   powersim [-p policies] [-d deadline_ms] [-t timer_rate_ms] [-l] [-v]
+ *            <model> <hints> <work>
+ *
+ * The hints go through this build's SoC backend, as the HAL would
+ * send them, and the resulting perflocks drive the model described in
+ * sim-model.c. Each policy in the comma-separated -p list (a power
+ * profile name, or "none" to drop every hint) is replayed in its own
+ * process, and one line of estimates is printed for each:
+ *
+ *   frames  p50/p90 latency, and frames over the deadline (16 ms)
+ *   launch  mean and worst launch time
+ *   energy  CPU energy over the run, and time spent boosted
+ *   boosts  boosts granted and denied by the boost budget
+ *
+ * -t replaces the model's governor window, for devices whose init
+ * scripts sample slower than the model assumes. The vsync boost puts
+ * a floor under the first frames of each burst, which shows up in the
+ * frame estimates as fewer misses for "balanced" than for "none":
+ *
+ *   powersim -p none,balanced sim/models/msm8952.txt \
+ *       sim/traces/frames.hints sim/traces/frames.work
+ *
+ * With -l, the estimates are replaced by the perflocks held after
+ * each hint, with how many resources each applied, and the cluster
+ * limits they add up to, for checking what a sequence of hints leaves
+ * behind (see tests/powersim-test.sh).
+ *
+ * Build the tool against another backend, or an edited copy, to
+ * compare resource tables on the same traces.
+ *
+ * Hint trace, one per line:   <ms> <hint> [value]
+ *   <hint> is interaction, cpu_boost (value in us), launch_boost
+ *   (value is the package), audio, low_power (1 on, 0 off),
+ *   set_profile (a profile number), vsync (1 on, 0 off), interactive
+ *   (display on/off) or a numeric hint id.
+ *
+ * Work trace, one per line:   <ms> frame|launch|background <mcycles> [threads]
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <hardware/hardware.h>
+#include <hardware/power.h>
+
+#include "utils.h"
+#include "hint-data.h"
+#include "power-common.h"
+#include "boost-budget.h"
+#include "launch-policy.h"
+#include "boost-policy.h"
+#include "vsync-boost.h"
+#include "sim-model.h"
+
+#define DEFAULT_DEADLINE_MS     (16.0)
+#define DEFAULT_POLICIES        "none,balanced"
+/* Keep running this long after the last event, longer if still busy */
+#define TAIL_MS                 (1000)
+#define MAX_DRAIN_MS            (10000)
+#define MAX_POLICIES            (8)
+#define NAME_MAX_LEN            (64)
+
+#define HINT_INTERACTIVE        (-1)
+#define POLICY_NONE             (-1)
+
+/* Defined by the backend, or weakly in sim-hal.c */
+int power_hint_override(struct power_module *module, power_hint_t hint,
+        void *data);
+int set_interactive_override(struct power_module *module, int on);
+int get_low_power_resources(int **resources);
+/* sim-hal.c */
+void sim_run_timers(void);
+
+struct event {
+    long long ms;
+    /* Hint id, or the SIM_WORK_* kind for work events */
+    int type;
+    int has_value;
+    int value;
+    double mcycles;
+    int threads;
+    char name[NAME_MAX_LEN];
+};
+
+struct trace {
+    int num_events;
+    struct event *events;
+};
+
+static const struct {
+    const char *name;
+    int hint;
+} hint_names[] = {
+    { "vsync",          POWER_HINT_VSYNC },
+    { "interaction",    POWER_HINT_INTERACTION },
+    { "low_power",      POWER_HINT_LOW_POWER },
+    { "cpu_boost",      POWER_HINT_CPU_BOOST },
+    { "launch_boost",   POWER_HINT_LAUNCH_BOOST },
+    { "audio",          POWER_HINT_AUDIO },
+    { "set_profile",    POWER_HINT_SET_PROFILE },
+    { "interactive",    HINT_INTERACTIVE },
+};
+
+static const char *work_names[SIM_WORK_COUNT] = {
+    [SIM_WORK_FRAME] = "frame",
+    [SIM_WORK_LAUNCH] = "launch",
+    [SIM_WORK_BACKGROUND] = "background",
+};
+
+static const char *profile_names[] = {
+    "power_save", "balanced", "high_performance", "bias_power",
+    "bias_performance", "sustained_performance",
+};
+
+#define NUM_HINT_NAMES (int)(sizeof(hint_names)/sizeof(hint_names[0]))
+#define NUM_PROFILES (int)(sizeof(profile_names)/sizeof(profile_names[0]))
+
+static struct sim_model model;
+static double deadline_ms = DEFAULT_DEADLINE_MS;
+static int verbose;
+static int dump_locks;
+static int low_power_mode;
+static int low_power_hint_sent;
+static int user_profile = PROFILE_BALANCED;
+
+static int parse_hint(const char *word)
+{
+    char *end;
+    long id;
+    int i;
+
+    for (i = 0; i < NUM_HINT_NAMES; i++) {
+        if (!strcmp(word, hint_names[i].name))
+            return hint_names[i].hint;
+    }
+
+    id = strtol(word, &end, 0);
+    return end != word && !*end && id > 0 ? (int)id : 0;
+}
+
+static int parse_work(const char *word)
+{
+    int i;
+
+    for (i = 0; i < SIM_WORK_COUNT; i++) {
+        if (!strcmp(word, work_names[i]))
+            return i;
+    }
+
+    return -1;
+}
+
+/* Both traces share a parser; 'work' says which one this is. */
+static int load_trace(const char *path, int work, struct trace *trace)
+{
+    char line[256], word[NAME_MAX_LEN], arg[NAME_MAX_LEN];
+    struct event *e;
+    long long last_ms = 0;
+    int max_events = 0, lineno = 0, n;
+    FILE *f;
+    char *p;
+
+    memset(trace, 0, sizeof(*trace));
+
+    f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), f)) {
+        lineno++;
+        p = strchr(line, '#');
+        if (p)
+            *p = '\0';
+
+        if (trace->num_events == max_events) {
+            max_events = max_events ? max_events * 2 : 256;
+            trace->events = realloc(trace->events,
+                    max_events * sizeof(*trace->events));
+            if (!trace->events)
+                abort();
+        }
+        e = &trace->events[trace->num_events];
+        memset(e, 0, sizeof(*e));
+
+        n = sscanf(line, "%lld %63s %63s %d", &e->ms, word, arg, &e->threads);
+        if (n <= 0)
+            continue;
+        if (n < 2 || e->ms < last_ms)
+            goto bad;
+
+        if (work) {
+            e->type = parse_work(word);
+            if (e->type < 0 || n < 3 || sscanf(arg, "%lf", &e->mcycles) != 1)
+                goto bad;
+            if (n < 4)
+                e->threads = 1;
+        } else {
+            e->type = parse_hint(word);
+            if (!e->type)
+                goto bad;
+            if (n >= 3) {
+                e->has_value = 1;
+                e->value = atoi(arg);
+                snprintf(e->name, sizeof(e->name), "%s", arg);
+            }
+        }
+
+        last_ms = e->ms;
+        trace->num_events++;
+    }
+
+    fclose(f);
+    return 0;
+
+bad:
+    fprintf(stderr, "%s:%d: bad or out of order event\n", path, lineno);
+    fclose(f);
+    return -1;
+}
+
+static void apply_profile(int profile)
+{
+    power_hint_override(NULL, POWER_HINT_SET_PROFILE, &profile);
+    boost_budget_set_profile(profile);
+}
+
+/* The battery saver part of power.c */
+static void set_low_power_mode(int on)
+{
+    int old_profile = boost_policy_profile(user_profile, low_power_mode);
+    int new_profile;
+    int *resources;
+    int num_resources;
+
+    if (on == low_power_mode)
+        return;
+
+    low_power_mode = on;
+    boost_budget_set_low_power(on);
+
+    new_profile = boost_policy_profile(user_profile, low_power_mode);
+    if (new_profile != old_profile)
+        apply_profile(new_profile);
+
+    num_resources = get_low_power_resources(&resources);
+    if (on && num_resources > 0 && !low_power_hint_sent) {
+        perform_hint_action(DEFAULT_LOW_POWER_HINT_ID, resources,
+                num_resources);
+        low_power_hint_sent = 1;
+    } else if (!on && low_power_hint_sent) {
+        undo_hint_action(DEFAULT_LOW_POWER_HINT_ID);
+        low_power_hint_sent = 0;
+    }
+}
+
+static void send_hint(const struct event *e)
+{
+    launch_boost_info_t info;
+    int32_t value = e->value;
+    void *data = e->has_value ? &value : NULL;
+
+    switch (e->type) {
+    case HINT_INTERACTIVE:
+        set_interactive_override(NULL, e->has_value ? e->value : 1);
+        return;
+    case POWER_HINT_LAUNCH_BOOST:
+        info.pid = 0;
+        info.packageName = e->name;
+        data = &info;
+        /* As power.c: the package's policy may skip the boost. */
+        if (launch_policy_begin(data) == LAUNCH_CLASS_SKIP)
+            return;
+        break;
+    case POWER_HINT_SET_PROFILE:
+        if (!data)
+            return;
+        user_profile = value;
+        apply_profile(boost_policy_profile(user_profile, low_power_mode));
+        return;
+    case POWER_HINT_LOW_POWER:
+        set_low_power_mode(e->has_value && e->value);
+        return;
+    }
+
+    if (power_hint_override(NULL, e->type, data) == HINT_HANDLED)
+        return;
+
+    /* As power.c: no frame boost in battery saver. */
+    if (e->type == POWER_HINT_VSYNC)
+        vsync_boost_hint(e->has_value && e->value && !low_power_mode);
+}
+
+static void print_event(const struct event *e)
+{
+    int i;
+
+    printf("%6lld ms", e->ms);
+    for (i = 0; i < NUM_HINT_NAMES && hint_names[i].hint != e->type; i++)
+        ;
+    if (i < NUM_HINT_NAMES)
+        printf(" %s", hint_names[i].name);
+    else
+        printf(" 0x%x", e->type);
+    if (e->has_value)
+        printf(" %s", e->name);
+    printf("\n");
+}
+
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+static double percentile(double *values, int n, int pct)
+{
+    return n ? values[(n - 1) * pct / 100] : 0;
+}
+
+static void report(const char *name, struct sim_result *r)
+{
+    struct boost_budget_stats stats[BOOST_BUDGET_COUNT];
+    unsigned long granted = 0, denied = 0;
+    double *frames = r->latency_ms[SIM_WORK_FRAME];
+    double *launches = r->latency_ms[SIM_WORK_LAUNCH];
+    int num_frames = r->num_done[SIM_WORK_FRAME];
+    int num_launches = r->num_done[SIM_WORK_LAUNCH];
+    double launch_sum = 0;
+    int i, missed = 0;
+
+    boost_budget_get_stats(stats);
+    for (i = 0; i < BOOST_BUDGET_COUNT; i++) {
+        granted += stats[i].granted;
+        denied += stats[i].denied;
+    }
+
+    for (i = 0; i < num_frames; i++)
+        missed += frames[i] > deadline_ms;
+    for (i = 0; i < num_launches; i++)
+        launch_sum += launches[i];
+
+    qsort(frames, num_frames, sizeof(double), compare_double);
+    qsort(launches, num_launches, sizeof(double), compare_double);
+
+    printf("%-22s %6d %7.1f %7.1f %6d %8d %8.1f %8.1f %10.1f %8lld %6lu %6lu\n",
+            name, num_frames, percentile(frames, num_frames, 50),
+            percentile(frames, num_frames, 90), missed, num_launches,
+            num_launches ? launch_sum / num_launches : 0,
+            num_launches ? launches[num_launches - 1] : 0,
+            r->energy_mj, r->boosted_ms, granted, denied);
+
+    if (r->unfinished)
+        printf("%-22s %d work items still running at the end\n", "",
+                r->unfinished);
+}
+
+static void run_policy(int policy, const struct trace *hints,
+        const struct trace *work)
+{
+    struct sim_result result;
+    struct event profile_event;
+    long long end_ms = 0;
+    int h = 0, w = 0, i;
+    const struct event *e;
+
+    sim_init(&model, verbose);
+    launch_policy_init();
+
+    if (dump_locks)
+        printf("policy %s\n",
+                policy == POLICY_NONE ? "none" : profile_names[policy]);
+
+    if (hints->num_events)
+        end_ms = hints->events[hints->num_events - 1].ms;
+    if (work->num_events && work->events[work->num_events - 1].ms > end_ms)
+        end_ms = work->events[work->num_events - 1].ms;
+    end_ms += TAIL_MS;
+
+    if (policy != POLICY_NONE && policy != PROFILE_BALANCED) {
+        memset(&profile_event, 0, sizeof(profile_event));
+        profile_event.type = POWER_HINT_SET_PROFILE;
+        profile_event.has_value = 1;
+        profile_event.value = policy;
+        send_hint(&profile_event);
+    }
+
+    while (sim_now_ms() < end_ms ||
+            (sim_busy() && sim_now_ms() < end_ms + MAX_DRAIN_MS)) {
+        for (; h < hints->num_events &&
+                hints->events[h].ms <= sim_now_ms(); h++) {
+            if (policy != POLICY_NONE)
+                send_hint(&hints->events[h]);
+            if (dump_locks) {
+                print_event(&hints->events[h]);
+                sim_dump_state(stdout);
+            }
+        }
+
+        for (; w < work->num_events && work->events[w].ms <= sim_now_ms(); w++) {
+            e = &work->events[w];
+            if (sim_submit(e->type, e->mcycles, e->threads) < 0)
+                fprintf(stderr, "%lld ms: dropped %s, too much queued\n",
+                        e->ms, work_names[e->type]);
+        }
+
+        sim_run_timers();
+        sim_step();
+    }
+
+    sim_get_result(&result);
+    if (!dump_locks)
+        report(policy == POLICY_NONE ? "none" : profile_names[policy],
+                &result);
+
+    for (i = 0; i < SIM_WORK_COUNT; i++)
+        free(result.latency_ms[i]);
+}
+
+static int parse_policies(char *list, int policies[])
+{
+    char *name, *save = NULL;
+    int i, n = 0;
+
+    for (name = strtok_r(list, ",", &save); name;
+            name = strtok_r(NULL, ",", &save)) {
+        if (n == MAX_POLICIES)
+            return -1;
+
+        if (!strcmp(name, "none")) {
+            policies[n++] = POLICY_NONE;
+            continue;
+        }
+
+        for (i = 0; i < NUM_PROFILES; i++) {
+            if (!strcmp(name, profile_names[i]))
+                break;
+        }
+        if (i == NUM_PROFILES) {
+            fprintf(stderr, "unknown policy '%s'\n", name);
+            return -1;
+        }
+        policies[n++] = i;
+    }
+
+    return n;
+}
+
+int main(int argc, char *argv[])
+{
+    char default_policies[] = DEFAULT_POLICIES;
+    char *policy_list = default_policies;
+    int policies[MAX_POLICIES];
+    struct trace hints, work;
+    int timer_rate_ms = 0;
+    int opt, i, n, status, ret = 0;
+    pid_t pid;
+
+    while ((opt = getopt(argc, argv, "p:d:t:lv")) != -1) {
+        switch (opt) {
+        case 'p':
+            policy_list = optarg;
+            break;
+        case 'd':
+            deadline_ms = atof(optarg);
+            break;
+        case 't':
+            timer_rate_ms = atoi(optarg);
+            if (timer_rate_ms <= 0)
+                goto usage;
+            break;
+        case 'l':
+            dump_locks = 1;
+            break;
+        case 'v':
+            verbose = 1;
+            break;
+        default:
+            goto usage;
+        }
+    }
+
+    if (optind != argc - 3 || deadline_ms <= 0)
+        goto usage;
+
+    n = parse_policies(policy_list, policies);
+    if (n <= 0)
+        goto usage;
+
+    if (sim_model_load(argv[optind], &model) ||
+            load_trace(argv[optind + 1], 0, &hints) ||
+            load_trace(argv[optind + 2], 1, &work))
+        return 1;
+    if (timer_rate_ms)
+        model.timer_rate_ms = timer_rate_ms;
+
+    if (!dump_locks)
+        printf("%-22s %6s %7s %7s %6s %8s %8s %8s %10s %8s %6s %6s\n",
+                "policy", "frames", "p50_ms", "p90_ms", "missed",
+                "launches", "mean_ms", "max_ms", "energy_mJ", "boost_ms",
+                "boosts", "denied");
+
+    /* Backends and budgets keep static state; start each from scratch. */
+    for (i = 0; i < n; i++) {
+        fflush(stdout);
+        pid = fork();
+        if (pid < 0) {
+            fprintf(stderr, "fork: %s\n", strerror(errno));
+            return 1;
+        }
+        if (pid == 0) {
+            run_policy(policies[i], &hints, &work);
+            fflush(stdout);
+            _exit(0);
+        }
+        if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) ||
+                WEXITSTATUS(status))
+            ret = 1;
+    }
+
+    return ret;
+
+usage:
+    fprintf(stderr, "usage: %s [-p policy,...] [-d deadline_ms] "
+            "[-t timer_rate_ms] [-l] [-v] <model> <hints> <work>\n", argv[0]);
+    fprintf(stderr, "policies: none");
+    for (i = 0; i < NUM_PROFILES; i++)
+        fprintf(stderr, ", %s", profile_names[i]);
+    fprintf(stderr, "\n");
+    return 2;
+}
@@ -0,0 +1,339 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * The HAL side of powersim: the entry points of utils.c and friends
+ * that the SoC backends call, reimplemented on top of the model. The
+ * backend's own power_hint_override() and set_interactive_override(),
+ * and the real boost policy and vsync-boost.c, are linked in
+ * unchanged; time and timers are the model's clock, and the governor
+ * is taken to be interactive.
+ */
+
+#define LOG_NIDEBUG 0
+
+#include <stdlib.h>
+#include <hardware/hardware.h>
+#include <hardware/power.h>
+
+#define LOG_TAG "QCOM PowerHAL"
+#include <utils/Log.h>
+
+#include "utils.h"
+#include "hint-data.h"
+#include "power-common.h"
+#include "hint-table.h"
+#include "power-timer.h"
+#include "cpufreq-policy.h"
+#include "governor-tunables.h"
+#include "sustained-perf.h"
+#include "boost-budget.h"
+#include "boost-policy.h"
+#include "power-state.h"
+#include "socinfo.h"
+#include "sim-model.h"
+
+#define MAX_HINT_LOCKS          (16)
+#define MAX_SIM_TIMERS          (8)
+
+/* Set by power.c for the 8084 and 8974 display-off paths */
+int __attribute__ ((weak)) display_boost;
+
+static struct {
+    int hint_id;
+    int handle;
+    int num_resources;
+    int resources[SIM_MAX_RESOURCES];
+} hint_locks[MAX_HINT_LOCKS];
+
+static struct socinfo sim_socinfo;
+
+static struct power_timer *timers[MAX_SIM_TIMERS];
+static int num_timers;
+
+int __attribute__ ((weak)) power_hint_override(
+        __attribute__((unused)) struct power_module *module,
+        __attribute__((unused)) power_hint_t hint,
+        __attribute__((unused)) void *data)
+{
+    return HINT_NONE;
+}
+
+int __attribute__ ((weak)) set_interactive_override(
+        __attribute__((unused)) struct power_module *module,
+        __attribute__((unused)) int on)
+{
+    return HINT_NONE;
+}
+
+int __attribute__ ((weak)) get_low_power_resources(
+        __attribute__((unused)) int **resources)
+{
+    return 0;
+}
+
+long long power_timer_now_ms(void)
+{
+    return sim_now_ms();
+}
+
+/* Timers run on the model's clock; see sim_run_timers(). */
+void power_timer_init(struct power_timer *timer,
+        void (*callback)(void *data), void *data)
+{
+    int i;
+
+    timer->callback = callback;
+    timer->data = data;
+    timer->armed = 0;
+
+    for (i = 0; i < num_timers; i++) {
+        if (timers[i] == timer)
+            return;
+    }
+    if (num_timers < MAX_SIM_TIMERS)
+        timers[num_timers++] = timer;
+    else
+        ALOGE("No room for another timer");
+}
+
+int power_timer_arm(struct power_timer *timer, int timeout_ms)
+{
+    timer->deadline_ms = sim_now_ms() + (timeout_ms > 0 ? timeout_ms : 0);
+    timer->armed = 1;
+    return 0;
+}
+
+void power_timer_cancel(struct power_timer *timer)
+{
+    timer->armed = 0;
+}
+
+/* Fire the timers that are due; powersim calls this every step. */
+void sim_run_timers(void)
+{
+    int i;
+
+    for (i = 0; i < num_timers; i++) {
+        if (timers[i]->armed && timers[i]->deadline_ms <= sim_now_ms()) {
+            timers[i]->armed = 0;
+            timers[i]->callback(timers[i]->data);
+        }
+    }
+}
+
+/* The state page is the device's; powersim prints its own report. */
+void power_state_set_budget(__attribute__((unused)) int budget,
+        __attribute__((unused)) const struct power_state_budget *stats)
+{
+}
+
+void power_state_set_launch(
+        __attribute__((unused)) const struct power_state_launch *stats)
+{
+}
+
+void power_state_set_vsync(
+        __attribute__((unused)) const struct power_state_vsync *stats)
+{
+}
+
+int get_scaling_governor_id(void)
+{
+    return GOVERNOR_INTERACTIVE;
+}
+
+/* Unknown SoC; backends that check the family take their default. */
+const struct socinfo *socinfo_get(void)
+{
+    return &sim_socinfo;
+}
+
+/* Direct cpufreq and governor writes bypass the model. */
+int cpufreq_policy_write(__attribute__((unused)) int cpu,
+        __attribute__((unused)) const char *node,
+        __attribute__((unused)) const char *value)
+{
+    return CPUFREQ_POLICY_WRITTEN;
+}
+
+void governor_apply_tunables(__attribute__((unused)) const char *governor,
+        __attribute__((unused)) const struct tunable_setting *settings,
+        __attribute__((unused)) int num_settings,
+        __attribute__((unused)) struct tunable_apply_stats *stats)
+{
+}
+
+void cpufreq_apply_setting(__attribute__((unused)) int cpu,
+        __attribute__((unused)) const char *node,
+        __attribute__((unused)) const char *value,
+        __attribute__((unused)) struct tunable_apply_stats *stats)
+{
+}
+
+/* The thermal calibration needs a device; run with no limits. */
+void sustained_perf_start(void)
+{
+}
+
+void sustained_perf_stop(void)
+{
+}
+
+void undo_initial_hint_action()
+{
+}
+
+void perform_hint_action(int hint_id, int resource_values[],
+        int num_resources)
+{
+    int i, slot = -1;
+
+    for (i = 0; i < MAX_HINT_LOCKS; i++) {
+        if (hint_locks[i].handle && hint_locks[i].hint_id == hint_id)
+            slot = i;
+        else if (slot < 0 && !hint_locks[i].handle)
+            slot = i;
+    }
+    if (slot < 0) {
+        ALOGE("No room for hint 0x%x", hint_id);
+        return;
+    }
+
+    hint_locks[slot].hint_id = hint_id;
+    hint_locks[slot].handle = sim_lock_acquire(hint_locks[slot].handle, 0,
+            resource_values, num_resources);
+    if (hint_locks[slot].handle < 0)
+        hint_locks[slot].handle = 0;
+
+    if (num_resources > SIM_MAX_RESOURCES)
+        num_resources = SIM_MAX_RESOURCES;
+    for (i = 0; i < num_resources; i++)
+        hint_locks[slot].resources[i] = resource_values[i];
+    hint_locks[slot].num_resources = num_resources;
+}
+
+int get_active_hint_resources(int hint_id, int resources[], int max)
+{
+    int i, j;
+
+    for (i = 0; i < MAX_HINT_LOCKS; i++) {
+        if (!hint_locks[i].handle || hint_locks[i].hint_id != hint_id)
+            continue;
+        for (j = 0; j < hint_locks[i].num_resources && j < max; j++)
+            resources[j] = hint_locks[i].resources[j];
+        return j;
+    }
+
+    return 0;
+}
+
+void undo_hint_action(int hint_id)
+{
+    int i;
+
+    for (i = 0; i < MAX_HINT_LOCKS; i++) {
+        if (hint_locks[i].handle && hint_locks[i].hint_id == hint_id) {
+            sim_lock_release(hint_locks[i].handle);
+            hint_locks[i].handle = 0;
+        }
+    }
+}
+
+int interaction_with_handle(int lock_handle, int duration, int num_args,
+        int opt_list[])
+{
+    if (duration < 0 || num_args < 1 || opt_list[0] == 0)
+        return 0;
+
+    lock_handle = sim_lock_acquire(lock_handle, duration, opt_list, num_args);
+
+    return lock_handle > 0 ? lock_handle : 0;
+}
+
+void release_request(int lock_handle)
+{
+    sim_lock_release(lock_handle);
+}
+
+/*
+ * As in utils.c, with boost-policy.c deciding the boost. The model has
+ * no PM QoS, devfreq or block queues, so only the shared perflock can
+ * make a boost take effect.
+ */
+static void boost(int type, int duration, int num_args, int opt_list[])
+{
+    static int lock_handle = 0;
+    struct boost_request req;
+
+    if (!boost_policy_prepare(type, duration, num_args, opt_list, &req))
+        return;
+
+    lock_handle = interaction_with_handle(lock_handle, req.duration_ms,
+            req.num_resources, req.resources);
+    if (lock_handle > 0)
+        boost_policy_applied(&req);
+}
+
+void interaction(int duration, int num_args, int opt_list[])
+{
+    boost(BOOST_INTERACTION, duration, num_args, opt_list);
+}
+
+void launch_boost(int duration, int num_args, int opt_list[])
+{
+    boost(BOOST_LAUNCH, duration, num_args, opt_list);
+}
+
+const struct hint_vector *hint_table_lookup(const hint_table_t table,
+        int type, int governor)
+{
+    const struct hint_vector *vector;
+
+    if (type < 0 || type >= HINT_TYPE_COUNT ||
+            governor < 0 || governor >= GOVERNOR_COUNT)
+        return NULL;
+
+    vector = &table[type][governor];
+
+    return vector->num_resources > 0 ? vector : NULL;
+}
+
+void perform_hint_vector(int hint_id, const struct hint_vector *vector)
+{
+    perform_hint_action(hint_id, (int *)vector->resources,
+            vector->num_resources);
+}
+
+int hint_table_dispatch(const hint_table_t table, int type, int hint_id,
+        int state, __attribute__((unused)) int client_pid)
+{
+    const struct hint_vector *vector;
+
+    vector = hint_table_lookup(table, type, get_scaling_governor_id());
+    if (!vector)
+        return HINT_NONE;
+
+    if (state == 1)
+        perform_hint_vector(hint_id, vector);
+    else if (state == 0)
+        undo_hint_action(hint_id);
+    else
+        return HINT_NONE;
+
+    return HINT_HANDLED;
+}
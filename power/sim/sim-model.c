@@ -0,0 +1,670 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * Model CPU for powersim.
+ *
+ * Clusters of identical CPUs share a frequency, picked every governor
+ * window the way interactive does: high enough to bring the busiest
+ * CPU's load under target_load. Perflock resource lists are decoded
+ * into frequency floors and caps, online core limits, sched_boost and
+ * power collapse; other opcodes are counted as unmodeled. Work is
+ * split into tasks that run first come, first served on the first
+ * cluster with a free CPU, the biggest one first under sched_boost.
+ * Energy is what busy CPUs draw, plus the idle draw of CPUs that a
+ * lock keeps out of power collapse. Time advances in 1 ms steps.
+ */
+
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "performance.h"
+#include "sim-model.h"
+
+#define MAX_TASKS               (256)
+#define MAX_UNMODELED           (64)
+
+/* Per-CPU opcode bases, as in utils.c; the low byte is in 100 MHz. */
+static const int cpu_min_freq_opcode[SIM_MAX_CPUS] = {
+    0x200, 0x300, 0x400, 0x500, 0x1F00, 0x2000, 0x2100, 0x2200
+};
+
+static const int cpu_max_freq_opcode[SIM_MAX_CPUS] = {
+    0x1500, 0x1600, 0x1700, 0x1800, 0x2300, 0x2400, 0x2500, 0x2600
+};
+
+struct sim_lock {
+    int handle;
+    /* 0 if held until released */
+    long long expiry_ms;
+    int num_resources;
+    int resources[SIM_MAX_RESOURCES];
+};
+
+struct sim_item {
+    int kind;
+    int parts_left;
+    long long submitted_ms;
+    double done_ms;
+};
+
+struct sim_task {
+    int item;
+    double mcycles;
+};
+
+struct cluster_state {
+    int opp;
+    int floor_opp;
+    int cap_opp;
+    int min_cpus;
+    int max_cpus;
+    int window_ms;
+    /* The governor's window; perflocks may shorten the model's */
+    int timer_rate_ms;
+    double busy_ms[SIM_MAX_CPUS];
+};
+
+static const struct sim_model *model;
+static int verbose;
+static long long now_ms;
+
+static struct sim_lock locks[SIM_MAX_LOCKS];
+static int next_handle;
+static struct cluster_state clusters[SIM_MAX_CLUSTERS];
+static int sched_boost;
+static int no_collapse;
+
+static struct sim_item *items;
+static int num_items;
+static int max_items;
+static struct sim_task tasks[MAX_TASKS];
+static int num_tasks;
+
+static double energy_mj;
+static long long boosted_ms;
+static int unmodeled[MAX_UNMODELED];
+static int num_unmodeled;
+
+int sim_model_load(const char *path, struct sim_model *m)
+{
+    struct sim_cluster *c = NULL;
+    struct sim_opp *opp;
+    char line[256], word[16];
+    char *p;
+    FILE *f;
+    int lineno = 0, a, b, d, i;
+
+    memset(m, 0, sizeof(*m));
+    m->timer_rate_ms = 20;
+    m->target_load = 90;
+
+    f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), f)) {
+        lineno++;
+        p = strchr(line, '#');
+        if (p)
+            *p = '\0';
+        if (sscanf(line, "%15s", word) != 1)
+            continue;
+
+        if (!strcmp(word, "timer_rate") &&
+                sscanf(line, "%*s %d", &m->timer_rate_ms) == 1)
+            continue;
+
+        if (!strcmp(word, "target_load") &&
+                sscanf(line, "%*s %d", &m->target_load) == 1)
+            continue;
+
+        /* cluster <first_cpu> <num_cpus> <capacity> */
+        if (!strcmp(word, "cluster") && m->num_clusters < SIM_MAX_CLUSTERS &&
+                sscanf(line, "%*s %d %d %d", &a, &b, &d) == 3 &&
+                a >= 0 && b > 0 && a + b <= SIM_MAX_CPUS && d > 0) {
+            c = &m->clusters[m->num_clusters++];
+            c->first_cpu = a;
+            c->num_cpus = b;
+            c->capacity = d;
+            continue;
+        }
+
+        /* opp <khz> <busy_mw> <idle_mw>, ascending, for the last cluster */
+        if (!strcmp(word, "opp") && c && c->num_opps < SIM_MAX_OPPS &&
+                sscanf(line, "%*s %d %d %d", &a, &b, &d) == 3 && a > 0 &&
+                (c->num_opps == 0 || a > c->opps[c->num_opps - 1].khz)) {
+            opp = &c->opps[c->num_opps++];
+            opp->khz = a;
+            opp->busy_mw = b;
+            opp->idle_mw = d;
+            continue;
+        }
+
+        fprintf(stderr, "%s:%d: bad '%s' line\n", path, lineno, word);
+        fclose(f);
+        return -1;
+    }
+    fclose(f);
+
+    if (m->num_clusters == 0 || m->timer_rate_ms <= 0 ||
+            m->target_load <= 0 || m->target_load > 100) {
+        fprintf(stderr, "%s: no clusters, or bad governor settings\n", path);
+        return -1;
+    }
+
+    for (i = 0; i < m->num_clusters; i++) {
+        if (m->clusters[i].num_opps == 0) {
+            fprintf(stderr, "%s: cluster %d has no opps\n", path, i);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static int opp_at_least(const struct sim_cluster *c, long long khz)
+{
+    int i;
+
+    for (i = 0; i < c->num_opps; i++) {
+        if (c->opps[i].khz >= khz)
+            return i;
+    }
+
+    return c->num_opps - 1;
+}
+
+static int opp_at_most(const struct sim_cluster *c, long long khz)
+{
+    int i;
+
+    for (i = c->num_opps - 1; i > 0; i--) {
+        if (c->opps[i].khz <= khz)
+            return i;
+    }
+
+    return 0;
+}
+
+static void note_unmodeled(int opcode)
+{
+    int i;
+
+    for (i = 0; i < num_unmodeled; i++) {
+        if (unmodeled[i] == opcode)
+            return;
+    }
+
+    if (num_unmodeled < MAX_UNMODELED)
+        unmodeled[num_unmodeled++] = opcode;
+}
+
+static void apply_opcode(int opcode, long long floor_khz[],
+        long long cap_khz[], int min_cpus[], int max_cpus[], int rate_ms[])
+{
+    int base = opcode & ~0xFF, level = opcode & 0xFF;
+    long long khz = level >= 0xFE ? LLONG_MAX : level * 100000LL;
+    int cpu, i;
+
+    for (cpu = 0; cpu < SIM_MAX_CPUS; cpu++) {
+        if (base == cpu_min_freq_opcode[cpu]) {
+            if (khz > floor_khz[cpu])
+                floor_khz[cpu] = khz;
+            return;
+        }
+        if (base == cpu_max_freq_opcode[cpu]) {
+            if (khz < cap_khz[cpu])
+                cap_khz[cpu] = khz;
+            return;
+        }
+    }
+
+    /* Core counts, decoded as core-ctl.c does */
+    if (base == 0x700 && opcode != CPUS_ONLINE_MPD_OVERRIDE) {
+        if (level == 0xFF) {
+            for (i = 0; i < model->num_clusters; i++)
+                min_cpus[i] = model->clusters[i].num_cpus;
+        } else if (level > min_cpus[0]) {
+            min_cpus[0] = level;
+        }
+        return;
+    }
+
+    if (base == 0x800) {
+        if (0xFF - level < max_cpus[0])
+            max_cpus[0] = 0xFF - level;
+        return;
+    }
+
+    if (base == 0x4D00 && model->num_clusters > 1) {
+        if (level > min_cpus[1])
+            min_cpus[1] = level;
+        return;
+    }
+
+    if (base == 0x3D00 && model->num_clusters > 1) {
+        if (0xFF - level < max_cpus[1])
+            max_cpus[1] = 0xFF - level;
+        return;
+    }
+
+    /* TR_MS_*: every cluster, cpu0's or cpu4's; the shortest wins */
+    if (base == 0xE00 || base == 0x3000 || base == 0x3B00) {
+        for (i = 0; i < model->num_clusters; i++) {
+            const struct sim_cluster *c = &model->clusters[i];
+
+            cpu = base == 0x3000 ? 0 : 4;
+            if (base != 0xE00 && (cpu < c->first_cpu ||
+                        cpu >= c->first_cpu + c->num_cpus))
+                continue;
+            if ((0xFF - level) * 10 < rate_ms[i])
+                rate_ms[i] = (0xFF - level) * 10;
+        }
+        return;
+    }
+
+    if (opcode == SCHED_BOOST_ON) {
+        sched_boost = 1;
+        return;
+    }
+
+    if (opcode == ALL_CPUS_PWR_CLPS_DIS) {
+        no_collapse = 1;
+        return;
+    }
+
+    note_unmodeled(opcode);
+}
+
+/*
+ * Combine the active locks: the highest floor and lowest cap win, and
+ * a cap beats a floor. The HAL already clamps boosts to the profile's
+ * ceilings before taking the lock.
+ */
+static void update_limits(void)
+{
+    long long floor_khz[SIM_MAX_CPUS], cap_khz[SIM_MAX_CPUS];
+    int min_cpus[SIM_MAX_CLUSTERS], max_cpus[SIM_MAX_CLUSTERS];
+    int rate_ms[SIM_MAX_CLUSTERS];
+    const struct sim_cluster *c;
+    struct cluster_state *s;
+    int i, j, cpu, opp;
+
+    for (cpu = 0; cpu < SIM_MAX_CPUS; cpu++) {
+        floor_khz[cpu] = 0;
+        cap_khz[cpu] = LLONG_MAX;
+    }
+    for (i = 0; i < model->num_clusters; i++) {
+        min_cpus[i] = 0;
+        max_cpus[i] = model->clusters[i].num_cpus;
+        rate_ms[i] = model->timer_rate_ms;
+    }
+    sched_boost = 0;
+    no_collapse = 0;
+
+    for (i = 0; i < SIM_MAX_LOCKS; i++) {
+        for (j = 0; locks[i].handle && j < locks[i].num_resources; j++)
+            apply_opcode(locks[i].resources[j], floor_khz, cap_khz,
+                    min_cpus, max_cpus, rate_ms);
+    }
+
+    for (i = 0; i < model->num_clusters; i++) {
+        c = &model->clusters[i];
+        s = &clusters[i];
+
+        s->floor_opp = 0;
+        s->cap_opp = c->num_opps - 1;
+        for (cpu = c->first_cpu; cpu < c->first_cpu + c->num_cpus; cpu++) {
+            opp = floor_khz[cpu] ? opp_at_least(c, floor_khz[cpu]) : 0;
+            if (opp > s->floor_opp)
+                s->floor_opp = opp;
+            opp = opp_at_most(c, cap_khz[cpu]);
+            if (opp < s->cap_opp)
+                s->cap_opp = opp;
+        }
+        if (s->floor_opp > s->cap_opp)
+            s->floor_opp = s->cap_opp;
+        s->timer_rate_ms = rate_ms[i] > 0 ? rate_ms[i] : 1;
+
+        /* The boot CPU can't be taken offline. */
+        s->max_cpus = max_cpus[i] < 1 && c->first_cpu == 0 ? 1 : max_cpus[i];
+        s->min_cpus = min_cpus[i] > s->max_cpus ? s->max_cpus : min_cpus[i];
+
+        if (s->opp < s->floor_opp)
+            s->opp = s->floor_opp;
+        if (s->opp > s->cap_opp)
+            s->opp = s->cap_opp;
+    }
+}
+
+static void print_lock(FILE *f, const struct sim_lock *lock)
+{
+    int i;
+
+    if (lock->num_resources) {
+        fprintf(f, " for %lld ms, %d resource%s [",
+                lock->expiry_ms ? lock->expiry_ms - now_ms : 0,
+                lock->num_resources, lock->num_resources == 1 ? "" : "s");
+        for (i = 0; i < lock->num_resources; i++)
+            fprintf(f, "%s0x%x", i ? " " : "", lock->resources[i]);
+        fprintf(f, "]");
+    }
+    fprintf(f, "\n");
+}
+
+static void dump_lock(const char *what, const struct sim_lock *lock)
+{
+    fprintf(stderr, "%6lld ms: %s lock %d", now_ms, what, lock->handle);
+    print_lock(stderr, lock);
+}
+
+void sim_init(const struct sim_model *m, int v)
+{
+    model = m;
+    verbose = v;
+    now_ms = 0;
+    memset(locks, 0, sizeof(locks));
+    next_handle = 1;
+    memset(clusters, 0, sizeof(clusters));
+    num_items = 0;
+    num_tasks = 0;
+    energy_mj = 0;
+    boosted_ms = 0;
+    num_unmodeled = 0;
+
+    update_limits();
+}
+
+long long sim_now_ms(void)
+{
+    return now_ms;
+}
+
+/* Take or update a lock, like perf_lock_acq(); 0 holds it. */
+int sim_lock_acquire(int handle, int duration_ms, const int resources[],
+        int num_resources)
+{
+    struct sim_lock *lock = NULL;
+    int i;
+
+    for (i = 0; handle > 0 && i < SIM_MAX_LOCKS; i++) {
+        if (locks[i].handle == handle)
+            lock = &locks[i];
+    }
+    for (i = 0; !lock && i < SIM_MAX_LOCKS; i++) {
+        if (!locks[i].handle) {
+            lock = &locks[i];
+            lock->handle = next_handle++;
+        }
+    }
+    if (!lock)
+        return -1;
+
+    if (num_resources > SIM_MAX_RESOURCES)
+        num_resources = SIM_MAX_RESOURCES;
+    lock->num_resources = num_resources;
+    for (i = 0; i < num_resources; i++)
+        lock->resources[i] = resources[i];
+    lock->expiry_ms = duration_ms > 0 ? now_ms + duration_ms : 0;
+
+    if (verbose)
+        dump_lock("acquire", lock);
+
+    update_limits();
+
+    return lock->handle;
+}
+
+void sim_lock_release(int handle)
+{
+    int i;
+
+    for (i = 0; handle > 0 && i < SIM_MAX_LOCKS; i++) {
+        if (locks[i].handle == handle) {
+            locks[i].num_resources = 0;
+            if (verbose)
+                dump_lock("release", &locks[i]);
+            locks[i].handle = 0;
+            update_limits();
+        }
+    }
+}
+
+/* Queue mcycles of work split over 'threads' tasks. */
+int sim_submit(int kind, double mcycles, int threads)
+{
+    struct sim_item *item;
+    int i;
+
+    if (kind < 0 || kind >= SIM_WORK_COUNT || mcycles <= 0 || threads < 1 ||
+            num_tasks + threads > MAX_TASKS)
+        return -1;
+
+    if (num_items == max_items) {
+        max_items = max_items ? max_items * 2 : 1024;
+        items = realloc(items, max_items * sizeof(*items));
+        if (!items)
+            abort();
+    }
+
+    item = &items[num_items];
+    item->kind = kind;
+    item->parts_left = threads;
+    item->submitted_ms = now_ms;
+    item->done_ms = -1;
+
+    for (i = 0; i < threads; i++) {
+        tasks[num_tasks].item = num_items;
+        tasks[num_tasks].mcycles = mcycles / threads;
+        num_tasks++;
+    }
+
+    return num_items++;
+}
+
+int sim_busy(void)
+{
+    return num_tasks > 0;
+}
+
+static void expire_locks(void)
+{
+    int i, expired = 0;
+
+    for (i = 0; i < SIM_MAX_LOCKS; i++) {
+        if (locks[i].handle && locks[i].expiry_ms &&
+                locks[i].expiry_ms <= now_ms) {
+            locks[i].num_resources = 0;
+            if (verbose)
+                dump_lock("expire", &locks[i]);
+            locks[i].handle = 0;
+            expired = 1;
+        }
+    }
+
+    if (expired)
+        update_limits();
+}
+
+/*
+ * The locks held right now, "for 0 ms" meaning until released, and
+ * the limits they add up to on each cluster.
+ */
+void sim_dump_state(FILE *f)
+{
+    const struct sim_cluster *c;
+    const struct cluster_state *s;
+    int i;
+
+    /* As the next step would; the dump then matches what it runs with. */
+    expire_locks();
+
+    for (i = 0; i < SIM_MAX_LOCKS; i++) {
+        if (!locks[i].handle)
+            continue;
+        fprintf(f, "    lock %d", locks[i].handle);
+        print_lock(f, &locks[i]);
+    }
+
+    for (i = 0; i < model->num_clusters; i++) {
+        c = &model->clusters[i];
+        s = &clusters[i];
+        fprintf(f, "    cluster %d: %d-%d kHz, %d-%d cpus, %d ms window%s%s\n",
+                i, c->opps[s->floor_opp].khz, c->opps[s->cap_opp].khz,
+                s->min_cpus, s->max_cpus, s->timer_rate_ms,
+                sched_boost ? ", sched boost" : "",
+                no_collapse ? ", no power collapse" : "");
+    }
+}
+
+/* Interactive: the lowest frequency that keeps the load under target. */
+static void governor_window(int i)
+{
+    const struct sim_cluster *c = &model->clusters[i];
+    struct cluster_state *s = &clusters[i];
+    double load = 0;
+    int cpu, opp;
+
+    for (cpu = 0; cpu < c->num_cpus; cpu++) {
+        if (s->busy_ms[cpu] / s->window_ms > load)
+            load = s->busy_ms[cpu] / s->window_ms;
+        s->busy_ms[cpu] = 0;
+    }
+    s->window_ms = 0;
+
+    opp = opp_at_least(c, (long long)(c->opps[s->opp].khz * load * 100 /
+            model->target_load));
+    if (opp < s->floor_opp)
+        opp = s->floor_opp;
+    if (opp > s->cap_opp)
+        opp = s->cap_opp;
+    s->opp = opp;
+}
+
+/* Advance the model by one millisecond. */
+void sim_step(void)
+{
+    int order[SIM_MAX_CLUSTERS], busy[SIM_MAX_CLUSTERS];
+    const struct sim_cluster *c;
+    const struct sim_opp *opp;
+    struct cluster_state *s;
+    struct sim_task *task;
+    struct sim_item *item;
+    double rate, used;
+    int i, j, k, held, boosted, kept = 0;
+
+    expire_locks();
+    boosted = sched_boost;
+
+    for (i = 0; i < model->num_clusters; i++) {
+        order[i] = i;
+        busy[i] = 0;
+    }
+    if (sched_boost && model->num_clusters > 1 &&
+            model->clusters[1].capacity > model->clusters[0].capacity) {
+        order[0] = 1;
+        order[1] = 0;
+    }
+
+    for (j = 0; j < num_tasks; j++) {
+        task = &tasks[j];
+
+        for (k = 0; k < model->num_clusters; k++) {
+            if (busy[order[k]] < clusters[order[k]].max_cpus)
+                break;
+        }
+        if (k == model->num_clusters) {
+            tasks[kept++] = *task;
+            continue;
+        }
+
+        i = order[k];
+        c = &model->clusters[i];
+        s = &clusters[i];
+        opp = &c->opps[s->opp];
+
+        /* Megacycles per ms at this frequency */
+        rate = opp->khz / 1000000.0 * c->capacity / 100;
+        used = task->mcycles < rate ? task->mcycles / rate : 1.0;
+
+        s->busy_ms[busy[i]++] += used;
+        energy_mj += opp->busy_mw * used / 1000;
+        task->mcycles -= rate * used;
+
+        if (task->mcycles > 1e-9) {
+            tasks[kept++] = *task;
+            continue;
+        }
+
+        item = &items[task->item];
+        if (--item->parts_left == 0)
+            item->done_ms = now_ms + used - item->submitted_ms;
+    }
+    num_tasks = kept;
+
+    for (i = 0; i < model->num_clusters; i++) {
+        s = &clusters[i];
+        held = no_collapse ? s->max_cpus : s->min_cpus;
+        if (held > busy[i])
+            energy_mj += (held - busy[i]) *
+                    model->clusters[i].opps[s->opp].idle_mw / 1000.0;
+
+        if (s->floor_opp > 0 || s->min_cpus > 0)
+            boosted = 1;
+
+        if (++s->window_ms >= s->timer_rate_ms)
+            governor_window(i);
+    }
+
+    boosted_ms += boosted;
+    now_ms++;
+}
+
+/* The caller frees the latency arrays. */
+void sim_get_result(struct sim_result *result)
+{
+    int i, kind;
+
+    memset(result, 0, sizeof(*result));
+
+    for (kind = 0; kind < SIM_WORK_COUNT; kind++)
+        result->latency_ms[kind] = malloc((num_items + 1) * sizeof(double));
+
+    for (i = 0; i < num_items; i++) {
+        kind = items[i].kind;
+        if (items[i].done_ms < 0)
+            result->unfinished++;
+        else
+            result->latency_ms[kind][result->num_done[kind]++] =
+                    items[i].done_ms;
+    }
+
+    result->energy_mj = energy_mj;
+    result->boosted_ms = boosted_ms;
+    result->unmodeled = num_unmodeled;
+
+    if (verbose) {
+        for (i = 0; i < num_unmodeled; i++)
+            fprintf(stderr, "not modeled: 0x%x\n", unmodeled[i]);
+    }
+}
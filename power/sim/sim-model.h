@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef _QCOM_SIM_MODEL_H
+#define _QCOM_SIM_MODEL_H
+
+#include <stdio.h>
+
+#define SIM_MAX_CLUSTERS        (2)
+#define SIM_MAX_CPUS            (8)
+#define SIM_MAX_OPPS            (32)
+#define SIM_MAX_LOCKS           (32)
+#define SIM_MAX_RESOURCES       (32)
+
+enum {
+    SIM_WORK_FRAME = 0,
+    SIM_WORK_LAUNCH,
+    SIM_WORK_BACKGROUND,
+    SIM_WORK_COUNT,
+};
+
+/* An operating point; power is per CPU at this frequency. */
+struct sim_opp {
+    int khz;
+    /* Running, and idle but held out of power collapse */
+    int busy_mw;
+    int idle_mw;
+};
+
+struct sim_cluster {
+    int first_cpu;
+    int num_cpus;
+    /* Work done per MHz, relative to 100 */
+    int capacity;
+    int num_opps;
+    struct sim_opp opps[SIM_MAX_OPPS];
+};
+
+struct sim_model {
+    /* Interactive governor window and target load in percent */
+    int timer_rate_ms;
+    int target_load;
+    int num_clusters;
+    struct sim_cluster clusters[SIM_MAX_CLUSTERS];
+};
+
+struct sim_result {
+    /* Completion times in ms, in submission order */
+    int num_done[SIM_WORK_COUNT];
+    double *latency_ms[SIM_WORK_COUNT];
+    int unfinished;
+    double energy_mj;
+    /* Milliseconds a perflock raised a floor or held a core online */
+    long long boosted_ms;
+    /* Opcodes the model does not act on, counted once each */
+    int unmodeled;
+};
+
+int sim_model_load(const char *path, struct sim_model *model);
+
+void sim_init(const struct sim_model *model, int verbose);
+long long sim_now_ms(void);
+int sim_lock_acquire(int handle, int duration_ms, const int resources[],
+        int num_resources);
+void sim_lock_release(int handle);
+int sim_submit(int kind, double mcycles, int threads);
+int sim_busy(void);
+void sim_step(void);
+void sim_get_result(struct sim_result *result);
+void sim_dump_state(FILE *f);
+
+#endif
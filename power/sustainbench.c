@@ -0,0 +1,286 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * sustainbench: throughput stability of the performance profiles.
+ *
+ *   sustainbench [-t seconds] [-c cooldown] [-j threads] [-v]
+ *
+ * Loads the power HAL into this process and runs a fixed integer
+ * workload on every core, first under the high performance profile
+ * and then under sustained performance, letting the device cool down
+ * on balanced before each. Throughput is sampled once a second, and
+ * the mean, spread and coefficient of variation of the samples are
+ * printed per profile along with the hottest thermal zone seen. -v
+ * also prints every sample, to see the throttling sawtooth.
+ *
+ * The first sustained run on a device includes its calibration, so
+ * run long enough for the caps to settle (the default is ten minutes
+ * a profile) or run it twice. Leaves the HAL on balanced.
+ */
+
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <hardware/hardware.h>
+#include <hardware/power.h>
+
+#include "power-common.h"
+
+#define DEFAULT_SECONDS     (600)
+#define DEFAULT_COOLDOWN    (120)
+#define MAX_SECONDS         (3600)
+#define MAX_THREADS         (16)
+#define MAX_THERMAL_ZONES   (64)
+
+/* Iterations per counted unit of work */
+#define WORK_UNIT           (1 << 20)
+
+struct run {
+    const char *name;
+    int profile;
+    long long *samples;
+    int max_temp;
+};
+
+static volatile int stop;
+static volatile unsigned int sink;
+static unsigned long long units[MAX_THREADS];
+
+static void *worker(void *arg)
+{
+    unsigned long long *count = arg;
+    unsigned int x = (unsigned int)(count - units) + 1;
+    int i;
+
+    while (!stop) {
+        for (i = 0; i < WORK_UNIT; i++)
+            x = x * 1103515245 + 12345;
+        sink = x;
+        __atomic_add_fetch(count, 1, __ATOMIC_RELAXED);
+    }
+
+    return NULL;
+}
+
+static unsigned long long total_units(int threads)
+{
+    unsigned long long total = 0;
+    int i;
+
+    for (i = 0; i < threads; i++)
+        total += __atomic_load_n(&units[i], __ATOMIC_RELAXED);
+
+    return total;
+}
+
+static int read_max_temp(void)
+{
+    char path[80], buf[16];
+    FILE *f;
+    int i, temp, max_temp = -1;
+
+    for (i = 0; i < MAX_THERMAL_ZONES; i++) {
+        snprintf(path, sizeof(path), "/sys/class/thermal/thermal_zone%d/temp", i);
+        f = fopen(path, "r");
+        if (!f) {
+            if (errno == ENOENT)
+                break;
+            continue;
+        }
+        if (fgets(buf, sizeof(buf), f)) {
+            temp = atoi(buf);
+            /* Some kernels report millidegrees, msm tsens reports degrees. */
+            if (temp > 1000)
+                temp /= 1000;
+            if (temp > max_temp)
+                max_temp = temp;
+        }
+        fclose(f);
+    }
+
+    return max_temp;
+}
+
+static void set_profile(power_module_t *module, int profile)
+{
+    int32_t value = profile;
+
+    module->powerHint(module, POWER_HINT_SET_PROFILE, &value);
+}
+
+static int run_profile(power_module_t *module, struct run *run, int seconds,
+        int cooldown, int threads, int verbose)
+{
+    pthread_t tids[MAX_THREADS];
+    unsigned long long last, now;
+    int i, temp;
+
+    set_profile(module, PROFILE_BALANCED);
+    fprintf(stderr, "%s: cooling down for %d s\n", run->name, cooldown);
+    sleep(cooldown);
+
+    set_profile(module, run->profile);
+    memset(units, 0, sizeof(units));
+    stop = 0;
+    for (i = 0; i < threads; i++) {
+        if (pthread_create(&tids[i], NULL, worker, &units[i])) {
+            fprintf(stderr, "can't start worker %d\n", i);
+            stop = 1;
+            while (i--)
+                pthread_join(tids[i], NULL);
+            return -1;
+        }
+    }
+
+    run->max_temp = -1;
+    last = total_units(threads);
+    for (i = 0; i < seconds; i++) {
+        sleep(1);
+        now = total_units(threads);
+        run->samples[i] = now - last;
+        last = now;
+        temp = read_max_temp();
+        if (temp > run->max_temp)
+            run->max_temp = temp;
+        if (verbose)
+            printf("%-24s %4d s %8lld units %4d C\n", run->name, i + 1,
+                    run->samples[i], temp);
+    }
+
+    stop = 1;
+    for (i = 0; i < threads; i++)
+        pthread_join(tids[i], NULL);
+
+    return 0;
+}
+
+static void print_run(const struct run *run, int seconds)
+{
+    long long min = run->samples[0], max = run->samples[0];
+    double mean = 0, var = 0;
+    int i;
+
+    for (i = 0; i < seconds; i++) {
+        mean += run->samples[i];
+        if (run->samples[i] < min)
+            min = run->samples[i];
+        if (run->samples[i] > max)
+            max = run->samples[i];
+    }
+    mean /= seconds;
+    for (i = 0; i < seconds; i++)
+        var += (run->samples[i] - mean) * (run->samples[i] - mean);
+    var /= seconds;
+
+    printf("%-24s %10.1f %8.1f %6.2f%% %8lld %8lld %6d\n", run->name, mean,
+            sqrt(var), mean > 0 ? 100 * sqrt(var) / mean : 0.0, min, max,
+            run->max_temp);
+}
+
+int main(int argc, char *argv[])
+{
+    struct run runs[] = {
+        { "high_performance",       PROFILE_HIGH_PERFORMANCE,      NULL, -1 },
+        { "sustained_performance",  PROFILE_SUSTAINED_PERFORMANCE, NULL, -1 },
+    };
+    int num_runs = sizeof(runs) / sizeof(runs[0]);
+    power_module_t *module;
+    int seconds = DEFAULT_SECONDS, cooldown = DEFAULT_COOLDOWN;
+    int threads = sysconf(_SC_NPROCESSORS_CONF);
+    int verbose = 0;
+    int opt, i, ret = 1;
+
+    while ((opt = getopt(argc, argv, "t:c:j:v")) != -1) {
+        switch (opt) {
+        case 't':
+            seconds = atoi(optarg);
+            break;
+        case 'c':
+            cooldown = atoi(optarg);
+            break;
+        case 'j':
+            threads = atoi(optarg);
+            break;
+        case 'v':
+            verbose = 1;
+            break;
+        default:
+            goto usage;
+        }
+    }
+
+    if (optind != argc || seconds < 2 || seconds > MAX_SECONDS ||
+            cooldown < 0 || threads < 1)
+        goto usage;
+    if (threads > MAX_THREADS)
+        threads = MAX_THREADS;
+
+    if (hw_get_module(POWER_HARDWARE_MODULE_ID,
+                (const hw_module_t **)&module)) {
+        fprintf(stderr, "can't load the power HAL\n");
+        return 1;
+    }
+    if (module->init)
+        module->init(module);
+
+    if (!module->getFeature || module->getFeature(module,
+                POWER_FEATURE_SUPPORTED_PROFILES) <=
+            PROFILE_SUSTAINED_PERFORMANCE) {
+        fprintf(stderr, "this target has no sustained performance profile\n");
+        return 1;
+    }
+
+    for (i = 0; i < num_runs; i++) {
+        runs[i].samples = calloc(seconds, sizeof(long long));
+        if (!runs[i].samples) {
+            fprintf(stderr, "out of memory\n");
+            goto out;
+        }
+    }
+
+    for (i = 0; i < num_runs; i++) {
+        if (run_profile(module, &runs[i], seconds, cooldown, threads,
+                    verbose))
+            goto out;
+    }
+
+    printf("%d threads, %d s a profile, units of work per second\n",
+            threads, seconds);
+    printf("%-24s %10s %8s %7s %8s %8s %6s\n", "profile", "mean", "stddev",
+            "cov", "min", "max", "max_C");
+    for (i = 0; i < num_runs; i++)
+        print_run(&runs[i], seconds);
+    ret = 0;
+
+out:
+    set_profile(module, PROFILE_BALANCED);
+    for (i = 0; i < num_runs; i++)
+        free(runs[i].samples);
+    return ret;
+
+usage:
+    fprintf(stderr, "usage: %s [-t seconds] [-c cooldown] [-j threads] [-v]\n",
+            argv[0]);
+    return 2;
+}
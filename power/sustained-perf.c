@@ -0,0 +1,491 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Sustained performance profile.
+ *
+ * Pinning every core at turbo thermally throttles within minutes and
+ * gives a sawtooth. Instead, lock each cluster at a single frequency
+ * (min == max) and walk that cap down while the hottest tsens sensor
+ * is above SUSTAINED_TEMP_HIGH, and slowly back up while it stays below
+ * SUSTAINED_TEMP_LOW. Once the caps have not moved for
+ * SUSTAINED_STABLE_MS they are written to SUSTAINED_PERF_CACHE and used
+ * as the starting point the next time the profile is selected.
+ */
+
+#define LOG_NIDEBUG 0
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define LOG_TAG "QCOM PowerHAL"
+#include <utils/Log.h>
+
+#include "utils.h"
+#include "power-common.h"
+#include "power-timer.h"
+#include "sustained-perf.h"
+#include "socinfo.h"
+
+#define MAX_THERMAL_ZONES (32)
+
+#define POLICY_FREQS_PATH \
+    "/sys/devices/system/cpu/cpufreq/policy%d/scaling_available_frequencies"
+#define CPU_FREQS_PATH \
+    "/sys/devices/system/cpu/cpu%d/cpufreq/scaling_available_frequencies"
+
+struct cluster_state {
+    int first_cpu;
+    int num_cpus;
+    int freqs[SUSTAINED_MAX_FREQS];
+    int num_freqs;
+    int level;
+};
+
+static pthread_mutex_t sustained_mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct power_timer poll_timer;
+
+static struct cluster_state clusters[SUSTAINED_MAX_CLUSTERS];
+static int num_clusters;
+static int thermal_zones[MAX_THERMAL_ZONES];
+static int num_thermal_zones;
+static int soc_id;
+
+static int active;
+/* Frequency tables read; retried while a whole cluster is offline */
+static int loaded;
+static int lock_handle;
+static int calibrated;
+static long long last_change_ms;
+static long long cool_since_ms;
+
+int __attribute__ ((weak)) get_sustained_perf_clusters(
+        __attribute__((unused)) const struct sustained_cluster **clusters)
+{
+    return 0;
+}
+
+static int compare_int(const void *a, const void *b)
+{
+    return *(const int *)a - *(const int *)b;
+}
+
+/*
+ * An offline CPU has no cpufreq directory. Newer kernels keep the
+ * policy directory around; otherwise ask any CPU of the cluster that
+ * is online.
+ */
+static int read_cluster_freqs(const struct cluster_state *cluster,
+        char *buf, int size)
+{
+    char path[PATH_MAX];
+    int cpu;
+
+    snprintf(path, sizeof(path), POLICY_FREQS_PATH, cluster->first_cpu);
+    if (access(path, F_OK) == 0 && sysfs_read(path, buf, size) == 0)
+        return 0;
+
+    for (cpu = cluster->first_cpu;
+            cpu < cluster->first_cpu + cluster->num_cpus; cpu++) {
+        snprintf(path, sizeof(path), CPU_FREQS_PATH, cpu);
+        if (access(path, F_OK) == 0 && sysfs_read(path, buf, size) == 0)
+            return 0;
+    }
+
+    return -1;
+}
+
+static int load_cluster_freqs(struct cluster_state *cluster)
+{
+    char buf[512];
+    char *token, *saveptr = NULL;
+
+    if (read_cluster_freqs(cluster, buf, sizeof(buf)) == -1)
+        return -1;
+
+    cluster->num_freqs = 0;
+    for (token = strtok_r(buf, " \n", &saveptr);
+            token && cluster->num_freqs < SUSTAINED_MAX_FREQS;
+            token = strtok_r(NULL, " \n", &saveptr)) {
+        int freq = atoi(token);
+
+        if (freq > 0)
+            cluster->freqs[cluster->num_freqs++] = freq;
+    }
+
+    qsort(cluster->freqs, cluster->num_freqs, sizeof(int), compare_int);
+    cluster->level = cluster->num_freqs - 1;
+
+    return cluster->num_freqs > 0 ? 0 : -1;
+}
+
+/* Prefer the tsens sensors; fall back to every zone the kernel exposes. */
+static void find_thermal_zones(void)
+{
+    char path[80];
+    char type[40];
+    int i, all = 0;
+
+retry:
+    num_thermal_zones = 0;
+    for (i = 0; i < 64 && num_thermal_zones < MAX_THERMAL_ZONES; i++) {
+        snprintf(path, sizeof(path), "/sys/class/thermal/thermal_zone%d/type", i);
+        if (access(path, F_OK) != 0)
+            break;
+        if (!all) {
+            if (sysfs_read(path, type, sizeof(type)) == -1)
+                continue;
+            if (strncmp(type, "tsens", strlen("tsens")) != 0)
+                continue;
+        }
+        thermal_zones[num_thermal_zones++] = i;
+    }
+
+    if (!num_thermal_zones && !all) {
+        all = 1;
+        goto retry;
+    }
+}
+
+static int read_max_temp(void)
+{
+    char path[80];
+    char buf[16];
+    int i, max_temp = -1;
+
+    for (i = 0; i < num_thermal_zones; i++) {
+        int temp;
+
+        snprintf(path, sizeof(path), "/sys/class/thermal/thermal_zone%d/temp",
+                thermal_zones[i]);
+        if (sysfs_read(path, buf, sizeof(buf)) == -1)
+            continue;
+
+        temp = atoi(buf);
+        /* Some kernels report millidegrees, msm tsens reports degrees. */
+        if (temp > 1000)
+            temp /= 1000;
+        if (temp > max_temp)
+            max_temp = temp;
+    }
+
+    return max_temp;
+}
+
+static void load_cache(void)
+{
+    char buf[80];
+    int cached_soc, freq[SUSTAINED_MAX_CLUSTERS] = { 0 };
+    int i, j, n;
+
+    if (access(SUSTAINED_PERF_CACHE, F_OK) != 0 ||
+            sysfs_read(SUSTAINED_PERF_CACHE, buf, sizeof(buf)) == -1)
+        return;
+
+    n = sscanf(buf, "%d %d %d", &cached_soc, &freq[0], &freq[1]);
+    if (n != num_clusters + 1 || cached_soc != soc_id) {
+        ALOGI("Ignoring stale sustained performance cache");
+        return;
+    }
+
+    for (i = 0; i < num_clusters; i++) {
+        for (j = clusters[i].num_freqs - 1; j > 0; j--) {
+            if (clusters[i].freqs[j] <= freq[i])
+                break;
+        }
+        clusters[i].level = j;
+    }
+    calibrated = 1;
+}
+
+static void save_cache(void)
+{
+    char buf[80];
+    int fd, i, len;
+
+    mkdir("/data/misc/power", 0771);
+
+    len = snprintf(buf, sizeof(buf), "%d", soc_id);
+    for (i = 0; i < num_clusters; i++) {
+        len += snprintf(buf + len, sizeof(buf) - len, " %d",
+                clusters[i].freqs[clusters[i].level]);
+    }
+    snprintf(buf + len, sizeof(buf) - len, "\n");
+
+    fd = open(SUSTAINED_PERF_CACHE, O_WRONLY | O_CREAT | O_TRUNC, 0660);
+    if (fd < 0) {
+        ALOGE("Unable to write %s: %s", SUSTAINED_PERF_CACHE, strerror(errno));
+        return;
+    }
+    if (write(fd, buf, strlen(buf)) < 0)
+        ALOGE("Unable to write %s: %s", SUSTAINED_PERF_CACHE, strerror(errno));
+    close(fd);
+}
+
+static int init_clusters(void)
+{
+    const struct sustained_cluster *desc;
+    int i;
+
+    num_clusters = get_sustained_perf_clusters(&desc);
+    if (num_clusters > SUSTAINED_MAX_CLUSTERS)
+        num_clusters = SUSTAINED_MAX_CLUSTERS;
+
+    for (i = 0; i < num_clusters; i++) {
+        clusters[i].first_cpu = desc[i].first_cpu;
+        clusters[i].num_cpus = desc[i].num_cpus;
+    }
+
+    soc_id = socinfo_get()->soc_id;
+
+    find_thermal_zones();
+
+    return num_clusters > 0 ? 0 : -1;
+}
+
+/* Returns 0 once every cluster has a frequency table. Called locked. */
+static int load_freqs(void)
+{
+    int i;
+
+    if (loaded)
+        return 0;
+
+    for (i = 0; i < num_clusters; i++) {
+        if (load_cluster_freqs(&clusters[i]) == -1)
+            return -1;
+    }
+
+    loaded = 1;
+    load_cache();
+
+    return 0;
+}
+
+/*
+ * Frequency opcodes carry a 100 MHz level, which perfd rounds up to an
+ * OPP for a floor and down to one for a cap, so the same level for both
+ * conflicts whenever the cap is not a multiple of 100 MHz. Cap at the
+ * highest level short of the next OPP up, then floor at the level the
+ * resulting OPP truncates to, which rounds back up to at most the cap.
+ */
+static void cluster_freq_limits(const struct cluster_state *c,
+        int *min_khz, int *max_khz)
+{
+    int j = c->level;
+
+    if (j < c->num_freqs - 1) {
+        *max_khz = (c->freqs[j + 1] - 1) / 100000 * 100000;
+        /* No level between this OPP and the next; settle for lower. */
+        while (j > 0 && c->freqs[j] > *max_khz)
+            j--;
+        if (c->freqs[j] > *max_khz)
+            *max_khz = c->freqs[j];
+    } else {
+        *max_khz = (c->freqs[j] + 99999) / 100000 * 100000;
+    }
+
+    *min_khz = c->freqs[j] / 100000 * 100000;
+}
+
+/* Pin every CPU of every cluster to its current cap. Called locked. */
+static void apply_caps(void)
+{
+    int resources[4 * SUSTAINED_MAX_CLUSTERS * 2];
+    int num_resources = 0;
+    int i, cpu;
+
+    for (i = 0; i < num_clusters; i++) {
+        int min_khz, max_khz;
+
+        cluster_freq_limits(&clusters[i], &min_khz, &max_khz);
+
+        for (cpu = clusters[i].first_cpu;
+                cpu < clusters[i].first_cpu + clusters[i].num_cpus &&
+                num_resources + 2 <= (int)(sizeof(resources)/sizeof(resources[0]));
+                cpu++) {
+            int min_opcode = get_cpu_freq_opcode(cpu, 0, min_khz);
+            int max_opcode = get_cpu_freq_opcode(cpu, 1, max_khz);
+
+            if (min_opcode && max_opcode) {
+                resources[num_resources++] = min_opcode;
+                resources[num_resources++] = max_opcode;
+            }
+        }
+    }
+
+    if (num_resources == 0)
+        return;
+
+    lock_handle = interaction_with_handle(lock_handle, 0, num_resources,
+            resources);
+    if (lock_handle < 0)
+        lock_handle = 0;
+}
+
+/*
+ * Throttle the cluster running fastest (the big one, normally) first,
+ * and give headroom back to the slowest one first.
+ */
+static int step_caps(int down)
+{
+    int i, pick = -1;
+
+    for (i = 0; i < num_clusters; i++) {
+        struct cluster_state *c = &clusters[i];
+        int freq = c->freqs[c->level];
+
+        if (down && c->level > 0) {
+            if (pick < 0 || freq >= clusters[pick].freqs[clusters[pick].level])
+                pick = i;
+        } else if (!down && c->level < c->num_freqs - 1) {
+            if (pick < 0 || freq < clusters[pick].freqs[clusters[pick].level])
+                pick = i;
+        }
+    }
+
+    if (pick < 0)
+        return 0;
+
+    clusters[pick].level += down ? -1 : 1;
+    ALOGD("%s: cpu%d cap %d kHz", __func__, clusters[pick].first_cpu,
+            clusters[pick].freqs[clusters[pick].level]);
+
+    return 1;
+}
+
+static void poll_timer_expired(__attribute__((unused)) void *data)
+{
+    long long now = power_timer_now_ms();
+    int temp, changed = 0;
+
+    pthread_mutex_lock(&sustained_mutex);
+    if (!active)
+        goto out;
+
+    if (!loaded) {
+        if (load_freqs() == 0) {
+            apply_caps();
+            last_change_ms = now;
+        }
+        goto rearm;
+    }
+
+    temp = read_max_temp();
+    if (temp < 0)
+        goto rearm;
+
+    if (temp >= SUSTAINED_TEMP_HIGH) {
+        changed = step_caps(1);
+        cool_since_ms = 0;
+        /* A cached cap that no longer holds needs recalibrating. */
+        if (changed)
+            calibrated = 0;
+    } else if (temp <= SUSTAINED_TEMP_LOW && !calibrated) {
+        if (!cool_since_ms)
+            cool_since_ms = now;
+        if (now - cool_since_ms >= SUSTAINED_STEP_UP_MS) {
+            changed = step_caps(0);
+            cool_since_ms = 0;
+        }
+    } else {
+        cool_since_ms = 0;
+    }
+
+    if (changed) {
+        apply_caps();
+        last_change_ms = now;
+    } else if (!calibrated && now - last_change_ms >= SUSTAINED_STABLE_MS) {
+        calibrated = 1;
+        save_cache();
+        ALOGI("Sustained performance caps calibrated at %dC", temp);
+    }
+
+rearm:
+    power_timer_arm(&poll_timer, SUSTAINED_POLL_MS);
+out:
+    pthread_mutex_unlock(&sustained_mutex);
+}
+
+void sustained_perf_start(void)
+{
+    static int initialized;
+
+    pthread_mutex_lock(&sustained_mutex);
+    if (active)
+        goto out;
+
+    if (!initialized) {
+        power_timer_init(&poll_timer, poll_timer_expired, NULL);
+        if (init_clusters() == -1) {
+            ALOGE("Sustained performance not supported on this target");
+            goto out;
+        }
+        initialized = 1;
+    }
+
+    active = 1;
+    last_change_ms = power_timer_now_ms();
+    cool_since_ms = 0;
+    if (load_freqs() == 0)
+        apply_caps();
+    else
+        ALOGW("No frequency tables while a cluster is offline, retrying");
+    power_timer_arm(&poll_timer, SUSTAINED_POLL_MS);
+
+out:
+    pthread_mutex_unlock(&sustained_mutex);
+}
+
+/*
+ * Take the caps again after the perf daemon lost them. Returns 1 if a
+ * lock was re-acquired.
+ */
+int sustained_perf_reacquire(void)
+{
+    int ret = 0;
+
+    pthread_mutex_lock(&sustained_mutex);
+    if (active && lock_handle > 0) {
+        /* The old handle may belong to someone else now. */
+        lock_handle = 0;
+        apply_caps();
+        ret = lock_handle > 0;
+    }
+    pthread_mutex_unlock(&sustained_mutex);
+
+    return ret;
+}
+
+void sustained_perf_stop(void)
+{
+    pthread_mutex_lock(&sustained_mutex);
+    if (active) {
+        active = 0;
+        power_timer_cancel(&poll_timer);
+        if (lock_handle > 0)
+            release_request(lock_handle);
+        lock_handle = 0;
+    }
+    pthread_mutex_unlock(&sustained_mutex);
+}
@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _QCOM_SUSTAINED_PERF_H
+#define _QCOM_SUSTAINED_PERF_H
+
+#define SUSTAINED_PERF_CACHE "/data/misc/power/sustained_perf"
+
+#define SUSTAINED_MAX_CLUSTERS  (2)
+#define SUSTAINED_MAX_FREQS     (32)
+
+/* Calibration loop timing */
+#define SUSTAINED_POLL_MS       (2000)
+#define SUSTAINED_STEP_UP_MS    (60 * 1000)
+#define SUSTAINED_STABLE_MS     (10 * 60 * 1000)
+
+/* Hottest sensor, in degrees C, that we consider sustainable */
+#define SUSTAINED_TEMP_HIGH     (75)
+#define SUSTAINED_TEMP_LOW      (65)
+
+struct sustained_cluster {
+    int first_cpu;
+    int num_cpus;
+};
+
+void sustained_perf_start(void);
+void sustained_perf_stop(void);
+int sustained_perf_reacquire(void);
+
+int get_sustained_perf_clusters(const struct sustained_cluster **clusters);
+
+#endif
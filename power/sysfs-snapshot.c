@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * Save, transform and restore a batch of sysfs nodes.
+ *
+ * Display-off tuning is usually "read a handful of nodes, write
+ * something derived from each, put the originals back later". Every
+ * node is read before any is written, and if a write fails the nodes
+ * already written are put back, so a snapshot is either fully applied
+ * or not applied at all. Nodes that can't be read are left out, since
+ * not every kernel has all of them.
+ */
+
+#define LOG_NIDEBUG 0
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LOG_TAG "QCOM PowerHAL"
+#include <utils/Log.h>
+
+#include "utils.h"
+#include "power-common.h"
+#include "sysfs-snapshot.h"
+
+static int read_node(struct sysfs_snapshot *snapshot, const char *path,
+        char *value)
+{
+    int len;
+
+    snapshot->stats.reads++;
+    if (sysfs_read((char *)path, value, NODE_MAX) == -1)
+        return -1;
+
+    len = strlen(value);
+    while (len > 0 && value[len - 1] == '\n')
+        value[--len] = '\0';
+
+    return len > 0 ? 0 : -1;
+}
+
+static int write_node(struct sysfs_snapshot *snapshot, const char *path,
+        const char *value)
+{
+    snapshot->stats.writes++;
+    if (sysfs_write((char *)path, (char *)value) == 0)
+        return 0;
+
+    snapshot->stats.failures++;
+    if (!snapshot->failing)
+        ALOGE("Failed to write %s to %s", value, path);
+    return -1;
+}
+
+static void transform(const struct sysfs_transform *t, const char *saved,
+        char *value)
+{
+    long v = strtol(saved, NULL, 0);
+
+    switch (t->op) {
+    case SYSFS_TRANSFORM_SET:
+        v = t->arg;
+        break;
+    case SYSFS_TRANSFORM_SCALE:
+        v *= t->arg;
+        break;
+    case SYSFS_TRANSFORM_CLAMP:
+        if (v < t->arg)
+            v = t->arg;
+        if (v > t->arg2)
+            v = t->arg2;
+        break;
+    }
+
+    snprintf(value, NODE_MAX, "%ld", v);
+}
+
+/* Put back the first 'count' captured nodes, last written first. */
+static int rollback(struct sysfs_snapshot *snapshot, int count)
+{
+    int i, rc = 0;
+
+    for (i = count - 1; i >= 0; i--) {
+        if (write_node(snapshot, snapshot->paths[i], snapshot->saved[i]))
+            rc = -1;
+    }
+
+    return rc;
+}
+
+/*
+ * Capture every node in 'transforms' and write its transformed value.
+ * Does nothing if the snapshot is already applied. Returns 0 if every
+ * readable node was written, -1 (with all of them put back) otherwise.
+ */
+int sysfs_snapshot_apply(struct sysfs_snapshot *snapshot,
+        const struct sysfs_transform *transforms, int num_transforms)
+{
+    const struct sysfs_transform *captured[SYSFS_SNAPSHOT_MAX_NODES];
+    char value[NODE_MAX];
+    int i, n = 0, skipped = 0;
+
+    if (snapshot->applied)
+        return 0;
+
+    if (num_transforms > SYSFS_SNAPSHOT_MAX_NODES)
+        num_transforms = SYSFS_SNAPSHOT_MAX_NODES;
+
+    for (i = 0; i < num_transforms; i++) {
+        if (read_node(snapshot, transforms[i].path, snapshot->saved[n])) {
+            skipped++;
+            continue;
+        }
+        snapshot->paths[n] = transforms[i].path;
+        captured[n++] = &transforms[i];
+    }
+
+    if (skipped && !snapshot->failing)
+        ALOGW("%d of %d nodes unreadable, left out of the snapshot",
+                skipped, num_transforms);
+
+    for (i = 0; i < n; i++) {
+        transform(captured[i], snapshot->saved[i], value);
+        if (write_node(snapshot, snapshot->paths[i], value)) {
+            rollback(snapshot, i);
+            snapshot->stats.rollbacks++;
+            snapshot->failing = 1;
+            return -1;
+        }
+    }
+
+    snapshot->num_nodes = n;
+    snapshot->applied = 1;
+    snapshot->failing = skipped > 0;
+
+    return 0;
+}
+
+/* Put back everything captured by the last apply. */
+int sysfs_snapshot_restore(struct sysfs_snapshot *snapshot)
+{
+    int rc;
+
+    if (!snapshot->applied)
+        return 0;
+
+    rc = rollback(snapshot, snapshot->num_nodes);
+    snapshot->applied = 0;
+    snapshot->failing = rc != 0;
+
+    return rc;
+}
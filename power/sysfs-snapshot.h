@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef _QCOM_SYSFS_SNAPSHOT_H
+#define _QCOM_SYSFS_SNAPSHOT_H
+
+#define SYSFS_SNAPSHOT_MAX_NODES    (8)
+
+enum sysfs_transform_op {
+    /* node = arg */
+    SYSFS_TRANSFORM_SET = 0,
+    /* node = saved * arg */
+    SYSFS_TRANSFORM_SCALE,
+    /* node = saved, clamped to [arg, arg2] */
+    SYSFS_TRANSFORM_CLAMP,
+};
+
+struct sysfs_transform {
+    const char *path;
+    int op;
+    long arg;
+    long arg2;
+};
+
+struct sysfs_snapshot_stats {
+    int reads;
+    int writes;
+    int failures;
+    int rollbacks;
+};
+
+/*
+ * Values captured by sysfs_snapshot_apply() and put back by
+ * sysfs_snapshot_restore(). Owned by the caller, usually a static
+ * zero-initialised struct; callers serialise access themselves.
+ */
+struct sysfs_snapshot {
+    int applied;
+    int num_nodes;
+    const char *paths[SYSFS_SNAPSHOT_MAX_NODES];
+    char saved[SYSFS_SNAPSHOT_MAX_NODES][NODE_MAX];
+    /* Suppresses repeated logging while a node keeps failing */
+    int failing;
+    struct sysfs_snapshot_stats stats;
+};
+
+int sysfs_snapshot_apply(struct sysfs_snapshot *snapshot,
+        const struct sysfs_transform *transforms, int num_transforms);
+int sysfs_snapshot_restore(struct sysfs_snapshot *snapshot);
+
+int get_display_off_transforms(int governor,
+        const struct sysfs_transform **transforms);
+
+#endif
@@ -0,0 +1,37 @@
+#!/bin/sh
+#
+# Replay the lock dump traces and compare them with the expected locks,
+# their resource counts and the limits for the SoC powersim was built
+# for:
+#
+#   powersim-test.sh <powersim> <soc>
+#
+#   low-power       battery saver coming and going under each profile
+#   profile-clamp   boosts clamped to the power save profile's caps
+#
+# e.g. "powersim-test.sh out/host/linux-x86/bin/powersim msm8994". After
+# a deliberate change to the backend or the policy, regenerate the
+# expected files with the same command lines and review the diff.
+
+powersim=$1
+soc=$2
+dir=$(dirname "$0")/../sim
+ret=0
+
+if [ -z "$powersim" ] || [ -z "$soc" ]; then
+    echo "usage: $0 <powersim> <soc>" >&2
+    exit 2
+fi
+
+"$powersim" -l -p balanced,power_save "$dir/models/$soc.txt" \
+        "$dir/traces/low-power.hints" "$dir/traces/scroll-launch.work" \
+        2>/dev/null | diff -u "$dir/traces/low-power.$soc.expected" - ||
+    ret=1
+
+"$powersim" -l -p balanced "$dir/models/$soc.txt" \
+        "$dir/traces/profile-clamp.hints" "$dir/traces/scroll-launch.work" \
+        2>/dev/null | diff -u "$dir/traces/profile-clamp.$soc.expected" - ||
+    ret=1
+
+[ $ret -eq 0 ] && echo PASS
+exit $ret
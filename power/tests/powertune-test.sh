@@ -0,0 +1,23 @@
+#!/bin/sh
+#
+# Run powertune on the reference capture and compare its proposal with
+# the expected output:
+#
+#   powertune-test.sh <powertune>
+#
+# e.g. "powertune-test.sh out/host/linux-x86/bin/powertune". After a
+# deliberate change to powertune or the msm8994 model, regenerate the
+# expected file with the same command line and review the diff.
+
+powertune=$1
+dir=$(dirname "$0")/..
+
+if [ -z "$powertune" ]; then
+    echo "usage: $0 <powertune>" >&2
+    exit 2
+fi
+
+"$powertune" "$dir/sim/models/msm8994.txt" \
+        "$dir/tune/data/msm8994-sample.log" |
+    diff -u "$dir/tune/data/msm8994-sample.expected" - &&
+    echo PASS
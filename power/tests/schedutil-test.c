@@ -0,0 +1,339 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * Host test for the schedutil backend against a fake sysfs tree.
+ *
+ * Built with every path the backend and governor detection use
+ * redirected below the working directory (see Android.mk), so the
+ * test builds the tree in a scratch directory, sends hints and checks
+ * what was written. The HAL entry points schedutil.c calls are stubbed
+ * here; time is a fake clock advanced by the test.
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "utils.h"
+#include "power-common.h"
+#include "power-timer.h"
+#include "governor-tunables.h"
+#include "schedutil.h"
+
+#define FAKE_SCHEDUTIL_PATH "sys/devices/system/cpu/cpufreq/schedutil/"
+
+static long long fake_now_ms;
+static struct power_timer *fake_timer;
+static int failures;
+/* What the boost budget grants, -1 for whatever was asked */
+static int budget_grant = -1;
+static int qos_votes;
+static int qos_vote_ms;
+
+/* Stubs for what schedutil.c takes from the rest of the HAL */
+
+void power_timer_init(struct power_timer *timer,
+        void (*callback)(void *data), void *data)
+{
+    timer->callback = callback;
+    timer->data = data;
+    timer->armed = 0;
+}
+
+int power_timer_arm(struct power_timer *timer, int timeout_ms)
+{
+    timer->deadline_ms = fake_now_ms + timeout_ms;
+    timer->armed = 1;
+    fake_timer = timer;
+    return 0;
+}
+
+void power_timer_cancel(struct power_timer *timer)
+{
+    timer->armed = 0;
+}
+
+long long power_timer_now_ms(void)
+{
+    return fake_now_ms;
+}
+
+int sysfs_write(char *path, char *s)
+{
+    int fd, len;
+
+    fd = open(path, O_WRONLY | O_TRUNC);
+    if (fd < 0)
+        return -1;
+    len = write(fd, s, strlen(s));
+    close(fd);
+
+    return len < 0 ? -1 : 0;
+}
+
+static int read_file(const char *path, char *value, int size)
+{
+    int fd, len;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return -1;
+    len = read(fd, value, size - 1);
+    close(fd);
+    if (len < 0)
+        return -1;
+
+    while (len > 0 && value[len - 1] == '\n')
+        len--;
+    value[len] = '\0';
+
+    return 0;
+}
+
+/* The real one lives in utils.c; this reads the same node. */
+int get_scaling_governor_id(void)
+{
+    char governor[32];
+
+    if (read_file(SCALING_GOVERNOR_PATH, governor, sizeof(governor)))
+        return -1;
+
+    return strcmp(governor, SCHEDUTIL_GOVERNOR) == 0 ?
+            GOVERNOR_SCHEDUTIL : GOVERNOR_INTERACTIVE;
+}
+
+int governor_read_tunable(__attribute__((unused)) const char *governor,
+        const char *name, char *value, int size)
+{
+    char path[128];
+
+    snprintf(path, sizeof(path), FAKE_SCHEDUTIL_PATH "%s", name);
+    return read_file(path, value, size);
+}
+
+void governor_apply_tunables(__attribute__((unused)) const char *governor,
+        const struct tunable_setting *settings, int num_settings,
+        __attribute__((unused)) struct tunable_apply_stats *stats)
+{
+    char path[128];
+    int i;
+
+    for (i = 0; i < num_settings; i++) {
+        snprintf(path, sizeof(path), FAKE_SCHEDUTIL_PATH "%s",
+                settings[i].name);
+        sysfs_write(path, (char *)settings[i].value);
+    }
+}
+
+int pm_qos_vote(__attribute__((unused)) int type, int duration_ms)
+{
+    qos_votes++;
+    qos_vote_ms = duration_ms;
+    return 0;
+}
+
+void power_state_boost(__attribute__((unused)) int duration_ms)
+{
+}
+
+int launch_policy_duration(int duration_ms)
+{
+    return duration_ms;
+}
+
+int boost_budget_grant(int duration_ms)
+{
+    return budget_grant < 0 ? duration_ms : budget_grant;
+}
+
+void boost_budget_charge(__attribute__((unused)) int requested_ms,
+        __attribute__((unused)) int granted_ms)
+{
+}
+
+/* The fake tree */
+
+static void make_node(const char *path, const char *value)
+{
+    char dir[128];
+    char *slash;
+
+    snprintf(dir, sizeof(dir), "%s", path);
+    for (slash = strchr(dir, '/'); slash; slash = strchr(slash + 1, '/')) {
+        *slash = '\0';
+        mkdir(dir, 0755);
+        *slash = '/';
+    }
+
+    if (creat(path, 0644) < 0 || sysfs_write((char *)path, (char *)value)) {
+        perror(path);
+        exit(2);
+    }
+}
+
+static void make_tree(const char *governor)
+{
+    char path[128];
+
+    make_node(AVAILABLE_GOVERNORS_PATH, "interactive ondemand schedutil\n");
+    make_node(SCALING_GOVERNOR_PATH, governor);
+    make_node(SCHEDUTIL_UCLAMP_PATH, "0\n");
+    make_node(FAKE_SCHEDUTIL_PATH "rate_limit_us", "10000\n");
+
+    snprintf(path, sizeof(path), CPUFREQ_POLICY_PATH "cpuinfo_max_freq", 0);
+    make_node(path, "1000000\n");
+    snprintf(path, sizeof(path), CPUFREQ_POLICY_PATH "scaling_min_freq", 0);
+    make_node(path, "300000\n");
+    snprintf(path, sizeof(path), CPUFREQ_POLICY_PATH "cpuinfo_max_freq", 4);
+    make_node(path, "2000000\n");
+    snprintf(path, sizeof(path), CPUFREQ_POLICY_PATH "scaling_min_freq", 4);
+    make_node(path, "400000\n");
+}
+
+static void expect_node(const char *what, const char *path,
+        const char *expected)
+{
+    char value[64];
+
+    if (read_file(path, value, sizeof(value)))
+        snprintf(value, sizeof(value), "(unreadable)");
+
+    if (strcmp(value, expected)) {
+        printf("FAIL %s: %s is %s, expected %s\n", what, path, value,
+                expected);
+        failures++;
+    }
+}
+
+static void expect_min_freq(const char *what, int policy,
+        const char *expected)
+{
+    char path[128];
+
+    snprintf(path, sizeof(path), CPUFREQ_POLICY_PATH "scaling_min_freq",
+            policy);
+    expect_node(what, path, expected);
+}
+
+static void expect_result(const char *what, int result, int expected)
+{
+    if (result != expected) {
+        printf("FAIL %s: returned %d, expected %d\n", what, result,
+                expected);
+        failures++;
+    }
+}
+
+static void advance(int ms)
+{
+    fake_now_ms += ms;
+    if (fake_timer && fake_timer->armed &&
+            fake_timer->deadline_ms <= fake_now_ms) {
+        fake_timer->armed = 0;
+        fake_timer->callback(fake_timer->data);
+    }
+}
+
+int main(void)
+{
+    char scratch[] = "/tmp/schedutil-test.XXXXXX";
+    char cmd[64];
+    char metadata[64];
+    int32_t duration = 100;
+
+    if (!mkdtemp(scratch) || chdir(scratch)) {
+        perror(scratch);
+        return 2;
+    }
+
+    make_tree("schedutil\n");
+
+    /* Interaction: uclamp and fast ramp, no min freq */
+    expect_result("interaction",
+            schedutil_power_hint(POWER_HINT_INTERACTION, &duration),
+            HINT_HANDLED);
+    expect_node("interaction", SCHEDUTIL_UCLAMP_PATH, "50");
+    expect_node("interaction", FAKE_SCHEDUTIL_PATH "rate_limit_us", "500");
+    expect_min_freq("interaction", 0, "300000");
+
+    /* Launch on top: min freq as a share of each policy's max */
+    expect_result("launch",
+            schedutil_power_hint(POWER_HINT_LAUNCH_BOOST, NULL),
+            HINT_HANDLED);
+    expect_node("launch", SCHEDUTIL_UCLAMP_PATH, "100");
+    expect_min_freq("launch", 0, "700000");
+    expect_min_freq("launch", 4, "1400000");
+
+    /* Interaction expires first; launch still holds */
+    advance(duration);
+    expect_node("interaction expiry", SCHEDUTIL_UCLAMP_PATH, "100");
+
+    /* Launch expires; everything back to the originals */
+    advance(SCHEDUTIL_LAUNCH_MS);
+    expect_node("launch expiry", SCHEDUTIL_UCLAMP_PATH, "0");
+    expect_node("launch expiry", FAKE_SCHEDUTIL_PATH "rate_limit_us",
+            "10000");
+    expect_min_freq("launch expiry", 0, "300000");
+    expect_min_freq("launch expiry", 4, "400000");
+
+    /* PM QoS follows what the budget granted, not what was asked */
+    budget_grant = 40;
+    schedutil_power_hint(POWER_HINT_INTERACTION, &duration);
+    expect_result("granted vote", qos_vote_ms, 40);
+    advance(40);
+    expect_node("granted expiry", SCHEDUTIL_UCLAMP_PATH, "0");
+
+    budget_grant = 0;
+    qos_votes = 0;
+    schedutil_power_hint(POWER_HINT_INTERACTION, &duration);
+    expect_result("refused vote", qos_votes, 0);
+    expect_node("refused", SCHEDUTIL_UCLAMP_PATH, "0");
+    budget_grant = -1;
+
+    /* Two encodes: the request lasts until the last one ends */
+    snprintf(metadata, sizeof(metadata), "state=1;hint_id=1");
+    schedutil_power_hint(POWER_HINT_VIDEO_ENCODE, metadata);
+    snprintf(metadata, sizeof(metadata), "state=1;hint_id=2");
+    schedutil_power_hint(POWER_HINT_VIDEO_ENCODE, metadata);
+    expect_node("encode", SCHEDUTIL_UCLAMP_PATH, "30");
+    snprintf(metadata, sizeof(metadata), "state=0;hint_id=1");
+    schedutil_power_hint(POWER_HINT_VIDEO_ENCODE, metadata);
+    expect_node("first encode ends", SCHEDUTIL_UCLAMP_PATH, "30");
+    snprintf(metadata, sizeof(metadata), "state=0;hint_id=2");
+    schedutil_power_hint(POWER_HINT_VIDEO_ENCODE, metadata);
+    expect_node("last encode ends", SCHEDUTIL_UCLAMP_PATH, "0");
+
+    /* Another governor running: left to the other backends */
+    make_node(SCALING_GOVERNOR_PATH, "interactive\n");
+    expect_result("interactive governor",
+            schedutil_power_hint(POWER_HINT_INTERACTION, &duration),
+            HINT_NONE);
+    expect_node("interactive governor", SCHEDUTIL_UCLAMP_PATH, "0");
+
+    snprintf(cmd, sizeof(cmd), "rm -rf %s", scratch);
+    if (system(cmd))
+        printf("could not remove %s\n", scratch);
+
+    if (!failures)
+        printf("PASS\n");
+
+    return failures ? 1 : 0;
+}
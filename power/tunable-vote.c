@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Refcounted votes on governor tunables.
+ *
+ * While the vendor library is usable a vote is an indefinite perflock
+ * in the hint list, so the perf daemon arbitrates it against the video
+ * hints that touch the same resource, and it is queued and replayed
+ * like any other hint while the library loads or after perfd restarts.
+ * Without the library the node is written directly and the value it
+ * held before the first vote is put back after the last unvote.
+ */
+
+#define LOG_NIDEBUG 0
+
+#include <pthread.h>
+#include <string.h>
+
+#define LOG_TAG "QCOM PowerHAL"
+#include <utils/Log.h>
+
+#include "utils.h"
+#include "hint-data.h"
+#include "performance.h"
+#include "power-common.h"
+#include "tunable-vote.h"
+
+static pthread_mutex_t vote_mutex = PTHREAD_MUTEX_INITIALIZER;
+/* Tunables with at least one vote. */
+static struct tunable_vote *voted;
+
+static struct tunable_vote ondemand_io_busy =
+    TUNABLE_VOTE_INIT(ONDEMAND_PATH "io_is_busy", "0", IO_BUSY_OFF,
+            ONDEMAND_IO_BUSY_VOTE_HINT_ID);
+static struct tunable_vote ondemand_sdf =
+    TUNABLE_VOTE_INIT(ONDEMAND_PATH "sampling_down_factor", "1",
+            SAMPLING_DOWN_FACTOR_1, ONDEMAND_SDF_VOTE_HINT_ID);
+
+static void apply_sysfs_locked(struct tunable_vote *tunable)
+{
+    if (sysfs_read((char *)tunable->path, tunable->saved,
+                sizeof(tunable->saved)) == -1) {
+        tunable->backend = TUNABLE_BACKEND_NONE;
+        return;
+    }
+
+    if (sysfs_write((char *)tunable->path, (char *)tunable->value) == -1) {
+        tunable->backend = TUNABLE_BACKEND_NONE;
+        return;
+    }
+
+    tunable->backend = TUNABLE_BACKEND_SYSFS;
+}
+
+static void apply_locked(struct tunable_vote *tunable)
+{
+    if (perf_lib_available()) {
+        perform_hint_action(tunable->hint_id, &tunable->opcode, 1);
+        tunable->backend = TUNABLE_BACKEND_PERFLOCK;
+    } else {
+        apply_sysfs_locked(tunable);
+    }
+}
+
+static void restore_locked(struct tunable_vote *tunable)
+{
+    switch (tunable->backend) {
+    case TUNABLE_BACKEND_PERFLOCK:
+        undo_hint_action(tunable->hint_id);
+        break;
+    case TUNABLE_BACKEND_SYSFS:
+        if (sysfs_write((char *)tunable->path, tunable->saved) == -1)
+            ALOGE("Failed to restore %s", tunable->path);
+        break;
+    }
+
+    tunable->backend = TUNABLE_BACKEND_NONE;
+}
+
+void tunable_vote(struct tunable_vote *tunable)
+{
+    pthread_mutex_lock(&vote_mutex);
+
+    if (tunable->votes++ == 0) {
+        apply_locked(tunable);
+        tunable->next = voted;
+        voted = tunable;
+    }
+
+    pthread_mutex_unlock(&vote_mutex);
+}
+
+void tunable_unvote(struct tunable_vote *tunable)
+{
+    struct tunable_vote **p;
+
+    pthread_mutex_lock(&vote_mutex);
+
+    if (tunable->votes == 0) {
+        ALOGW("Unbalanced unvote of %s", tunable->path);
+        goto out;
+    }
+
+    if (--tunable->votes == 0) {
+        restore_locked(tunable);
+        for (p = &voted; *p; p = &(*p)->next) {
+            if (*p == tunable) {
+                *p = tunable->next;
+                break;
+            }
+        }
+    }
+
+out:
+    pthread_mutex_unlock(&vote_mutex);
+}
+
+/*
+ * The loader gave up. Votes taken while it was still loading were
+ * queued as hints and have been dropped with them; write them out.
+ */
+void tunable_vote_perf_lib_failed(void)
+{
+    struct tunable_vote *tunable;
+
+    pthread_mutex_lock(&vote_mutex);
+    for (tunable = voted; tunable; tunable = tunable->next) {
+        if (tunable->backend == TUNABLE_BACKEND_PERFLOCK)
+            apply_sysfs_locked(tunable);
+    }
+    pthread_mutex_unlock(&vote_mutex);
+}
+
+void vote_ondemand_io_busy_off()
+{
+    tunable_vote(&ondemand_io_busy);
+}
+
+void unvote_ondemand_io_busy_off()
+{
+    tunable_unvote(&ondemand_io_busy);
+}
+
+void vote_ondemand_sdf_low()
+{
+    tunable_vote(&ondemand_sdf);
+}
+
+void unvote_ondemand_sdf_low()
+{
+    tunable_unvote(&ondemand_sdf);
+}
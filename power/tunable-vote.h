@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _QCOM_TUNABLE_VOTE_H
+#define _QCOM_TUNABLE_VOTE_H
+
+#define TUNABLE_VALUE_MAX   (32)
+
+enum tunable_backend {
+    TUNABLE_BACKEND_NONE = 0,
+    TUNABLE_BACKEND_PERFLOCK,
+    TUNABLE_BACKEND_SYSFS,
+};
+
+/*
+ * A governor tunable that several callers may want changed at once.
+ * The first vote applies 'value', the last unvote restores whatever
+ * was there before. With the vendor library the vote is held as a
+ * perflock on 'opcode' under 'hint_id'; without it 'path' is written
+ * directly.
+ */
+struct tunable_vote {
+    const char *path;
+    const char *value;
+    int opcode;
+    int hint_id;
+
+    /* Owned by tunable-vote.c */
+    int votes;
+    int backend;
+    char saved[TUNABLE_VALUE_MAX];
+    struct tunable_vote *next;
+};
+
+#define TUNABLE_VOTE_INIT(_path, _value, _opcode, _hint_id) \
+    { .path = (_path), .value = (_value), .opcode = (_opcode), \
+      .hint_id = (_hint_id) }
+
+void tunable_vote(struct tunable_vote *tunable);
+void tunable_unvote(struct tunable_vote *tunable);
+void tunable_vote_perf_lib_failed(void);
+
+#endif
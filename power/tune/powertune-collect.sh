@@ -0,0 +1,29 @@
+#!/system/bin/sh
+#
+# Log cpufreq time_in_state snapshots for powertune:
+#
+#   powertune-collect.sh [interval_s]
+#
+# Leave it running while the device is used, then save the log with
+# "logcat -v threadtime -d > capture.txt". The HAL logs each boost it
+# takes when persist.power.boost_log is set to 1 (reboot after setting
+# it), and ActivityManager logs launch times. Frame times can be
+# logged from any source as "log -t powertune 'frame <ms>'".
+
+interval=${1:-1}
+
+case "$(getprop persist.power.boost_log)" in
+1|true) ;;
+*)  echo "setprop persist.power.boost_log 1 and reboot first" >&2
+    exit 1 ;;
+esac
+
+while true; do
+    for cpu in /sys/devices/system/cpu/cpu[0-9]*; do
+        tis=$cpu/cpufreq/stats/time_in_state
+        [ -r $tis ] || continue
+        log -t powertune "tis ${cpu##*/} $(while read khz ticks; do
+            echo -n "$khz:$ticks "; done < $tis)"
+    done
+    sleep $interval
+done
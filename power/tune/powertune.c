@@ -0,0 +1,619 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * powertune: propose boost vectors from device telemetry.
+ *
+ *   powertune [-L launch_ms] [-F frame_ms] [-n min_events] <model> <logcat>...
+ *
+ * Reads threadtime logcat captures holding:
+ *
+ *   QCOM PowerHAL    "interaction boost: <ms> ms [<opcodes>]", one per
+ *                    boost (or "launch boost: ...")
+ *   powertune        "tis <cpuN> <khz>:<ticks> ...", time_in_state
+ *                    snapshots from powertune-collect.sh, and
+ *                    optional "frame <ms>" frame times
+ *   ActivityManager  "Displayed <activity>: +<time>" launch times
+ *
+ * Each boost that doesn't fall inside the window of the one before it
+ * starts an episode. An episode's energy comes from the time_in_state
+ * deltas across its window and the power figures of a powersim model
+ * (busy power, so it is an upper bound). Its latency is the launch's
+ * Displayed time, or the 90th percentile of the frames in the window.
+ * Episodes are grouped by the vector and duration that were used, and
+ * for each kind of boost the group with the least energy that meets
+ * the latency target (500 ms launches, 16 ms frames) is printed the
+ * way the SoC files declare it. Launch durations are cut to the p90
+ * launch time, as a longer boost only costs energy. Output depends on
+ * the input alone; data/msm8994-sample.log is a reference capture,
+ * checked by tests/powertune-test.sh.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "sim-model.h"
+
+#define DEFAULT_LAUNCH_MS       (500.0)
+#define DEFAULT_FRAME_MS        (16.0)
+#define DEFAULT_MIN_EVENTS      (3)
+/* A Displayed line this long after a launch boost belongs to it */
+#define LAUNCH_MATCH_MS         (5000)
+#define DURATION_STEP_MS        (100)
+
+#define MAX_CPUS                (SIM_MAX_CPUS)
+#define MAX_FREQS               (32)
+#define MAX_RESOURCES           (32)
+#define TICK_MS                 (10)
+
+#define HAL_TAG                 "QCOM PowerHAL"
+#define TUNE_TAG                "powertune"
+#define AM_TAG                  "ActivityManager"
+
+enum {
+    KIND_INTERACTION = 0,
+    KIND_LAUNCH,
+    KIND_COUNT,
+};
+
+struct boost_event {
+    long long ms;
+    /* Order read, to break ties */
+    int seq;
+    int kind;
+    int duration;
+    int num_resources;
+    int resources[MAX_RESOURCES];
+    /* -1 while unknown */
+    double energy_mj;
+    double latency_ms;
+};
+
+struct snapshot {
+    long long ms;
+    int cpu;
+    int num_freqs;
+    int khz[MAX_FREQS];
+    long long ticks[MAX_FREQS];
+};
+
+struct sample {
+    long long ms;
+    double value;
+};
+
+struct group {
+    int kind;
+    /* The first event of the group, for its vector */
+    const struct boost_event *first;
+    int num_events;
+    int num_latencies;
+    double energy_mj;
+    double p90_ms;
+};
+
+struct array {
+    void *data;
+    int num;
+    int max;
+};
+
+static const char *kind_names[KIND_COUNT] = {
+    [KIND_INTERACTION] = "interaction",
+    [KIND_LAUNCH] = "launch",
+};
+
+static struct sim_model model;
+static struct array events, snapshots, frames, launches;
+static double targets[KIND_COUNT] = { DEFAULT_FRAME_MS, DEFAULT_LAUNCH_MS };
+static int min_events = DEFAULT_MIN_EVENTS;
+
+static void *array_add(struct array *a, size_t size)
+{
+    if (a->num == a->max) {
+        a->max = a->max ? a->max * 2 : 256;
+        a->data = realloc(a->data, a->max * size);
+        if (!a->data)
+            abort();
+    }
+
+    return (char *)a->data + size * a->num++;
+}
+
+/* "MM-DD HH:MM:SS.mmm" as ms; captures don't span a new year. */
+static int parse_time(const char *line, long long *ms)
+{
+    int mon, day, h, m, s, msec;
+
+    if (sscanf(line, "%d-%d %d:%d:%d.%d", &mon, &day, &h, &m, &s, &msec) != 6)
+        return -1;
+
+    *ms = ((((long long)mon * 31 + day) * 24 + h) * 60 + m) * 60000LL +
+            s * 1000 + msec;
+    return 0;
+}
+
+static void parse_boost(long long ms, int kind, const char *msg)
+{
+    struct boost_event *e;
+    const char *p;
+    char *end;
+    int duration;
+
+    if (sscanf(msg, "%d ms [", &duration) != 1 || duration <= 0)
+        return;
+    p = strchr(msg, '[');
+    if (!p)
+        return;
+
+    e = array_add(&events, sizeof(*e));
+    memset(e, 0, sizeof(*e));
+    e->seq = events.num;
+    e->ms = ms;
+    e->kind = kind;
+    e->duration = duration;
+    e->energy_mj = -1;
+    e->latency_ms = -1;
+
+    for (p++; e->num_resources < MAX_RESOURCES; p = end) {
+        long v = strtol(p, &end, 16);
+        if (end == p)
+            break;
+        e->resources[e->num_resources++] = v;
+    }
+}
+
+static void parse_tis(long long ms, const char *msg)
+{
+    struct snapshot *s;
+    const char *p;
+    char *end;
+    int cpu, n;
+
+    if (sscanf(msg, "cpu%d %n", &cpu, &n) != 1 || cpu < 0 || cpu >= MAX_CPUS)
+        return;
+
+    s = array_add(&snapshots, sizeof(*s));
+    memset(s, 0, sizeof(*s));
+    s->ms = ms;
+    s->cpu = cpu;
+
+    for (p = msg + n; s->num_freqs < MAX_FREQS; p = end) {
+        s->khz[s->num_freqs] = strtol(p, &end, 10);
+        if (end == p || *end != ':')
+            break;
+        p = end + 1;
+        s->ticks[s->num_freqs++] = strtoll(p, &end, 10);
+    }
+}
+
+/* "+412ms", "+1s12ms" or "+2s" */
+static void parse_displayed(long long ms, const char *msg)
+{
+    struct sample *sample;
+    const char *p = strstr(msg, ": +");
+    int a, b, n = 0;
+    double value;
+
+    if (!p)
+        return;
+    p += 3;
+
+    if (sscanf(p, "%ds%dms%n", &a, &b, &n) == 2 && n)
+        value = a * 1000 + b;
+    else if (sscanf(p, "%dms%n", &a, &n) == 1 && n)
+        value = a;
+    else if (sscanf(p, "%ds%n", &a, &n) == 1 && n)
+        value = a * 1000;
+    else
+        return;
+
+    sample = array_add(&launches, sizeof(*sample));
+    sample->ms = ms;
+    sample->value = value;
+}
+
+static int load_logcat(const char *path)
+{
+    char line[1024], tag[64];
+    struct sample *sample;
+    const char *msg;
+    long long ms;
+    double value;
+    FILE *f;
+    int n;
+
+    f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), f)) {
+        n = 0;
+        if (parse_time(line, &ms) ||
+                sscanf(line, "%*s %*s %*d %*d %*c %63[^:]: %n", tag, &n) != 1 ||
+                !n)
+            continue;
+        msg = line + n;
+
+        if (!strcmp(tag, HAL_TAG)) {
+            if (!strncmp(msg, "interaction boost: ", 19))
+                parse_boost(ms, KIND_INTERACTION, msg + 19);
+            else if (!strncmp(msg, "launch boost: ", 14))
+                parse_boost(ms, KIND_LAUNCH, msg + 14);
+        } else if (!strcmp(tag, TUNE_TAG)) {
+            if (!strncmp(msg, "tis ", 4)) {
+                parse_tis(ms, msg + 4);
+            } else if (sscanf(msg, "frame %lf", &value) == 1) {
+                sample = array_add(&frames, sizeof(*sample));
+                sample->ms = ms;
+                sample->value = value;
+            }
+        } else if (!strcmp(tag, AM_TAG) && !strncmp(msg, "Displayed ", 10)) {
+            parse_displayed(ms, msg);
+        }
+    }
+
+    fclose(f);
+    return 0;
+}
+
+static int compare_events(const void *a, const void *b)
+{
+    const struct boost_event *x = a, *y = b;
+
+    if (x->ms != y->ms)
+        return x->ms < y->ms ? -1 : 1;
+    return x->seq - y->seq;
+}
+
+static int compare_samples(const void *a, const void *b)
+{
+    const struct sample *x = a, *y = b;
+
+    if (x->ms != y->ms)
+        return x->ms < y->ms ? -1 : 1;
+    return x->value < y->value ? -1 : x->value > y->value;
+}
+
+static int compare_snapshots(const void *a, const void *b)
+{
+    const struct snapshot *x = a, *y = b;
+
+    if (x->ms != y->ms)
+        return x->ms < y->ms ? -1 : 1;
+    return x->cpu - y->cpu;
+}
+
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+static double p90(double *values, int n)
+{
+    qsort(values, n, sizeof(double), compare_double);
+    return values[(n - 1) * 90 / 100];
+}
+
+/* Busy power of 'cpu' at 'khz', from the model's nearest OPP */
+static int power_mw(int cpu, int khz)
+{
+    const struct sim_cluster *c;
+    int i, j;
+
+    for (i = 0; i < model.num_clusters; i++) {
+        c = &model.clusters[i];
+        if (cpu < c->first_cpu || cpu >= c->first_cpu + c->num_cpus)
+            continue;
+        for (j = 0; j < c->num_opps - 1; j++) {
+            if (c->opps[j].khz >= khz)
+                break;
+        }
+        return c->opps[j].busy_mw;
+    }
+
+    return 0;
+}
+
+/* Energy over [start, end], or -1 without snapshots around it. */
+static double window_energy(long long start, long long end)
+{
+    const struct snapshot *s = snapshots.data;
+    const struct snapshot *before[MAX_CPUS] = { NULL };
+    const struct snapshot *after[MAX_CPUS] = { NULL };
+    double energy = 0, mj;
+    int i, j, k, cpu, found = 0;
+
+    for (i = 0; i < snapshots.num; i++) {
+        cpu = s[i].cpu;
+        if (s[i].ms <= start)
+            before[cpu] = &s[i];
+        else if (s[i].ms >= end && !after[cpu])
+            after[cpu] = &s[i];
+    }
+
+    /* An offline CPU has no snapshots, and costs nothing. */
+    for (cpu = 0; cpu < MAX_CPUS; cpu++) {
+        if (!before[cpu] || !after[cpu])
+            continue;
+        found = 1;
+
+        mj = 0;
+        for (j = 0; j < after[cpu]->num_freqs; j++) {
+            for (k = 0; k < before[cpu]->num_freqs; k++) {
+                if (before[cpu]->khz[k] == after[cpu]->khz[j])
+                    break;
+            }
+            mj += (after[cpu]->ticks[j] -
+                    (k < before[cpu]->num_freqs ? before[cpu]->ticks[k] : 0)) *
+                    TICK_MS * power_mw(cpu, after[cpu]->khz[j]) / 1000.0;
+        }
+
+        /* Scale the snapshot interval down to the window. */
+        energy += mj * (end - start) / (after[cpu]->ms - before[cpu]->ms);
+    }
+
+    return found ? energy : -1;
+}
+
+static double frame_latency(long long start, long long end)
+{
+    const struct sample *f = frames.data;
+    double *values;
+    double ret = -1;
+    int i, n = 0;
+
+    values = malloc((frames.num + 1) * sizeof(double));
+    for (i = 0; i < frames.num; i++) {
+        if (f[i].ms >= start && f[i].ms <= end)
+            values[n++] = f[i].value;
+    }
+    if (n)
+        ret = p90(values, n);
+    free(values);
+
+    return ret;
+}
+
+static double launch_latency(long long start)
+{
+    const struct sample *l = launches.data;
+    int i;
+
+    for (i = 0; i < launches.num; i++) {
+        if (l[i].ms >= start && l[i].ms <= start + LAUNCH_MATCH_MS)
+            return l[i].value;
+    }
+
+    return -1;
+}
+
+/*
+ * Score the first boost of each episode over a window as long as the
+ * longest boost of its kind, so short boosts are charged for what
+ * runs after them too.
+ */
+static void score_events(int window[KIND_COUNT])
+{
+    struct boost_event *e = events.data;
+    long long episode_end[KIND_COUNT] = { 0 };
+    int i;
+
+    for (i = 0; i < events.num; i++) {
+        if (e[i].duration > window[e[i].kind])
+            window[e[i].kind] = e[i].duration;
+    }
+
+    for (i = 0; i < events.num; i++) {
+        if (e[i].ms < episode_end[e[i].kind])
+            continue;
+        episode_end[e[i].kind] = e[i].ms + window[e[i].kind];
+
+        e[i].energy_mj = window_energy(e[i].ms, e[i].ms + window[e[i].kind]);
+        if (e[i].kind == KIND_LAUNCH)
+            e[i].latency_ms = launch_latency(e[i].ms);
+        else
+            e[i].latency_ms = frame_latency(e[i].ms, e[i].ms + e[i].duration);
+    }
+}
+
+static int same_vector(const struct boost_event *a, const struct boost_event *b)
+{
+    return a->kind == b->kind && a->duration == b->duration &&
+            a->num_resources == b->num_resources &&
+            !memcmp(a->resources, b->resources,
+                    a->num_resources * sizeof(a->resources[0]));
+}
+
+/* Groups in order of first use, so ties go to the earliest. */
+static int build_groups(struct group *groups)
+{
+    const struct boost_event *e = events.data;
+    double *latencies;
+    struct group *g;
+    int i, j, num_groups = 0;
+
+    latencies = malloc((events.num + 1) * sizeof(double));
+
+    for (i = 0; i < events.num; i++) {
+        if (e[i].energy_mj < 0)
+            continue;
+
+        for (j = 0; j < num_groups; j++) {
+            if (same_vector(groups[j].first, &e[i]))
+                break;
+        }
+        if (j < num_groups)
+            continue;
+
+        g = &groups[num_groups++];
+        memset(g, 0, sizeof(*g));
+        g->kind = e[i].kind;
+        g->first = &e[i];
+        g->p90_ms = -1;
+
+        for (j = i; j < events.num; j++) {
+            if (e[j].energy_mj < 0 || !same_vector(&e[i], &e[j]))
+                continue;
+            g->num_events++;
+            g->energy_mj += e[j].energy_mj;
+            if (e[j].latency_ms >= 0)
+                latencies[g->num_latencies++] = e[j].latency_ms;
+        }
+
+        g->energy_mj /= g->num_events;
+        if (g->num_latencies)
+            g->p90_ms = p90(latencies, g->num_latencies);
+    }
+
+    free(latencies);
+    return num_groups;
+}
+
+static void print_vector(const struct boost_event *e)
+{
+    int i;
+
+    for (i = 0; i < e->num_resources; i++)
+        printf("%s0x%X", i ? ", " : "", e->resources[i]);
+}
+
+static void print_groups(const struct group *groups, int num_groups)
+{
+    int i;
+
+    printf("/*\n * %-12s %6s %7s %8s %10s  %s\n", "kind", "events",
+            "dur_ms", "p90_ms", "energy_mJ", "vector");
+    for (i = 0; i < num_groups; i++) {
+        printf(" * %-12s %6d %7d ", kind_names[groups[i].kind],
+                groups[i].num_events, groups[i].first->duration);
+        if (groups[i].p90_ms >= 0)
+            printf("%8.1f", groups[i].p90_ms);
+        else
+            printf("%8s", "-");
+        printf(" %10.1f  ", groups[i].energy_mj);
+        print_vector(groups[i].first);
+        printf("\n");
+    }
+    printf(" */\n");
+}
+
+static void propose(int kind, const struct group *groups, int num_groups)
+{
+    const struct group *best = NULL;
+    int i, duration;
+
+    for (i = 0; i < num_groups; i++) {
+        if (groups[i].kind != kind || groups[i].num_events < min_events ||
+                groups[i].p90_ms < 0 || groups[i].p90_ms > targets[kind])
+            continue;
+        if (!best || groups[i].energy_mj < best->energy_mj)
+            best = &groups[i];
+    }
+
+    if (!best) {
+        printf("\n/* %s: no vector with %d or more events meets %.1f ms */\n",
+                kind_names[kind], min_events, targets[kind]);
+        return;
+    }
+
+    duration = best->first->duration;
+    if (kind == KIND_LAUNCH) {
+        i = ((int)best->p90_ms + DURATION_STEP_MS) / DURATION_STEP_MS *
+                DURATION_STEP_MS;
+        if (i < duration)
+            duration = i;
+    }
+
+    printf("\n/* %s: %d events, p90 %.1f ms (target %.1f ms), %.1f mJ each */\n",
+            kind_names[kind], best->num_events, best->p90_ms, targets[kind],
+            best->energy_mj);
+    printf("int duration = %d;\n", duration);
+    printf("int resources[] = { ");
+    print_vector(best->first);
+    printf(" };\n");
+}
+
+int main(int argc, char *argv[])
+{
+    int window[KIND_COUNT] = { 0 };
+    struct group *groups;
+    int opt, i, num_groups;
+
+    while ((opt = getopt(argc, argv, "L:F:n:")) != -1) {
+        switch (opt) {
+        case 'L':
+            targets[KIND_LAUNCH] = atof(optarg);
+            break;
+        case 'F':
+            targets[KIND_INTERACTION] = atof(optarg);
+            break;
+        case 'n':
+            min_events = atoi(optarg);
+            break;
+        default:
+            goto usage;
+        }
+    }
+
+    if (argc - optind < 2 || targets[KIND_LAUNCH] <= 0 ||
+            targets[KIND_INTERACTION] <= 0 || min_events < 1)
+        goto usage;
+
+    if (sim_model_load(argv[optind], &model))
+        return 1;
+    for (i = optind + 1; i < argc; i++) {
+        if (load_logcat(argv[i]))
+            return 1;
+    }
+
+    /* Merged captures may interleave; ties keep the order read. */
+    qsort(events.data, events.num, sizeof(struct boost_event), compare_events);
+    qsort(snapshots.data, snapshots.num, sizeof(struct snapshot),
+            compare_snapshots);
+    qsort(frames.data, frames.num, sizeof(struct sample), compare_samples);
+    qsort(launches.data, launches.num, sizeof(struct sample), compare_samples);
+
+    if (!events.num || !snapshots.num) {
+        fprintf(stderr, "no boosts or time_in_state snapshots found\n");
+        return 1;
+    }
+
+    score_events(window);
+
+    groups = malloc(events.num * sizeof(*groups));
+    num_groups = build_groups(groups);
+
+    print_groups(groups, num_groups);
+    for (i = 0; i < KIND_COUNT; i++)
+        propose(i, groups, num_groups);
+
+    free(groups);
+    return 0;
+
+usage:
+    fprintf(stderr, "usage: %s [-L launch_ms] [-F frame_ms] [-n min_events] "
+            "<model> <logcat>...\n", argv[0]);
+    return 2;
+}
@@ -31,22 +31,38 @@
 #include <dlfcn.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 
 #include "utils.h"
 #include "list.h"
 #include "hint-data.h"
+#include "performance.h"
 #include "power-common.h"
+#include "hint-table.h"
+#include "power-timer.h"
+#include "boost-profile.h"
+#include "boost-placement.h"
+#include "devfreq-boost.h"
+#include "io-boost.h"
+#include "boot-boost.h"
+#include "pm-qos.h"
+#include "core-ctl.h"
+#include "boost-policy.h"
+#include "power-state.h"
+#include "perflock-monitor.h"
+#include "tunable-vote.h"
+#include "cpufreq-policy.h"
 
 #define LOG_TAG "QCOM PowerHAL"
 #include <utils/Log.h>
 
-char scaling_gov_path[4][80] ={
-    "sys/devices/system/cpu/cpu0/cpufreq/scaling_governor",
-    "sys/devices/system/cpu/cpu1/cpufreq/scaling_governor",
-    "sys/devices/system/cpu/cpu2/cpufreq/scaling_governor",
-    "sys/devices/system/cpu/cpu3/cpufreq/scaling_governor"
+enum {
+    QCOPT_LOADING = 0,
+    QCOPT_READY,
+    QCOPT_FAILED,
 };
 
 static void *qcopt_handle;
@@ -54,8 +70,55 @@ static int (*perf_lock_acq)(unsigned long handle, int duration,
     int list[], int numArgs);
 static int (*perf_lock_rel)(unsigned long handle);
 static int (*perf_lock_use_profile)(unsigned long handle, int profile);
+
+/*
+ * The vendor library is loaded off the HAL-open path. qcopt_mutex
+ * guards the load state, the hint list and the requests that arrive
+ * while the library is still loading.
+ */
+static pthread_mutex_t qcopt_mutex = PTHREAD_MUTEX_INITIALIZER;
+static int qcopt_state = QCOPT_LOADING;
+static long long hal_load_ms;
+static int first_lock_logged;
+static int boost_log_enabled;
+static int pending_profile;
+static int pending_profile_set;
+static int pending_initial_release;
+
 static struct list_node active_hint_list_head;
 static int profile_handle = 0;
+static int current_profile = -1;
+/* The perflock shared by interaction and launch boosts */
+static int boost_lock_handle;
+
+/*
+ * HAL-owned hints that are released after a fixed lifetime unless
+ * taken again. Client-owned hints are reaped when the client dies
+ * instead, see perform_client_hint_action().
+ */
+static const struct {
+    int hint_id;
+    int max_lifetime_ms;
+} hint_lifetimes[] = {
+    /* Backstop; boot-boost.c normally releases it first. */
+    { BOOT_BOOST_HINT_ID, BOOT_BOOST_MAX_MS + BOOT_BOOST_POLL_MS },
+};
+
+static struct power_timer reaper_timer;
+static int reaper_timer_ready;
+static struct hint_reaper_stats reaper_stats[HINT_REAPER_MAX_STATS];
+static int num_reaper_stats;
+
+/* get_scaling_governor_id() runs on every hint; see there. */
+#define GOVERNOR_CACHE_MS       (1000)
+
+static pthread_mutex_t governor_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct {
+    int valid;
+    int governor;
+    unsigned int generation;
+    long long read_ms;
+} governor_cache;
 
 static void *get_qcopt_handle()
 {
@@ -76,31 +139,287 @@ static void *get_qcopt_handle()
     return handle;
 }
 
-static void __attribute__ ((constructor)) initialize(void)
+static inline int qcopt_ready(void)
+{
+    return __atomic_load_n(&qcopt_state, __ATOMIC_ACQUIRE) == QCOPT_READY;
+}
+
+/*
+ * Whether perflocks can be taken, now or once the loader finishes.
+ * Callers with a sysfs fallback use it to pick a path.
+ */
+int perf_lib_available(void)
+{
+    int state = __atomic_load_n(&qcopt_state, __ATOMIC_ACQUIRE);
+
+    return state == QCOPT_LOADING || (state == QCOPT_READY && perf_lock_acq);
+}
+
+static void init_hint_list(void)
+{
+    if (!active_hint_list_head.compare) {
+        active_hint_list_head.compare =
+            (int (*)(void *, void *))hint_compare;
+        active_hint_list_head.dump = (void (*)(void *))hint_dump;
+    }
+}
+
+static struct hint_data *alloc_hint_data(int hint_id, int lock_handle,
+        int resource_values[], int num_resources)
+{
+    struct hint_data *hint = malloc(sizeof(struct hint_data));
+
+    if (!hint)
+        return NULL;
+
+    hint->resources = malloc(num_resources * sizeof(int));
+    if (!hint->resources) {
+        free(hint);
+        return NULL;
+    }
+
+    hint->hint_id = hint_id;
+    hint->perflock_handle = lock_handle;
+    hint->expiry_ms = 0;
+    hint->owner_pid = 0;
+    hint->owner_start = 0;
+    memcpy(hint->resources, resource_values, num_resources * sizeof(int));
+    hint->num_resources = num_resources;
+
+    return hint;
+}
+
+static void free_hint_data(struct hint_data *hint)
+{
+    if (hint) {
+        free(hint->resources);
+        free(hint);
+    }
+}
+
+static int get_hint_max_lifetime(int hint_id)
+{
+    unsigned int i;
+
+    for (i = 0; i < sizeof(hint_lifetimes)/sizeof(hint_lifetimes[0]); i++) {
+        if (hint_lifetimes[i].hint_id == hint_id)
+            return hint_lifetimes[i].max_lifetime_ms;
+    }
+
+    return 0;
+}
+
+static struct hint_reaper_stats *get_reaper_stats(int hint_id)
+{
+    int i;
+
+    for (i = 0; i < num_reaper_stats; i++) {
+        if (reaper_stats[i].hint_id == hint_id)
+            return &reaper_stats[i];
+    }
+
+    if (num_reaper_stats == HINT_REAPER_MAX_STATS)
+        return NULL;
+
+    reaper_stats[num_reaper_stats].hint_id = hint_id;
+    return &reaper_stats[num_reaper_stats++];
+}
+
+static void publish_reaper_stats(const struct hint_reaper_stats *stats)
+{
+    power_state_set_reaper(stats->hint_id, stats->renewals, stats->reaped);
+}
+
+/* Start time of 'pid' in clock ticks since boot, to tell pid reuse apart */
+static int read_start_time(int pid, unsigned long long *start)
+{
+    char path[32];
+    char stat[512];
+    char *p;
+    int fd, len;
+
+    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return -1;
+    len = read(fd, stat, sizeof(stat) - 1);
+    close(fd);
+    if (len <= 0)
+        return -1;
+    stat[len] = '\0';
+
+    /* The command name may hold spaces; fields resume after its ')'. */
+    p = strrchr(stat, ')');
+    if (!p || sscanf(p + 1, " %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u "
+            "%*u %*u %*d %*d %*d %*d %*d %*d %llu", start) != 1)
+        return -1;
+
+    return 0;
+}
+
+/* Whether the client that took 'hint' is still around. */
+static int hint_owner_alive(const struct hint_data *hint)
+{
+    unsigned long long start;
+
+    if (!hint->owner_pid)
+        return 1;
+
+    return read_start_time(hint->owner_pid, &start) == 0 &&
+            start == hint->owner_start;
+}
+
+/*
+ * Record 'pid' as the owner of 'hint'. A pid that can't be read is
+ * ignored; without a liveness check the hint is held until undone.
+ */
+static void set_hint_owner(struct hint_data *hint, int pid)
+{
+    hint->owner_pid = 0;
+    if (pid <= 0)
+        return;
+
+    if (read_start_time(pid, &hint->owner_start)) {
+        ALOGW("Hint 0x%lx: can't watch client %d, holding until undone",
+                hint->hint_id, pid);
+        return;
+    }
+    hint->owner_pid = pid;
+}
+
+/* perf_lock_acq() wrapper. Called with the library ready. */
+static int acquire_lock(int lock_handle, int duration, int list[], int num_args)
+{
+    lock_handle = perf_lock_acq(lock_handle, duration, list, num_args);
+
+    if (lock_handle > 0)
+        perflock_monitor_lock_granted();
+    if (lock_handle > 0 && !first_lock_logged) {
+        first_lock_logged = 1;
+        ALOGI("First perflock acquired %lld ms after HAL load",
+                power_timer_now_ms() - hal_load_ms);
+    }
+
+    return lock_handle;
+}
+
+/*
+ * Serve what was requested while the library was loading. Hint locks
+ * are acquired for whatever is still in the hint list; timed boosts
+ * were dropped as they would be stale by now. Called with qcopt_mutex
+ * held.
+ */
+static void replay_pending_locked(void)
 {
-    qcopt_handle = get_qcopt_handle();
+    struct list_node *node = active_hint_list_head.next;
+
+    while (node) {
+        struct list_node *next = node->next;
+        struct hint_data *hint = node->data;
+
+        if (hint && !hint->perflock_handle) {
+            int lock_handle = -1;
+
+            if (qcopt_state == QCOPT_READY && perf_lock_acq)
+                lock_handle = acquire_lock(0, 0, hint->resources,
+                        hint->num_resources);
+
+            if (lock_handle > 0) {
+                hint->perflock_handle = lock_handle;
+                boost_profile_begin(hint->hint_id, hint->resources,
+                        hint->num_resources, 0);
+            } else {
+                if (qcopt_state == QCOPT_READY)
+                    ALOGE("Failed to replay hint 0x%lx.", hint->hint_id);
+                power_state_remove_hint(hint->hint_id);
+                free_hint_data(hint);
+                remove_list_node(&active_hint_list_head, node);
+            }
+        }
+        node = next;
+    }
+
+    if (qcopt_state != QCOPT_READY)
+        return;
 
-    if (!qcopt_handle) {
+    if (pending_initial_release && perf_lock_rel)
+        perf_lock_rel(1);
+
+    if (pending_profile_set && perf_lock_use_profile) {
+        profile_handle = perf_lock_use_profile(profile_handle, pending_profile);
+        if (profile_handle == -1)
+            ALOGE("Failed to set profile.");
+        if (pending_profile < 0)
+            profile_handle = 0;
+    }
+}
+
+static void *qcopt_loader(__attribute__((unused)) void *arg)
+{
+    long long start_ms = power_timer_now_ms();
+    char value[PROPERTY_VALUE_MAX];
+    void *handle = get_qcopt_handle();
+
+    property_get(BOOST_LOG_PROP, value, "0");
+    if (!strcmp(value, "1") || !strcmp(value, "true"))
+        __atomic_store_n(&boost_log_enabled, 1, __ATOMIC_RELAXED);
+
+    if (!handle) {
         ALOGE("Failed to get qcopt handle.\n");
     } else {
         /*
          * qc-opt handle obtained. Get the perflock acquire/release
          * function pointers.
          */
-        perf_lock_acq = dlsym(qcopt_handle, "perf_lock_acq");
+        perf_lock_acq = dlsym(handle, "perf_lock_acq");
 
         if (!perf_lock_acq) {
             ALOGE("Unable to get perf_lock_acq function handle.\n");
         }
 
-        perf_lock_rel = dlsym(qcopt_handle, "perf_lock_rel");
+        perf_lock_rel = dlsym(handle, "perf_lock_rel");
 
         if (!perf_lock_rel) {
             ALOGE("Unable to get perf_lock_rel function handle.\n");
         }
 
-        perf_lock_use_profile = dlsym(qcopt_handle, "perf_lock_use_profile");
+        perf_lock_use_profile = dlsym(handle, "perf_lock_use_profile");
     }
+
+    pthread_mutex_lock(&qcopt_mutex);
+    qcopt_handle = handle;
+    __atomic_store_n(&qcopt_state, handle ? QCOPT_READY : QCOPT_FAILED,
+            __ATOMIC_RELEASE);
+    replay_pending_locked();
+    pthread_mutex_unlock(&qcopt_mutex);
+
+    if (handle)
+        perflock_monitor_start();
+    if (!perf_lib_available())
+        tunable_vote_perf_lib_failed();
+
+    ALOGI("Vendor perf library %s in %lld ms, %lld ms after HAL load",
+            handle ? "loaded" : "failed", power_timer_now_ms() - start_ms,
+            power_timer_now_ms() - hal_load_ms);
+
+    return NULL;
+}
+
+static void __attribute__ ((constructor)) initialize(void)
+{
+    pthread_attr_t attr;
+    pthread_t thread;
+
+    hal_load_ms = power_timer_now_ms();
+
+    /* dlopen() and property_get() are too slow for the HAL-open path. */
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    if (pthread_create(&thread, &attr, qcopt_loader, NULL)) {
+        ALOGE("Failed to start loader thread, loading inline.");
+        qcopt_loader(NULL);
+    }
+    pthread_attr_destroy(&attr);
 }
 
 static void __attribute__ ((destructor)) cleanup(void)
@@ -186,7 +505,10 @@ int get_scaling_governor(char governor[], int size)
 
 int get_scaling_governor_check_cores(char governor[], int size,int core_num)
 {
-   if (sysfs_read(scaling_gov_path[core_num], governor,
+   char path[80];
+
+   snprintf(path, sizeof(path), SCALING_GOVERNOR_CPU_PATH, core_num);
+   if (sysfs_read(path, governor,
                size) == -1) {
       // Can't obtain the scaling governor. Return.
       return -1;
@@ -200,101 +522,560 @@ int get_scaling_governor_check_cores(char governor[], int size,int core_num)
    return 0;
 }
 
-void interaction(int duration, int num_args, int opt_list[])
+static const char *governor_names[GOVERNOR_COUNT] = {
+    [GOVERNOR_ONDEMAND] = ONDEMAND_GOVERNOR,
+    [GOVERNOR_INTERACTIVE] = INTERACTIVE_GOVERNOR,
+    [GOVERNOR_MSMDCVS] = MSMDCVS_GOVERNOR,
+    [GOVERNOR_SCHEDUTIL] = SCHEDUTIL_GOVERNOR,
+};
+
+int get_governor_id(const char *governor)
+{
+    int i;
+
+    for (i = GOVERNOR_UNKNOWN + 1; i < GOVERNOR_COUNT; i++) {
+        if (strcmp(governor, governor_names[i]) == 0)
+            return i;
+    }
+
+    return GOVERNOR_UNKNOWN;
+}
+
+/*
+ * Returns one of enum scaling_governor, or -1 if it can't be read.
+ * Falls back to the other cores while cpu0's policy is unavailable.
+ */
+static int read_scaling_governor_id(void)
+{
+    char governor[80];
+    int cpu;
+
+    if (get_scaling_governor(governor, sizeof(governor)) == 0)
+        return get_governor_id(governor);
+
+    for (cpu = CPU1; cpu <= CPU3; cpu++) {
+        if (get_scaling_governor_check_cores(governor, sizeof(governor), cpu) == 0)
+            return get_governor_id(governor);
+    }
+
+    return -1;
+}
+
+/*
+ * As read_scaling_governor_id(), but served from a cache on the hint
+ * path. Our own governor writes and CPUs coming online invalidate it
+ * at once; a change made from outside the HAL is picked up within
+ * GOVERNOR_CACHE_MS. Failures are not cached.
+ */
+int get_scaling_governor_id(void)
+{
+    unsigned int gen = cpufreq_policy_generation();
+    long long now = power_timer_now_ms();
+    int governor;
+
+    pthread_mutex_lock(&governor_cache_mutex);
+
+    if (governor_cache.valid && governor_cache.generation == gen &&
+            now - governor_cache.read_ms < GOVERNOR_CACHE_MS) {
+        governor = governor_cache.governor;
+    } else {
+        governor = read_scaling_governor_id();
+        governor_cache.valid = governor != -1;
+        governor_cache.governor = governor;
+        governor_cache.generation = gen;
+        governor_cache.read_ms = now;
+    }
+
+    pthread_mutex_unlock(&governor_cache_mutex);
+
+    return governor;
+}
+
+const struct hint_vector *hint_table_lookup(const hint_table_t table,
+        int type, int governor)
 {
-    static int lock_handle = 0;
+    const struct hint_vector *vector;
 
-    if (duration <= 0 || num_args < 1 || opt_list[0] == 0)
+    if (type < 0 || type >= HINT_TYPE_COUNT ||
+            governor < 0 || governor >= GOVERNOR_COUNT)
+        return NULL;
+
+    vector = &table[type][governor];
+
+    return vector->num_resources > 0 ? vector : NULL;
+}
+
+void perform_hint_vector(int hint_id, const struct hint_vector *vector)
+{
+    /* perf_lock_acq() takes a non-const list but never writes to it. */
+    perform_hint_action(hint_id, (int *)vector->resources,
+            vector->num_resources);
+}
+
+/*
+ * Acquire (state 1) or undo (state 0) the table entry for 'type' under
+ * the current governor. Video hints belong to the media client
+ * 'client_pid' (0 if it didn't say), and are reaped if it dies holding
+ * them. Returns HINT_NONE if the table has no entry.
+ */
+int hint_table_dispatch(const hint_table_t table, int type, int hint_id,
+        int state, int client_pid)
+{
+    const struct hint_vector *vector;
+    int governor = get_scaling_governor_id();
+
+    if (governor == -1) {
+        ALOGE("Can't obtain scaling governor.");
+        return HINT_NONE;
+    }
+
+    vector = hint_table_lookup(table, type, governor);
+    if (!vector)
+        return HINT_NONE;
+
+    if (state == 1 && (type == HINT_TYPE_VIDEO_ENCODE ||
+            type == HINT_TYPE_VIDEO_DECODE))
+        perform_client_hint_action(hint_id, client_pid,
+                (int *)vector->resources, vector->num_resources);
+    else if (state == 1)
+        perform_hint_vector(hint_id, vector);
+    else if (state == 0)
+        undo_hint_action(hint_id);
+    else
+        return HINT_NONE;
+
+    return HINT_HANDLED;
+}
+
+/* Copy out what 'hint_id' holds, for the boost policy's ceilings. */
+int get_active_hint_resources(int hint_id, int resources[], int max)
+{
+    struct hint_data temp_hint_data = {
+        .hint_id = hint_id
+    };
+    struct list_node *found_node;
+    struct hint_data *hint;
+    int i, num = 0;
+
+    pthread_mutex_lock(&qcopt_mutex);
+
+    found_node = find_node(&active_hint_list_head, &temp_hint_data);
+    if (found_node) {
+        hint = found_node->data;
+        for (i = 0; i < hint->num_resources && num < max; i++)
+            resources[num++] = hint->resources[i];
+    }
+
+    pthread_mutex_unlock(&qcopt_mutex);
+
+    return num;
+}
+
+/*
+ * One line per boost taken, read back by tune/powertune. Only with
+ * BOOST_LOG_PROP set when the HAL loads.
+ */
+static void log_boost(const struct boost_request *req)
+{
+    char list[MAX_BOOST_RESOURCES * 8];
+    int i, len = 0;
+
+    if (!__atomic_load_n(&boost_log_enabled, __ATOMIC_RELAXED))
         return;
 
-    if (qcopt_handle) {
+    list[0] = '\0';
+    for (i = 0; i < req->num_resources && len < (int)sizeof(list); i++)
+        len += snprintf(list + len, sizeof(list) - len, "%s0x%x",
+                i ? " " : "", req->resources[i]);
+
+    ALOGD("%s boost: %d ms [%s]",
+            req->type == BOOST_LAUNCH ? "launch" : "interaction",
+            req->duration_ms, list);
+}
+
+/*
+ * Launch and interaction boosts share a perflock, so a launch replaces
+ * a running interaction boost and vice versa. boost-policy.c decides
+ * how long for and with what; the native stages run for that long
+ * whatever happens to the perflock, and without the vendor daemon,
+ * core_ctl stands in for it. The budget is only charged for a boost
+ * that took effect somewhere.
+ */
+static void boost(int type, int duration, int num_args, int opt_list[])
+{
+    struct boost_request req;
+    int lock_handle, applied = 0;
+
+    if (!boost_policy_prepare(type, duration, num_args, opt_list, &req))
+        return;
+
+    /* Native, so they don't have to wait for the vendor library. */
+    if (type == BOOST_LAUNCH) {
+        applied |= pm_qos_vote(PM_QOS_VOTE_LAUNCH, req.duration_ms);
+        applied |= devfreq_boost_vote(DEVFREQ_VOTE_LAUNCH, req.duration_ms);
+        /* Launches also fault in code from storage. */
+        applied |= io_boost_begin(req.duration_ms);
+    } else {
+        applied |= pm_qos_vote(PM_QOS_VOTE_INTERACTION, req.duration_ms);
+        applied |= devfreq_boost_vote(DEVFREQ_VOTE_INTERACTION,
+                req.duration_ms);
+    }
+    applied |= boost_placement_begin(req.duration_ms);
+
+    if (qcopt_ready()) {
+        lock_handle = __atomic_load_n(&boost_lock_handle, __ATOMIC_RELAXED);
+        lock_handle = interaction_with_handle(lock_handle, req.duration_ms,
+                req.num_resources, req.resources);
+        __atomic_store_n(&boost_lock_handle, lock_handle, __ATOMIC_RELAXED);
+        if (lock_handle > 0) {
+            boost_profile_begin(0, req.resources, req.num_resources,
+                    req.duration_ms);
+            applied = 1;
+        }
+    } else if (!perf_lib_available()) {
+        /* Boosts are only useful now; don't queue them behind the loader. */
+        applied |= core_ctl_request(INTERACTION_BOOST_HINT_ID,
+                req.resources, req.num_resources, req.duration_ms);
+    }
+
+    if (!applied)
+        return;
+
+    boost_policy_applied(&req);
+    log_boost(&req);
+    power_state_boost(req.duration_ms);
+}
+
+void interaction(int duration, int num_args, int opt_list[])
+{
+    boost(BOOST_INTERACTION, duration, num_args, opt_list);
+}
+
+void launch_boost(int duration, int num_args, int opt_list[])
+{
+    boost(BOOST_LAUNCH, duration, num_args, opt_list);
+}
+
+/*
+ * Acquire (or update, when lock_handle is non-zero) a perflock owned by
+ * the caller. A duration of 0 holds the lock until release_request().
+ */
+int interaction_with_handle(int lock_handle, int duration, int num_args, int opt_list[])
+{
+    if (duration < 0 || num_args < 1 || opt_list[0] == 0)
+        return 0;
+
+    if (qcopt_ready()) {
         if (perf_lock_acq) {
-            lock_handle = perf_lock_acq(lock_handle, duration, opt_list, num_args);
+            lock_handle = acquire_lock(lock_handle, duration, opt_list, num_args);
             if (lock_handle == -1)
                 ALOGE("Failed to acquire lock.");
         }
     }
+    return lock_handle;
 }
 
-void perform_hint_action(int hint_id, int resource_values[], int num_resources)
+void release_request(int lock_handle)
 {
-    if (qcopt_handle) {
-        if (perf_lock_acq) {
-            /* Acquire an indefinite lock for the requested resources. */
-            int lock_handle = perf_lock_acq(0, 0, resource_values,
-                    num_resources);
+    if (qcopt_ready() && perf_lock_rel)
+        perf_lock_rel(lock_handle);
+}
 
-            if (lock_handle == -1) {
-                ALOGE("Failed to acquire lock.");
-            } else {
-                /* Add this handle to our internal hint-list. */
-                struct hint_data *new_hint =
-                    (struct hint_data *)malloc(sizeof(struct hint_data));
-
-                if (new_hint) {
-                    if (!active_hint_list_head.compare) {
-                        active_hint_list_head.compare =
-                            (int (*)(void *, void *))hint_compare;
-                        active_hint_list_head.dump = (void (*)(void *))hint_dump;
-                    }
-
-                    new_hint->hint_id = hint_id;
-                    new_hint->perflock_handle = lock_handle;
-
-                    if (add_list_node(&active_hint_list_head, new_hint) == NULL) {
-                        free(new_hint);
-                        /* Can't keep track of this lock. Release it. */
-                        if (perf_lock_rel)
-                            perf_lock_rel(lock_handle);
-
-                        ALOGE("Failed to process hint.");
-                    }
-                } else {
-                    /* Can't keep track of this lock. Release it. */
-                    if (perf_lock_rel)
-                        perf_lock_rel(lock_handle);
-
-                    ALOGE("Failed to process hint.");
-                }
+/*
+ * Release the lock behind 'node' and remove it from the hint list.
+ * Returns -1 if the daemon refused the release. Called with
+ * qcopt_mutex held.
+ */
+static int drop_hint_locked(struct list_node *node)
+{
+    struct hint_data *hint = node->data;
+    int ret = 0;
+
+    /* A hint queued while loading holds no lock yet. */
+    if (hint && hint->perflock_handle && perf_lock_rel) {
+        if (perf_lock_rel(hint->perflock_handle) == -1) {
+            ALOGE("Perflock release failed.");
+            ret = -1;
+        }
+    }
+
+    if (hint) {
+        power_state_remove_hint(hint->hint_id);
+        boost_profile_end(hint->hint_id);
+    }
+
+    /* We can free the hint-data for this node. */
+    free_hint_data(hint);
+    remove_list_node(&active_hint_list_head, node);
+
+    return ret;
+}
+
+/*
+ * Arm the reaper for the earliest expiry, or the next check on the
+ * clients. Called with qcopt_mutex held.
+ */
+static void rearm_reaper_locked(void)
+{
+    struct list_node *node;
+    long long next_ms = 0;
+    long long poll_ms = power_timer_now_ms() + HINT_CLIENT_POLL_MS;
+
+    for (node = active_hint_list_head.next; node; node = node->next) {
+        struct hint_data *hint = node->data;
+
+        if (hint && hint->expiry_ms &&
+                (!next_ms || hint->expiry_ms < next_ms))
+            next_ms = hint->expiry_ms;
+        if (hint && hint->owner_pid && (!next_ms || poll_ms < next_ms))
+            next_ms = poll_ms;
+    }
+
+    if (next_ms)
+        power_timer_arm(&reaper_timer, next_ms - power_timer_now_ms());
+    else if (reaper_timer_ready)
+        power_timer_cancel(&reaper_timer);
+}
+
+static void reaper_timer_expired(__attribute__((unused)) void *data)
+{
+    struct hint_reaper_stats *stats;
+    struct list_node *node;
+    long long now = power_timer_now_ms();
+
+    pthread_mutex_lock(&qcopt_mutex);
+
+    node = active_hint_list_head.next;
+    while (node) {
+        struct list_node *next = node->next;
+        struct hint_data *hint = node->data;
+
+        if (hint && hint->expiry_ms && hint->expiry_ms <= now) {
+            ALOGW("Reaping hint 0x%lx: not renewed within %d ms",
+                    hint->hint_id, get_hint_max_lifetime(hint->hint_id));
+        } else if (hint && !hint_owner_alive(hint)) {
+            ALOGW("Reaping hint 0x%lx: client %d is gone", hint->hint_id,
+                    hint->owner_pid);
+        } else {
+            node = next;
+            continue;
+        }
+
+        stats = get_reaper_stats(hint->hint_id);
+        if (stats) {
+            stats->reaped++;
+            publish_reaper_stats(stats);
+        }
+        drop_hint_locked(node);
+        node = next;
+    }
+
+    rearm_reaper_locked();
+    pthread_mutex_unlock(&qcopt_mutex);
+}
+
+/*
+ * Take an indefinite lock on resource_values for 'hint_id', on behalf
+ * of the process 'client_pid' (0 if unknown). Taking the same hint and
+ * vector again is a renewal; a client that dies without undoing its
+ * hint has it reaped.
+ */
+void perform_client_hint_action(int hint_id, int client_pid,
+        int resource_values[], int num_resources)
+{
+    struct hint_data *new_hint;
+    struct list_node *found_node;
+    struct hint_data temp_hint_data = {
+        .hint_id = hint_id
+    };
+    int max_lifetime_ms = get_hint_max_lifetime(hint_id);
+    int lock_handle = 0;
+
+    pthread_mutex_lock(&qcopt_mutex);
+
+    /* No daemon: carry out what can be done natively. */
+    if (qcopt_state == QCOPT_FAILED ||
+            (qcopt_state == QCOPT_READY && !perf_lock_acq)) {
+        core_ctl_request(hint_id, resource_values, num_resources, 0);
+        goto out;
+    }
+
+    if (!reaper_timer_ready) {
+        power_timer_init(&reaper_timer, reaper_timer_expired, NULL);
+        reaper_timer_ready = 1;
+    }
+
+    /*
+     * The same hint again is a renewal: keep the lock and push the
+     * expiry out. A different vector under the same id replaces it.
+     */
+    found_node = find_node(&active_hint_list_head, &temp_hint_data);
+    if (found_node) {
+        struct hint_data *hint = found_node->data;
+
+        if (hint->num_resources == num_resources &&
+                !memcmp(hint->resources, resource_values,
+                    num_resources * sizeof(int))) {
+            struct hint_reaper_stats *stats = get_reaper_stats(hint_id);
+
+            if (max_lifetime_ms) {
+                hint->expiry_ms = power_timer_now_ms() + max_lifetime_ms;
+                power_state_add_hint(hint_id, hint->expiry_ms);
+            }
+            if (client_pid && client_pid != hint->owner_pid)
+                set_hint_owner(hint, client_pid);
+            rearm_reaper_locked();
+            if (stats) {
+                stats->renewals++;
+                publish_reaper_stats(stats);
             }
+            goto out;
         }
+
+        drop_hint_locked(found_node);
     }
+
+    if (qcopt_state == QCOPT_READY) {
+        /* Acquire an indefinite lock for the requested resources. */
+        lock_handle = acquire_lock(0, 0, resource_values, num_resources);
+
+        if (lock_handle == -1) {
+            ALOGE("Failed to acquire lock.");
+            goto out;
+        }
+    }
+
+    /*
+     * Add this handle to our internal hint-list. While the library is
+     * loading the handle stays 0 and the lock is taken on replay.
+     */
+    init_hint_list();
+    new_hint = alloc_hint_data(hint_id, lock_handle, resource_values,
+            num_resources);
+
+    if (!new_hint || add_list_node(&active_hint_list_head, new_hint) == NULL) {
+        free_hint_data(new_hint);
+        /* Can't keep track of this lock. Release it. */
+        if (lock_handle && perf_lock_rel)
+            perf_lock_rel(lock_handle);
+
+        ALOGE("Failed to process hint.");
+        goto out;
+    }
+
+    if (max_lifetime_ms)
+        new_hint->expiry_ms = power_timer_now_ms() + max_lifetime_ms;
+    set_hint_owner(new_hint, client_pid);
+    rearm_reaper_locked();
+
+    power_state_add_hint(hint_id, new_hint->expiry_ms);
+    if (lock_handle)
+        boost_profile_begin(hint_id, resource_values, num_resources, 0);
+
+out:
+    pthread_mutex_unlock(&qcopt_mutex);
+}
+
+/* A lock the HAL itself owns */
+void perform_hint_action(int hint_id, int resource_values[], int num_resources)
+{
+    perform_client_hint_action(hint_id, 0, resource_values, num_resources);
 }
 
 void undo_hint_action(int hint_id)
 {
-    if (qcopt_handle) {
-        if (perf_lock_rel) {
-            /* Get hint-data associated with this hint-id */
-            struct list_node *found_node;
-            struct hint_data temp_hint_data = {
-                .hint_id = hint_id
-            };
-
-            found_node = find_node(&active_hint_list_head,
-                    &temp_hint_data);
-
-            if (found_node) {
-                /* Release this lock. */
-                struct hint_data *found_hint_data =
-                    (struct hint_data *)(found_node->data);
-
-                if (found_hint_data) {
-                    if (perf_lock_rel(found_hint_data->perflock_handle) == -1)
-                        ALOGE("Perflock release failed.");
-                }
-
-                if (found_node->data) {
-                    /* We can free the hint-data for this node. */
-                    free(found_node->data);
-                }
-
-                remove_list_node(&active_hint_list_head, found_node);
-            } else {
-                ALOGE("Invalid hint ID.");
-            }
+    /* Get hint-data associated with this hint-id */
+    struct list_node *found_node;
+    int release_failed = 0;
+    struct hint_data temp_hint_data = {
+        .hint_id = hint_id
+    };
+
+    core_ctl_release(hint_id);
+
+    pthread_mutex_lock(&qcopt_mutex);
+
+    found_node = find_node(&active_hint_list_head,
+            &temp_hint_data);
+
+    if (found_node) {
+        /* Release this lock. */
+        release_failed = drop_hint_locked(found_node) == -1;
+        rearm_reaper_locked();
+    } else if (qcopt_state == QCOPT_READY && perf_lock_rel) {
+        ALOGE("Invalid hint ID.");
+    }
+
+    pthread_mutex_unlock(&qcopt_mutex);
+
+    /* The daemon may have lost every other lock as well. */
+    if (release_failed)
+        perflock_monitor_release_failed();
+}
+
+/*
+ * Take every lock in the hint list again, after the perf daemon lost
+ * them. The old handles are not released: a restarted daemon may have
+ * handed the same numbers out to someone else. Returns the number of
+ * locks re-acquired.
+ */
+int reacquire_hint_locks(void)
+{
+    struct list_node *node;
+    int count = 0;
+
+    pthread_mutex_lock(&qcopt_mutex);
+    if (qcopt_state != QCOPT_READY || !perf_lock_acq)
+        goto out;
+
+    for (node = active_hint_list_head.next; node; node = node->next) {
+        struct hint_data *hint = node->data;
+        int lock_handle;
+
+        if (!hint || !hint->perflock_handle)
+            continue;
+
+        lock_handle = acquire_lock(0, 0, hint->resources, hint->num_resources);
+        if (lock_handle > 0) {
+            hint->perflock_handle = lock_handle;
+            count++;
+        } else {
+            ALOGE("Failed to re-acquire hint 0x%lx.", hint->hint_id);
         }
     }
+
+out:
+    pthread_mutex_unlock(&qcopt_mutex);
+
+    return count;
+}
+
+/*
+ * Take the vendor power profile again after the perf daemon lost it.
+ * A running boost is not: it is short, and the next boost takes a
+ * fresh lock rather than updating a handle the restarted daemon may
+ * have given to someone else. Returns the number of locks re-acquired.
+ */
+int reacquire_boost_locks(void)
+{
+    int count = 0;
+
+    __atomic_store_n(&boost_lock_handle, 0, __ATOMIC_RELAXED);
+
+    pthread_mutex_lock(&qcopt_mutex);
+    if (qcopt_state == QCOPT_READY && perf_lock_use_profile &&
+            profile_handle > 0 && current_profile >= 0) {
+        profile_handle = perf_lock_use_profile(0, current_profile);
+        if (profile_handle > 0) {
+            count++;
+        } else {
+            ALOGE("Failed to re-apply profile %d.", current_profile);
+            profile_handle = 0;
+        }
+    }
+    pthread_mutex_unlock(&qcopt_mutex);
+
+    return count;
 }
 
 /*
@@ -303,17 +1084,27 @@ void undo_hint_action(int hint_id)
  */
 void undo_initial_hint_action()
 {
-    if (qcopt_handle) {
+    pthread_mutex_lock(&qcopt_mutex);
+    if (qcopt_state == QCOPT_LOADING) {
+        pending_initial_release = 1;
+    } else if (qcopt_handle) {
         if (perf_lock_rel) {
             perf_lock_rel(1);
         }
     }
+    pthread_mutex_unlock(&qcopt_mutex);
 }
 
 /* Set a static profile */
 void set_profile(int profile)
 {
-    if (qcopt_handle) {
+    pthread_mutex_lock(&qcopt_mutex);
+    current_profile = profile;
+    if (qcopt_state == QCOPT_LOADING) {
+        /* Only the latest profile matters. */
+        pending_profile = profile;
+        pending_profile_set = 1;
+    } else if (qcopt_handle) {
         if (perf_lock_use_profile) {
             profile_handle = perf_lock_use_profile(profile_handle, profile);
             if (profile_handle == -1)
@@ -322,4 +1113,5 @@ void set_profile(int profile)
                 profile_handle = 0;
         }
     }
+    pthread_mutex_unlock(&qcopt_mutex);
 }
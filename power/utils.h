@@ -29,10 +29,15 @@
 
 #include <cutils/properties.h>
 
+/* Log each boost for tune/powertune; read when the HAL loads. */
+#define BOOST_LOG_PROP      "persist.power.boost_log"
+
 int sysfs_read(char *path, char *s, int num_bytes);
 int sysfs_write(char *path, char *s);
 int get_scaling_governor(char governor[], int size);
 int get_scaling_governor_check_cores(char governor[], int size,int core_num);
+int get_governor_id(const char *governor);
+int get_scaling_governor_id(void);
 
 void vote_ondemand_io_busy_off();
 void unvote_ondemand_io_busy_off();
@@ -40,6 +45,16 @@ void vote_ondemand_sdf_low();
 void unvote_ondemand_sdf_low();
 void perform_hint_action(int hint_id, int resource_values[],
     int num_resources);
+void perform_client_hint_action(int hint_id, int client_pid,
+    int resource_values[], int num_resources);
 void undo_hint_action(int hint_id);
+int reacquire_hint_locks(void);
+int reacquire_boost_locks(void);
+int perf_lib_available(void);
 void undo_initial_hint_action();
 void set_profile(int profile);
+void interaction(int duration, int num_args, int opt_list[]);
+void launch_boost(int duration, int num_args, int opt_list[]);
+int interaction_with_handle(int lock_handle, int duration, int num_args, int opt_list[]);
+void release_request(int lock_handle);
+int get_cpu_freq_opcode(int cpu, int is_max, int freq_khz);
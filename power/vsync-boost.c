@@ -0,0 +1,215 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_NIDEBUG 0
+
+#include <pthread.h>
+#include <string.h>
+
+#define LOG_TAG "QCOM PowerHAL"
+#include <utils/Log.h>
+
+#include "utils.h"
+#include "performance.h"
+#include "power-common.h"
+#include "power-timer.h"
+#include "power-state.h"
+#include "vsync-boost.h"
+
+#define FRAMES_TO_MS(frames) \
+    (((frames) * VSYNC_FRAME_PERIOD_US + 999) / 1000)
+
+static pthread_mutex_t vsync_mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct power_timer release_timer;
+static int release_timer_ready;
+
+static int vsync_active;
+static int lock_handle;
+static long long on_ms;
+static long long off_ms;
+static long long lock_ms;
+static long long lock_expiry_ms;
+/* Moving average of the gap between vsync-off and the next vsync-on. */
+static long long gap_avg_ms;
+
+static struct power_state_vsync stats;
+
+/*
+ * When vsync comes on, cpu0's cluster gets an 800 MHz floor so the
+ * first frames of an animation don't wait for the governor to notice
+ * the load. Shortening the sampling timer instead does nothing for
+ * governors that already run at 20 ms.
+ */
+int __attribute__ ((weak)) get_vsync_boost_resources(int resources[],
+        int max_resources)
+{
+    if (max_resources < 1)
+        return 0;
+
+    resources[0] = 0x208;
+    return 1;
+}
+
+/*
+ * How long to keep the boost after vsync-off. Apps that stop and
+ * restart vsync in quick succession (scrolling flings, blinking
+ * cursors) would otherwise make us acquire and release a perflock on
+ * every toggle, so stretch the hold-off to cover the typical gap.
+ */
+static int hold_off_ms(void)
+{
+    int frames = VSYNC_HOLD_OFF_FRAMES;
+    int hold_ms;
+
+    if (gap_avg_ms > 0 && gap_avg_ms < VSYNC_HOLD_OFF_MAX_MS) {
+        int gap_frames = (gap_avg_ms * 1000 + VSYNC_FRAME_PERIOD_US - 1) /
+                VSYNC_FRAME_PERIOD_US + 1;
+
+        if (gap_frames > frames)
+            frames = gap_frames;
+    }
+
+    hold_ms = FRAMES_TO_MS(frames);
+    if (hold_ms > VSYNC_HOLD_OFF_MAX_MS)
+        hold_ms = VSYNC_HOLD_OFF_MAX_MS;
+
+    return hold_ms;
+}
+
+/* Called with vsync_mutex held. */
+static void release_vsync_lock(long long now)
+{
+    if (lock_handle <= 0)
+        return;
+
+    /* A lock that ran out was already dropped by the perf daemon. */
+    if (now < lock_expiry_ms)
+        release_request(lock_handle);
+    else
+        now = lock_expiry_ms;
+    lock_handle = 0;
+    stats.releases++;
+    stats.boosted_ms += now - lock_ms;
+
+    ALOGV("%s: bursts=%u cold=%u warm=%u boosted=%lldms", __func__,
+            stats.bursts, stats.cold_starts, stats.warm_starts,
+            (long long)stats.boosted_ms);
+}
+
+static void release_timer_expired(__attribute__((unused)) void *data)
+{
+    pthread_mutex_lock(&vsync_mutex);
+    /* Vsync may have come back between expiry and taking the lock. */
+    if (!vsync_active) {
+        release_vsync_lock(power_timer_now_ms());
+        power_state_set_vsync(&stats);
+    }
+    pthread_mutex_unlock(&vsync_mutex);
+}
+
+void vsync_boost_hint(int on)
+{
+    long long now = power_timer_now_ms();
+
+    pthread_mutex_lock(&vsync_mutex);
+
+    if (!release_timer_ready) {
+        power_timer_init(&release_timer, release_timer_expired, NULL);
+        release_timer_ready = 1;
+    }
+
+    on = !!on;
+    if (on == vsync_active)
+        goto out;
+
+    vsync_active = on;
+
+    if (on) {
+        on_ms = now;
+        stats.bursts++;
+
+        if (off_ms) {
+            long long gap = now - off_ms;
+
+            gap_avg_ms = gap_avg_ms ? (3 * gap_avg_ms + gap) / 4 : gap;
+        }
+
+        power_timer_cancel(&release_timer);
+
+        if (lock_handle > 0 && now < lock_expiry_ms) {
+            /* Still inside the hold-off; the boost never went away. */
+            stats.warm_starts++;
+        } else {
+            int resources[VSYNC_MAX_RESOURCES];
+            int num_resources = get_vsync_boost_resources(resources,
+                    VSYNC_MAX_RESOURCES);
+            int duration = FRAMES_TO_MS(VSYNC_BOOST_FRAMES);
+
+            release_vsync_lock(now);
+            stats.cold_starts++;
+            if (num_resources > 0) {
+                int handle = interaction_with_handle(0, duration,
+                        num_resources, resources);
+
+                if (handle > 0) {
+                    lock_handle = handle;
+                    lock_ms = now;
+                    lock_expiry_ms = now + duration;
+                    stats.acquires++;
+                }
+            }
+        }
+    } else {
+        off_ms = now;
+
+        if (lock_handle > 0 &&
+                power_timer_arm(&release_timer, hold_off_ms()) != 0) {
+            /* No timer thread; don't leave the lock behind. */
+            release_vsync_lock(now);
+        }
+    }
+
+    power_state_set_vsync(&stats);
+
+out:
+    pthread_mutex_unlock(&vsync_mutex);
+}
+
+/*
+ * Take the boost again after the perf daemon lost it. Returns 1 if a
+ * lock was re-acquired.
+ */
+int vsync_boost_reacquire(void)
+{
+    int resources[VSYNC_MAX_RESOURCES];
+    int num_resources, handle = 0;
+    long long now = power_timer_now_ms();
+
+    pthread_mutex_lock(&vsync_mutex);
+    if (lock_handle > 0 && now < lock_expiry_ms) {
+        num_resources = get_vsync_boost_resources(resources,
+                VSYNC_MAX_RESOURCES);
+        /* Only what was left of the boost. */
+        if (num_resources > 0)
+            handle = interaction_with_handle(0, lock_expiry_ms - now,
+                    num_resources, resources);
+        /* Without a lock, the release timer has nothing left to do. */
+        lock_handle = handle > 0 ? handle : 0;
+    }
+    pthread_mutex_unlock(&vsync_mutex);
+
+    return handle > 0;
+}
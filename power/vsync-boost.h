@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _QCOM_VSYNC_BOOST_H
+#define _QCOM_VSYNC_BOOST_H
+
+/* Nominal display refresh; all vsync windows are whole frames of this. */
+#define VSYNC_FRAME_PERIOD_US      (16667)
+
+/*
+ * Frames each boost is held for. The HAL only hears vsync on/off, not
+ * every frame, so the boost covers the first frames of a burst while
+ * the governor ramps up and then lets it run on its own.
+ */
+#define VSYNC_BOOST_FRAMES         (6)
+
+/* Frames the boost lingers after vsync-off before it is released. */
+#define VSYNC_HOLD_OFF_FRAMES      (6)
+/* Upper bound on the hold-off, however bursty the cadence looks. */
+#define VSYNC_HOLD_OFF_MAX_MS      (500)
+
+#define VSYNC_MAX_RESOURCES        (8)
+
+void vsync_boost_hint(int on);
+int vsync_boost_reacquire(void);
+
+int get_vsync_boost_resources(int resources[], int max_resources);
+
+#endif
@@ -0,0 +1,12 @@
+LOCAL_PATH := $(call my-dir)
+
+# SoC identity shared by init, the power HAL and cryptfs_hw. soc-ids.h
+# is generated from soc-ids.txt by gen-soc-ids.py.
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := socinfo.c
+LOCAL_CFLAGS := -Wall -Werror
+LOCAL_EXPORT_C_INCLUDE_DIRS := $(LOCAL_PATH)
+LOCAL_MODULE := libqcomsocinfo
+LOCAL_MODULE_TAGS := optional
+include $(BUILD_STATIC_LIBRARY)
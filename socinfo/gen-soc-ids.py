@@ -0,0 +1,80 @@
+#!/usr/bin/env python
+#
+# Copyright (C) 2016 The CyanogenMod Project
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Generate soc-ids.h, the sorted SoC ID table, from soc-ids.txt.
+
+socinfo_family() binary-searches the table, so it must be sorted and
+free of duplicate IDs; both are checked here rather than at runtime.
+
+usage: gen-soc-ids.py [soc-ids.txt [soc-ids.h]]
+"""
+
+import os
+import sys
+
+HEADER = """/*
+ * Generated by gen-soc-ids.py from soc-ids.txt. Do not edit.
+ */
+
+#ifndef _QCOM_SOC_IDS_H
+#define _QCOM_SOC_IDS_H
+
+/* Sorted by id for socinfo_family(). */
+static const struct soc_id_entry soc_ids[] = {
+"""
+
+FOOTER = """};
+
+#endif
+"""
+
+
+def parse(path):
+    entries = {}
+    with open(path) as f:
+        for lineno, line in enumerate(f, 1):
+            line = line.split('#', 1)[0].strip()
+            if not line:
+                continue
+            fields = line.split()
+            if len(fields) != 3:
+                sys.exit('%s:%d: expected "<id> <family> <part>"'
+                         % (path, lineno))
+            soc_id = int(fields[0], 0)
+            if soc_id in entries:
+                sys.exit('%s:%d: duplicate id %d (%s)'
+                         % (path, lineno, soc_id, entries[soc_id][1]))
+            entries[soc_id] = (fields[1], fields[2])
+    return entries
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    src = sys.argv[1] if len(sys.argv) > 1 else os.path.join(here, 'soc-ids.txt')
+    dst = sys.argv[2] if len(sys.argv) > 2 else os.path.join(here, 'soc-ids.h')
+
+    entries = parse(src)
+    with open(dst, 'w') as out:
+        out.write(HEADER)
+        for soc_id in sorted(entries):
+            family, part = entries[soc_id]
+            entry = '{ %3d, SOC_FAMILY_%s },' % (soc_id, family)
+            out.write('    %-34s/* %s */\n' % (entry, part))
+        out.write(FOOTER)
+
+
+if __name__ == '__main__':
+    main()
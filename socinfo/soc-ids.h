@@ -0,0 +1,91 @@
+/*
+ * Generated by gen-soc-ids.py from soc-ids.txt. Do not edit.
+ */
+
+#ifndef _QCOM_SOC_IDS_H
+#define _QCOM_SOC_IDS_H
+
+/* Sorted by id for socinfo_family(). */
+static const struct soc_id_entry soc_ids[] = {
+    {  87, SOC_FAMILY_MSM8960 },      /* MSM8960 */
+    { 109, SOC_FAMILY_APQ8064 },      /* APQ8064 */
+    { 116, SOC_FAMILY_MSM8930 },      /* MSM8930 */
+    { 117, SOC_FAMILY_MSM8930 },      /* MSM8630 */
+    { 118, SOC_FAMILY_MSM8930 },      /* MSM8230 */
+    { 119, SOC_FAMILY_MSM8930 },      /* APQ8030 */
+    { 122, SOC_FAMILY_MSM8960 },      /* MSM8960 */
+    { 123, SOC_FAMILY_MSM8960 },      /* MSM8260A */
+    { 124, SOC_FAMILY_MSM8960 },      /* MSM8060A */
+    { 126, SOC_FAMILY_MSM8974 },      /* MSM8974 */
+    { 130, SOC_FAMILY_APQ8064 },      /* MPQ8064 */
+    { 138, SOC_FAMILY_MSM8960 },      /* MSM8960AB */
+    { 139, SOC_FAMILY_MSM8960 },      /* APQ8060AB */
+    { 140, SOC_FAMILY_MSM8960 },      /* MSM8260AB */
+    { 141, SOC_FAMILY_MSM8960 },      /* MSM8660AB */
+    { 142, SOC_FAMILY_MSM8930 },      /* MSM8930AA */
+    { 143, SOC_FAMILY_MSM8930 },      /* MSM8630AA */
+    { 144, SOC_FAMILY_MSM8930 },      /* MSM8230AA */
+    { 145, SOC_FAMILY_MSM8226 },      /* MSM8626 */
+    { 147, SOC_FAMILY_MSM8610 },      /* MSM8610 */
+    { 153, SOC_FAMILY_APQ8064 },      /* APQ8064AB */
+    { 154, SOC_FAMILY_MSM8930 },      /* MSM8930AB */
+    { 155, SOC_FAMILY_MSM8930 },      /* MSM8630AB */
+    { 156, SOC_FAMILY_MSM8930 },      /* MSM8230AB */
+    { 157, SOC_FAMILY_MSM8930 },      /* APQ8030AB */
+    { 158, SOC_FAMILY_MSM8226 },      /* MSM8226 */
+    { 159, SOC_FAMILY_MSM8226 },      /* MSM8526 */
+    { 160, SOC_FAMILY_MSM8930 },      /* APQ8030AA */
+    { 161, SOC_FAMILY_MSM8610 },      /* MSM8110 */
+    { 162, SOC_FAMILY_MSM8610 },      /* MSM8210 */
+    { 163, SOC_FAMILY_MSM8610 },      /* MSM8810 */
+    { 164, SOC_FAMILY_MSM8610 },      /* MSM8212 */
+    { 165, SOC_FAMILY_MSM8610 },      /* MSM8612 */
+    { 166, SOC_FAMILY_MSM8610 },      /* MSM8112 */
+    { 178, SOC_FAMILY_APQ8084 },      /* APQ8084 */
+    { 184, SOC_FAMILY_MSM8974 },      /* APQ8074 */
+    { 185, SOC_FAMILY_MSM8974 },      /* MSM8274 */
+    { 186, SOC_FAMILY_MSM8974 },      /* MSM8674 */
+    { 194, SOC_FAMILY_MSM8974PRO },   /* MSM8974PRO-AC */
+    { 198, SOC_FAMILY_MSM8226 },      /* MSM8126 */
+    { 199, SOC_FAMILY_MSM8226 },      /* APQ8026 */
+    { 200, SOC_FAMILY_MSM8226 },      /* MSM8926 */
+    { 205, SOC_FAMILY_MSM8226 },      /* MSM8326 */
+    { 206, SOC_FAMILY_MSM8916 },      /* MSM8916 */
+    { 207, SOC_FAMILY_MSM8994 },      /* MSM8994 */
+    { 208, SOC_FAMILY_MSM8974PRO },   /* APQ8074PRO-AA */
+    { 209, SOC_FAMILY_MSM8974PRO },   /* APQ8074PRO-AB */
+    { 210, SOC_FAMILY_MSM8974PRO },   /* APQ8074PRO-AC */
+    { 211, SOC_FAMILY_MSM8974PRO },   /* MSM8274PRO-AA */
+    { 212, SOC_FAMILY_MSM8974PRO },   /* MSM8274PRO-AB */
+    { 213, SOC_FAMILY_MSM8974PRO },   /* MSM8274PRO-AC */
+    { 214, SOC_FAMILY_MSM8974PRO },   /* MSM8674PRO-AA */
+    { 215, SOC_FAMILY_MSM8974PRO },   /* MSM8674PRO-AB */
+    { 216, SOC_FAMILY_MSM8974PRO },   /* MSM8674PRO-AC */
+    { 217, SOC_FAMILY_MSM8974PRO },   /* MSM8974PRO-AA */
+    { 218, SOC_FAMILY_MSM8974PRO },   /* MSM8974PRO-AB */
+    { 219, SOC_FAMILY_MSM8226 },      /* APQ8028 */
+    { 220, SOC_FAMILY_MSM8226 },      /* MSM8128 */
+    { 221, SOC_FAMILY_MSM8226 },      /* MSM8228 */
+    { 222, SOC_FAMILY_MSM8226 },      /* MSM8528 */
+    { 223, SOC_FAMILY_MSM8226 },      /* MSM8628 */
+    { 224, SOC_FAMILY_MSM8226 },      /* MSM8928 */
+    { 239, SOC_FAMILY_MSM8939 },      /* MSM8939 */
+    { 241, SOC_FAMILY_MSM8939 },      /* APQ8039 */
+    { 245, SOC_FAMILY_MSM8909 },      /* MSM8909 */
+    { 247, SOC_FAMILY_MSM8916 },      /* APQ8016 */
+    { 248, SOC_FAMILY_MSM8916 },      /* MSM8216 */
+    { 249, SOC_FAMILY_MSM8916 },      /* MSM8116 */
+    { 250, SOC_FAMILY_MSM8916 },      /* MSM8616 */
+    { 251, SOC_FAMILY_MSM8992 },      /* MSM8992 */
+    { 252, SOC_FAMILY_MSM8992 },      /* APQ8092 */
+    { 253, SOC_FAMILY_MSM8994 },      /* APQ8094 */
+    { 258, SOC_FAMILY_MSM8909 },      /* MSM8209 */
+    { 259, SOC_FAMILY_MSM8909 },      /* MSM8208 */
+    { 260, SOC_FAMILY_MSM8909 },      /* MDMFERRUM */
+    { 263, SOC_FAMILY_MSM8939 },      /* MSM8239 */
+    { 264, SOC_FAMILY_MSM8952 },      /* MSM8952 */
+    { 265, SOC_FAMILY_MSM8909 },      /* APQ8009 */
+    { 289, SOC_FAMILY_MSM8952 },      /* APQ8052 */
+};
+
+#endif
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * SoC identity, read once per process.
+ *
+ * init reads soc_id, platform_version and hw_platform from sysfs and
+ * publishes them as properties; everything started after it reads the
+ * properties instead. The SoC family comes from the generated soc_ids
+ * table, so every component classifies a chip the same way.
+ */
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/system_properties.h>
+
+#include "socinfo.h"
+#include "soc-ids.h"
+
+#define SOC_ID_PATH1            "/sys/devices/soc0/soc_id"
+#define SOC_ID_PATH2            "/sys/devices/system/soc/soc0/id"
+#define SOC_VER_PATH1           "/sys/devices/soc0/platform_version"
+#define SOC_VER_PATH2           "/sys/devices/system/soc/soc0/platform_version"
+#define HW_PLATFORM_PATH1       "/sys/devices/soc0/hw_platform"
+#define HW_PLATFORM_PATH2       "/sys/devices/system/soc/soc0/hw_platform"
+
+#define BUF_SIZE                (64)
+
+static const char *family_names[SOC_FAMILY_COUNT] = {
+    [SOC_FAMILY_UNKNOWN] = "unknown",
+    [SOC_FAMILY_MSM8960] = "msm8960",
+    [SOC_FAMILY_APQ8064] = "apq8064",
+    [SOC_FAMILY_MSM8930] = "msm8930",
+    [SOC_FAMILY_MSM8974] = "msm8974",
+    [SOC_FAMILY_MSM8974PRO] = "msm8974pro",
+    [SOC_FAMILY_APQ8084] = "apq8084",
+    [SOC_FAMILY_MSM8226] = "msm8226",
+    [SOC_FAMILY_MSM8610] = "msm8610",
+    [SOC_FAMILY_MSM8916] = "msm8916",
+    [SOC_FAMILY_MSM8939] = "msm8939",
+    [SOC_FAMILY_MSM8909] = "msm8909",
+    [SOC_FAMILY_MSM8952] = "msm8952",
+    [SOC_FAMILY_MSM8992] = "msm8992",
+    [SOC_FAMILY_MSM8994] = "msm8994",
+};
+
+static pthread_once_t socinfo_once = PTHREAD_ONCE_INIT;
+static struct socinfo info;
+
+/* Read the first path that exists, then the second. */
+static int read_node(const char *path1, const char *path2, char *buf, int size)
+{
+    const char *paths[] = { path1, path2 };
+    int i, fd, len;
+
+    for (i = 0; i < 2; i++) {
+        fd = open(paths[i], O_RDONLY);
+        if (fd < 0)
+            continue;
+
+        len = read(fd, buf, size - 1);
+        close(fd);
+        if (len <= 0)
+            return -1;
+
+        buf[len] = '\0';
+        return 0;
+    }
+
+    return -1;
+}
+
+static int read_properties(void)
+{
+    char value[PROP_VALUE_MAX];
+
+    if (__system_property_get(SOCINFO_PROP_ID, value) <= 0)
+        return -1;
+    info.soc_id = strtoul(value, NULL, 0);
+
+    if (__system_property_get(SOCINFO_PROP_VERSION, value) > 0)
+        info.platform_version = strtoul(value, NULL, 0);
+
+    if (__system_property_get(SOCINFO_PROP_HW_PLATFORM, value) > 0)
+        sscanf(value, "%63s", info.hw_platform);
+
+    return 0;
+}
+
+static void read_sysfs(void)
+{
+    char buf[BUF_SIZE];
+
+    if (read_node(SOC_ID_PATH1, SOC_ID_PATH2, buf, sizeof(buf)) == 0)
+        info.soc_id = strtoul(buf, NULL, 0);
+
+    if (read_node(SOC_VER_PATH1, SOC_VER_PATH2, buf, sizeof(buf)) == 0)
+        info.platform_version = strtoul(buf, NULL, 0);
+
+    if (read_node(HW_PLATFORM_PATH1, HW_PLATFORM_PATH2, buf, sizeof(buf)) == 0)
+        sscanf(buf, "%63s", info.hw_platform);
+}
+
+static void socinfo_init(void)
+{
+    if (read_properties())
+        read_sysfs();
+
+    info.family = socinfo_family(info.soc_id);
+}
+
+/* Never NULL; soc_id is 0 if the SoC could not be identified. */
+const struct socinfo *socinfo_get(void)
+{
+    pthread_once(&socinfo_once, socinfo_init);
+
+    return &info;
+}
+
+int socinfo_family(unsigned long soc_id)
+{
+    int lo = 0, hi = sizeof(soc_ids) / sizeof(soc_ids[0]) - 1, mid;
+
+    while (lo <= hi) {
+        mid = lo + (hi - lo) / 2;
+        if (soc_ids[mid].soc_id == soc_id)
+            return soc_ids[mid].family;
+        if (soc_ids[mid].soc_id < soc_id)
+            lo = mid + 1;
+        else
+            hi = mid - 1;
+    }
+
+    return SOC_FAMILY_UNKNOWN;
+}
+
+const char *socinfo_family_name(int family)
+{
+    if (family < 0 || family >= SOC_FAMILY_COUNT)
+        family = SOC_FAMILY_UNKNOWN;
+
+    return family_names[family];
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _QCOM_SOCINFO_H
+#define _QCOM_SOCINFO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Published by init once it has read the values from sysfs. */
+#define SOCINFO_PROP_ID             "ro.qcom.soc_id"
+#define SOCINFO_PROP_VERSION        "ro.qcom.soc_version"
+#define SOCINFO_PROP_HW_PLATFORM    "ro.qcom.hw_platform"
+#define SOCINFO_PROP_FAMILY         "ro.qcom.soc_family"
+
+#define SOCINFO_HW_PLATFORM_MAX     (64)
+
+enum soc_family {
+    SOC_FAMILY_UNKNOWN = 0,
+    SOC_FAMILY_MSM8960,
+    SOC_FAMILY_APQ8064,
+    SOC_FAMILY_MSM8930,
+    SOC_FAMILY_MSM8974,
+    SOC_FAMILY_MSM8974PRO,
+    SOC_FAMILY_APQ8084,
+    SOC_FAMILY_MSM8226,
+    SOC_FAMILY_MSM8610,
+    SOC_FAMILY_MSM8916,
+    SOC_FAMILY_MSM8939,
+    SOC_FAMILY_MSM8909,
+    SOC_FAMILY_MSM8952,
+    SOC_FAMILY_MSM8992,
+    SOC_FAMILY_MSM8994,
+    SOC_FAMILY_COUNT
+};
+
+struct socinfo {
+    /* 0 if the SoC could not be identified */
+    unsigned long soc_id;
+    unsigned long platform_version;
+    /* First word of hw_platform, e.g. "MTP" or "Liquid" */
+    char hw_platform[SOCINFO_HW_PLATFORM_MAX];
+    int family;
+};
+
+struct soc_id_entry {
+    unsigned short soc_id;
+    unsigned short family;
+};
+
+const struct socinfo *socinfo_get(void);
+int socinfo_family(unsigned long soc_id);
+const char *socinfo_family_name(int family);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif